@@ -1,7 +1,24 @@
 #version 400
-uniform vec3 EyePos;
-uniform vec3 LightPos;
-uniform vec3 LightColor;
+// Varianten: SPECULAR 0 spart das Glanzlicht (wird von TerrainShader gesetzt)
+#ifndef SPECULAR
+#define SPECULAR 1
+#endif
+layout(std140) uniform FrameBlock
+{
+    mat4 ViewMat;
+    mat4 ProjMat;
+    mat4 ViewProjMat;
+    vec4 EyePos;
+    vec4 LightPos;
+    vec4 LightColor;
+    vec4 Viewport;
+};
+
+layout(std140) uniform ObjectBlock
+{
+    mat4 ModelMat;
+};
+
 uniform vec3 DiffuseColor;
 uniform vec3 SpecularColor;
 uniform vec3 AmbientColor;
@@ -10,9 +27,28 @@ uniform float SpecularExp;
 uniform sampler2D MixTex; // for exercise 3
 uniform sampler2D DetailTex[2]; // for exercise 3
 uniform vec3 Scaling;
+uniform sampler2D NormalTex; // aus den Höhen generiert (Terrain::generateNormalMap)
+uniform int UseNormalMap;
+
+// virtuelle Textur (VirtualTexture): Atlas + Page-Table ersetzen die Detail-Texturen
+uniform int UseVirtualTex;
+uniform sampler2D VTAtlas;
+uniform sampler2D VTPageTable;
+uniform vec3 VTParams;      // Tiles pro Achse (Level 0), groesstes Level, Tilegroesse
+uniform vec3 VTAtlasParams; // Seiten pro Achse, Seitengroesse, Rand (Texel)
 
 uniform int k;
 
+// Sonnenschatten (ShadowMaps), Aufbau wie UB_SHADOW_BLOCK_GLSL
+layout(std140) uniform ShadowBlock
+{
+    mat4 ShadowMat[4];
+    vec4 CascadeSplits;
+    vec4 CascadeTexel;
+    vec4 ShadowParams; // Kaskaden (0 = keine Schatten), Tiefen-Bias, Normal-Offset in Texeln
+};
+uniform sampler2DArrayShadow ShadowMap;
+
 in vec3 Position;
 in vec3 Normal;
 in vec2 Texcoord;
@@ -23,27 +59,65 @@ float sat( in float a)
     return clamp(a, 0.0, 1.0);
 }
 
+vec4 sampleVirtual(vec2 uv)
+{
+    uv = clamp(uv, vec2(0.0), vec2(0.99999));
+    vec2 texel = uv * VTParams.x * VTParams.z;
+    vec2 dx    = dFdx(texel);
+    vec2 dy    = dFdy(texel);
+    float lod  = clamp(floor(0.5*log2(max(max(dot(dx,dx), dot(dy,dy)), 1e-8))), 0.0, VTParams.y);
+
+    // Eintrag: Atlas-Seite (x,y) und Level der tatsaechlich geladenen Seite (Fallback auf Vorfahren)
+    vec4 e       = floor(textureLod(VTPageTable, uv, lod) * 255.0 + 0.5);
+    vec2 inPage  = fract(uv * (VTParams.x / exp2(e.b)));
+    float pageSz = VTAtlasParams.y;
+    vec2 puv     = (e.rg * pageSz + VTAtlasParams.z + inPage * VTParams.z) / (VTAtlasParams.x * pageSz);
+    return textureLod(VTAtlas, puv, 0.0);
+}
+
+// shadowFactor(P, N): SHADOW_LOOKUP_GLSL aus ShadowMaps.h, fuegt TerrainShader als Makro ein
+SHADOW_LOOKUP
+
 
 void main()
 {
     vec3 N      = normalize(Normal);
-    vec3 L      = normalize(LightPos); // light is treated as directional source
-    vec3 D      = EyePos-Position;
+    if(UseNormalMap != 0)
+    {
+        // Texelzentren treffen die Gridpunkte (Texcoord 0..1 = erster..letzter Gridpunkt)
+        vec2 ts  = vec2(textureSize(NormalTex, 0));
+        vec2 nuv = (Texcoord*(ts-1.0)+0.5)/ts;
+        vec3 n   = texture(NormalTex, nuv).xyz*2.0-1.0;
+        N = normalize((ModelMat * vec4(n/Scaling,0)).xyz);
+    }
+    vec3 L      = normalize(LightPos.xyz); // light is treated as directional source
+    float Shadow = shadowFactor(Position, N);
+    
+    vec3 DiffuseComponent = LightColor.rgb * DiffuseColor * sat(dot(N,L)) * Shadow;
+#if SPECULAR
+    vec3 D      = EyePos.xyz-Position;
     float Dist  = length(D);
     vec3 E      = D/Dist;
     vec3 R      = reflect(-L,N);
-    
-    vec3 DiffuseComponent = LightColor * DiffuseColor * sat(dot(N,L));
-    vec3 SpecularComponent = LightColor * SpecularColor * pow( sat(dot(R,E)), SpecularExp);
+    vec3 SpecularComponent = LightColor.rgb * SpecularColor * pow( sat(dot(R,E)), SpecularExp) * Shadow;
+#else
+    vec3 SpecularComponent = vec3(0.0);
+#endif
     
     // Exercise 3
     // TODO: Add texture blending code here..
 
-    vec4 mixTexColor = texture(MixTex, Texcoord);
-    vec4 grassTexColor = texture(DetailTex[0], Texcoord*k);
-    vec4 rockTextColor = texture(DetailTex[1], Texcoord*k);
-
-    vec4 interpolation = mix(grassTexColor, rockTextColor, mixTexColor);
+    // mit virtueller Textur ist die Mischung vorgebacken, Mix- und Detailtexturen werden nicht gelesen
+    vec4 interpolation;
+    if(UseVirtualTex != 0)
+        interpolation = sampleVirtual(Texcoord);
+    else
+    {
+        vec4 mixTexColor = texture(MixTex, Texcoord);
+        vec4 grassTexColor = texture(DetailTex[0], Texcoord*k);
+        vec4 rockTextColor = texture(DetailTex[1], Texcoord*k);
+        interpolation = mix(grassTexColor, rockTextColor, mixTexColor);
+    }
 
  
     
@@ -0,0 +1,22 @@
+#version 400
+// Feedback-Pass der virtuellen Textur: pro Fragment benoetigtes Tile und Mip-Level
+uniform vec3 VTParams;      // Tiles pro Achse (Level 0), groesstes Level, Tilegroesse in Texeln
+uniform float FeedbackBias; // log2 der Verkleinerung des Feedback-Framebuffers
+
+in vec3 Position;
+in vec3 Normal;
+in vec2 Texcoord;
+out vec4 FragColor;
+
+void main()
+{
+    vec2 uv    = clamp(Texcoord, vec2(0.0), vec2(0.99999));
+    vec2 texel = uv * VTParams.x * VTParams.z;
+    vec2 dx    = dFdx(texel);
+    vec2 dy    = dFdy(texel);
+    float lod  = 0.5*log2(max(max(dot(dx,dx), dot(dy,dy)), 1e-8)) - FeedbackBias;
+    lod        = clamp(floor(lod), 0.0, VTParams.y);
+
+    vec2 tile  = floor(uv * (VTParams.x / exp2(lod)));
+    FragColor  = vec4(tile, lod, 255.0) / 255.0;
+}
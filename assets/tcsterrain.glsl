@@ -0,0 +1,69 @@
+#version 400
+// Tessellation Control: Stufen pro Kante aus der Bildschirmlaenge der Kante und der
+// Hoehenvarianz der angrenzenden Patches. Beide Groessen haengen nur von der Kante ab,
+// benachbarte Patches erhalten dieselbe Stufe -> keine Risse.
+layout(vertices = 4) out;
+
+in vec3 CtrlPosition[];
+in vec2 CtrlTexcoord[];
+out vec3 EvalPosition[];
+out vec2 EvalTexcoord[];
+
+layout(std140) uniform FrameBlock
+{
+    mat4 ViewMat;
+    mat4 ProjMat;
+    mat4 ViewProjMat;
+    vec4 EyePos;
+    vec4 LightPos;
+    vec4 LightColor;
+    vec4 Viewport;
+};
+
+layout(std140) uniform ObjectBlock
+{
+    mat4 ModelMat;
+};
+
+uniform vec3 Scaling;
+uniform sampler2D VarianceTex; // Hoehenvarianz pro Patch (R32F, nearest)
+uniform vec3 TessParams;       // Ziel-Kantenlaenge (Pixel), Referenz-Standardabweichung, max. Stufe
+
+float edgeLevel(int a, int b)
+{
+    // Kante als Kugel um ihren Mittelpunkt: Durchmesser in Pixeln, unabhaengig von der Blickrichtung
+    vec3 wa = (ModelMat * vec4(CtrlPosition[a] * Scaling, 1)).xyz;
+    vec3 wb = (ModelMat * vec4(CtrlPosition[b] * Scaling, 1)).xyz;
+    float dist = max(-(ViewMat * vec4(0.5 * (wa + wb), 1)).z, 0.001);
+    float pixels = length(wa - wb) * ProjMat[1][1] * 0.5 * Viewport.w / dist;
+
+    // beide Patches links/rechts der Kante, der unruhigere bestimmt
+    vec2 mid = 0.5 * (CtrlTexcoord[a] + CtrlTexcoord[b]);
+    vec2 e = CtrlTexcoord[b] - CtrlTexcoord[a];
+    vec2 n = 0.5 * vec2(-e.y, e.x);
+    float variance = max(textureLod(VarianceTex, mid + n, 0.0).r, textureLod(VarianceTex, mid - n, 0.0).r);
+    float weight = clamp(sqrt(variance) / TessParams.y, 0.1, 1.0);
+
+    return clamp(pixels / TessParams.x * weight, 1.0, TessParams.z);
+}
+
+void main()
+{
+    EvalPosition[gl_InvocationID] = CtrlPosition[gl_InvocationID];
+    EvalTexcoord[gl_InvocationID] = CtrlTexcoord[gl_InvocationID];
+
+    if (gl_InvocationID == 0)
+    {
+        // Ecken: 0 = (x,z), 1 = (x+1,z), 2 = (x+1,z+1), 3 = (x,z+1)
+        float e0 = edgeLevel(0, 3); // u = 0
+        float e1 = edgeLevel(0, 1); // v = 0
+        float e2 = edgeLevel(1, 2); // u = 1
+        float e3 = edgeLevel(3, 2); // v = 1
+        gl_TessLevelOuter[0] = e0;
+        gl_TessLevelOuter[1] = e1;
+        gl_TessLevelOuter[2] = e2;
+        gl_TessLevelOuter[3] = e3;
+        gl_TessLevelInner[0] = max(e1, e3);
+        gl_TessLevelInner[1] = max(e0, e2);
+    }
+}
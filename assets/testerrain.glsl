@@ -0,0 +1,62 @@
+#version 400
+// Tessellation Evaluation: Punkt im Patch interpolieren, Hoehe aus HeightTex verschieben.
+// Ausgaben wie vsterrain.glsl, fsterrain.glsl bleibt unveraendert.
+layout(quads, fractional_even_spacing, cw) in;
+
+invariant gl_Position;
+
+in vec3 EvalPosition[];
+in vec2 EvalTexcoord[];
+
+out vec3 Position;
+out vec3 Normal;
+out vec2 Texcoord;
+
+layout(std140) uniform FrameBlock
+{
+    mat4 ViewMat;
+    mat4 ProjMat;
+    mat4 ViewProjMat;
+    vec4 EyePos;
+    vec4 LightPos;
+    vec4 LightColor;
+    vec4 Viewport;
+};
+
+layout(std140) uniform ObjectBlock
+{
+    mat4 ModelMat;
+};
+
+uniform vec3 Scaling;
+uniform sampler2D HeightTex; // normalisierte Hoehen (R32F), ein Texel pro Gridpunkt
+uniform vec3 HeightParams;   // Hoehenskalierung, Gridabstand
+
+float height(vec2 uv)
+{
+    return textureLod(HeightTex, uv, 0.0).r * HeightParams.x;
+}
+
+void main()
+{
+    float u = gl_TessCoord.x;
+    float v = gl_TessCoord.y;
+    vec3 p  = mix(mix(EvalPosition[0], EvalPosition[1], u), mix(EvalPosition[3], EvalPosition[2], u), v);
+    vec2 uv = mix(mix(EvalTexcoord[0], EvalTexcoord[1], u), mix(EvalTexcoord[3], EvalTexcoord[2], u), v);
+
+    // Texelzentren treffen die Gridpunkte (bilinear wie Terrain::heightAtWorld)
+    vec2 ts  = vec2(textureSize(HeightTex, 0));
+    vec2 huv = (uv * (ts - 1.0) + 0.5) / ts;
+    p.y = height(huv);
+
+    // Normale per zentraler Differenz ueber einen Gridabstand
+    vec2 dx = vec2(1.0 / ts.x, 0.0);
+    vec2 dz = vec2(0.0, 1.0 / ts.y);
+    vec3 n  = vec3(height(huv - dx) - height(huv + dx), 2.0 * HeightParams.y, height(huv - dz) - height(huv + dz));
+
+    vec4 WorldPos = ModelMat * vec4(p * Scaling, 1);
+    Position = WorldPos.xyz;
+    Normal   = (ModelMat * vec4(normalize(n / Scaling), 0)).xyz;
+    Texcoord = uv;
+    gl_Position = ViewProjMat * WorldPos;
+}
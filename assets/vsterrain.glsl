@@ -1,26 +1,55 @@
 #version 400
 
+// gleiche Tiefe wie der Pre-Pass (DepthShader), Voraussetzung fuer GL_EQUAL
+invariant gl_Position;
+
 layout(location=0) in vec4 VertexPos;
 layout(location=1) in vec4 VertexNormal;
 layout(location=2) in vec2 VertexTexcoord;
 
+#ifdef TESSELLATION
+// Tessellation (tcsterrain/testerrain): nur die Patch-Ecken im Objektraum weiterreichen
+out vec3 CtrlPosition;
+out vec2 CtrlTexcoord;
+#else
 out vec3 Position;
 out vec3 Normal;
 out vec2 Texcoord;
+#endif
+
+layout(std140) uniform FrameBlock
+{
+    mat4 ViewMat;
+    mat4 ProjMat;
+    mat4 ViewProjMat;
+    vec4 EyePos;
+    vec4 LightPos;
+    vec4 LightColor;
+    vec4 Viewport;
+};
+
+layout(std140) uniform ObjectBlock
+{
+    mat4 ModelMat;
+};
 
-uniform mat4 ModelMat;
-uniform mat4 ModelViewProjMat;
 uniform vec3 Scaling;
 
 void main()
 {
+#ifdef TESSELLATION
+    CtrlPosition = VertexPos.xyz;
+    CtrlTexcoord = VertexTexcoord;
+#else
 
     vec4 scaledVertexPos = vec4(VertexPos.xyz * Scaling.xyz,1);
     vec4 scaledNormal = normalize(vec4(VertexNormal.xyz/Scaling.xyz,1));
 
 
-    Position = (ModelMat * scaledVertexPos).xyz;
+    vec4 WorldPos = ModelMat * scaledVertexPos;
+    Position = WorldPos.xyz;
     Normal = (ModelMat * vec4(scaledNormal.xyz,0)).xyz;
     Texcoord = VertexTexcoord;
-    gl_Position = ModelViewProjMat * scaledVertexPos;
+    gl_Position = ViewProjMat * WorldPos;
+#endif
 }
@@ -1,5 +1,10 @@
 #include "Aabb.h"
+#include "MatrixSIMD.h"
 #include <cmath>
+#ifdef MATRIX_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
 
 AABB::AABB() : Min(0,0,0), Max(0,0,0) {}
 AABB::AABB(const Vector& min, const Vector& max) : Min(min), Max(max) {}
@@ -18,36 +23,42 @@ Vector AABB::size() const {
     return Max - Min;
 }
 
-// robuste, mutierende Transform: 8 Ecken -> neue Min/Max
+// Arvo: Zentrum normal transformieren, halbe Ausdehnung mit dem Betrag der 3x3.
+// Jede Achse der neuen Box ist die Summe der Beitraege aller alten Achsen; das
+// liefert genau die Min/Max der 8 transformierten Ecken.
 void AABB::transform(const Matrix& M)
 {
-    Vector corners[8] = {
-        Vector(Min.X, Min.Y, Min.Z),
-        Vector(Max.X, Min.Y, Min.Z),
-        Vector(Min.X, Max.Y, Min.Z),
-        Vector(Max.X, Max.Y, Min.Z),
-        Vector(Min.X, Min.Y, Max.Z),
-        Vector(Max.X, Min.Y, Max.Z),
-        Vector(Min.X, Max.Y, Max.Z),
-        Vector(Max.X, Max.Y, Max.Z)
-    };
-
-    Vector p0 = M * corners[0];
-    Vector newMin = p0;
-    Vector newMax = p0;
-
-    for(int i=1;i<8;++i){
-        Vector p = M * corners[i];
-        if(p.X < newMin.X) newMin.X = p.X;
-        if(p.Y < newMin.Y) newMin.Y = p.Y;
-        if(p.Z < newMin.Z) newMin.Z = p.Z;
-        if(p.X > newMax.X) newMax.X = p.X;
-        if(p.Y > newMax.Y) newMax.Y = p.Y;
-        if(p.Z > newMax.Z) newMax.Z = p.Z;
-    }
+    const float cx = (Min.X + Max.X) * 0.5f, cy = (Min.Y + Max.Y) * 0.5f, cz = (Min.Z + Max.Z) * 0.5f;
+    // fabs: vertauschte Min/Max ergeben wie bisher eine gueltige Box
+    const float ex = std::fabs(Max.X - Min.X) * 0.5f;
+    const float ey = std::fabs(Max.Y - Min.Y) * 0.5f;
+    const float ez = std::fabs(Max.Z - Min.Z) * 0.5f;
+
+    const float nx = M.m00 * cx + M.m01 * cy + M.m02 * cz + M.m03;
+    const float ny = M.m10 * cx + M.m11 * cy + M.m12 * cz + M.m13;
+    const float nz = M.m20 * cx + M.m21 * cy + M.m22 * cz + M.m23;
+    const float rx = std::fabs(M.m00) * ex + std::fabs(M.m01) * ey + std::fabs(M.m02) * ez;
+    const float ry = std::fabs(M.m10) * ex + std::fabs(M.m11) * ey + std::fabs(M.m12) * ez;
+    const float rz = std::fabs(M.m20) * ex + std::fabs(M.m21) * ey + std::fabs(M.m22) * ez;
+
+    Min.X = nx - rx; Min.Y = ny - ry; Min.Z = nz - rz;
+    Max.X = nx + rx; Max.Y = ny + ry; Max.Z = nz + rz;
+}
+
+void AABB::translate(const Vector& d)
+{
+    Min.X += d.X; Min.Y += d.Y; Min.Z += d.Z;
+    Max.X += d.X; Max.Y += d.Y; Max.Z += d.Z;
+}
 
-    Min = newMin;
-    Max = newMax;
+void AABB::merge(const AABB& o)
+{
+    if (o.Min.X < Min.X) Min.X = o.Min.X;
+    if (o.Min.Y < Min.Y) Min.Y = o.Min.Y;
+    if (o.Min.Z < Min.Z) Min.Z = o.Min.Z;
+    if (o.Max.X > Max.X) Max.X = o.Max.X;
+    if (o.Max.Y > Max.Y) Max.Y = o.Max.Y;
+    if (o.Max.Z > Max.Z) Max.Z = o.Max.Z;
 }
 
 void AABB::verifyIntegrity()
@@ -82,3 +93,172 @@ void AABB::moveTo(const Vector& newCenter)
     Max = newCenter + half;
     verifyIntegrity();
 }
+
+// ------------------------------------------------------------------------------
+// AABB8
+
+AABB8::AABB8()
+{
+    clear();
+}
+
+void AABB8::clear()
+{
+    for(unsigned int i=0; i<SIZE; ++i)
+        CX[i] = CY[i] = CZ[i] = EX[i] = EY[i] = EZ[i] = 0.0f;
+    Count = 0;
+}
+
+void AABB8::set(unsigned int i, const AABB& Box)
+{
+    if(i >= SIZE)
+        return;
+    CX[i] = (Box.Min.X + Box.Max.X) * 0.5f;
+    CY[i] = (Box.Min.Y + Box.Max.Y) * 0.5f;
+    CZ[i] = (Box.Min.Z + Box.Max.Z) * 0.5f;
+    EX[i] = std::fabs(Box.Max.X - Box.Min.X) * 0.5f;
+    EY[i] = std::fabs(Box.Max.Y - Box.Min.Y) * 0.5f;
+    EZ[i] = std::fabs(Box.Max.Z - Box.Min.Z) * 0.5f;
+    if(i >= Count)
+        Count = i + 1;
+}
+
+AABB AABB8::get(unsigned int i) const
+{
+    return AABB(CX[i] - EX[i], CY[i] - EY[i], CZ[i] - EZ[i],
+                CX[i] + EX[i], CY[i] + EY[i], CZ[i] + EZ[i]);
+}
+
+void AABB8::classifyScalar(const float* P, unsigned int& Outside, unsigned int& Inside) const
+{
+    const float ax = std::fabs(P[0]), ay = std::fabs(P[1]), az = std::fabs(P[2]);
+    Outside = Inside = 0;
+    for(unsigned int i=0; i<SIZE; ++i)
+    {
+        const float d = P[0] * CX[i] + P[1] * CY[i] + P[2] * CZ[i] + P[3];
+        const float r = ax * EX[i] + ay * EY[i] + az * EZ[i];
+        if(d < -r) Outside |= 1u << i;
+        if(d >= r) Inside |= 1u << i;
+    }
+    Outside &= validMask();
+    Inside &= validMask();
+}
+
+unsigned int AABB8::overlapsScalar(const AABB& Box) const
+{
+    const float cx = (Box.Min.X + Box.Max.X) * 0.5f, ex = std::fabs(Box.Max.X - Box.Min.X) * 0.5f;
+    const float cy = (Box.Min.Y + Box.Max.Y) * 0.5f, ey = std::fabs(Box.Max.Y - Box.Min.Y) * 0.5f;
+    const float cz = (Box.Min.Z + Box.Max.Z) * 0.5f, ez = std::fabs(Box.Max.Z - Box.Min.Z) * 0.5f;
+    unsigned int Mask = 0;
+    for(unsigned int i=0; i<SIZE; ++i)
+    {
+        if(std::fabs(CX[i] - cx) <= EX[i] + ex &&
+           std::fabs(CY[i] - cy) <= EY[i] + ey &&
+           std::fabs(CZ[i] - cz) <= EZ[i] + ez)
+            Mask |= 1u << i;
+    }
+    return Mask & validMask();
+}
+
+#ifdef MATRIX_SIMD_X86
+
+// je 4 Boxen ab Offset o; liefert 4-Bit-Masken
+static inline void classifySSE(const AABB8& B, unsigned int o, const float* P,
+                               unsigned int& Outside, unsigned int& Inside)
+{
+    const __m128 Abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 px = _mm_set1_ps(P[0]), py = _mm_set1_ps(P[1]), pz = _mm_set1_ps(P[2]);
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_loadu_ps(B.CX + o)),
+                                     _mm_mul_ps(py, _mm_loadu_ps(B.CY + o))),
+                          _mm_add_ps(_mm_mul_ps(pz, _mm_loadu_ps(B.CZ + o)), _mm_set1_ps(P[3])));
+    __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(px, Abs), _mm_loadu_ps(B.EX + o)),
+                                     _mm_mul_ps(_mm_and_ps(py, Abs), _mm_loadu_ps(B.EY + o))),
+                          _mm_mul_ps(_mm_and_ps(pz, Abs), _mm_loadu_ps(B.EZ + o)));
+    Outside = (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(d, _mm_sub_ps(_mm_setzero_ps(), r)));
+    Inside = (unsigned int)_mm_movemask_ps(_mm_cmpge_ps(d, r));
+}
+
+static inline unsigned int overlapsSSE(const AABB8& B, unsigned int o, const float* c, const float* e)
+{
+    const __m128 Abs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 x = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(_mm_loadu_ps(B.CX + o), _mm_set1_ps(c[0])), Abs),
+                            _mm_add_ps(_mm_loadu_ps(B.EX + o), _mm_set1_ps(e[0])));
+    __m128 y = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(_mm_loadu_ps(B.CY + o), _mm_set1_ps(c[1])), Abs),
+                            _mm_add_ps(_mm_loadu_ps(B.EY + o), _mm_set1_ps(e[1])));
+    __m128 z = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(_mm_loadu_ps(B.CZ + o), _mm_set1_ps(c[2])), Abs),
+                            _mm_add_ps(_mm_loadu_ps(B.EZ + o), _mm_set1_ps(e[2])));
+    return (unsigned int)_mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z));
+}
+
+MATRIX_SIMD_AVX_TARGET
+static void classifyAVX(const AABB8& B, const float* P, unsigned int& Outside, unsigned int& Inside)
+{
+    const __m256 Abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 px = _mm256_set1_ps(P[0]), py = _mm256_set1_ps(P[1]), pz = _mm256_set1_ps(P[2]);
+    __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, _mm256_loadu_ps(B.CX)),
+                                           _mm256_mul_ps(py, _mm256_loadu_ps(B.CY))),
+                             _mm256_add_ps(_mm256_mul_ps(pz, _mm256_loadu_ps(B.CZ)), _mm256_set1_ps(P[3])));
+    __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_and_ps(px, Abs), _mm256_loadu_ps(B.EX)),
+                                           _mm256_mul_ps(_mm256_and_ps(py, Abs), _mm256_loadu_ps(B.EY))),
+                             _mm256_mul_ps(_mm256_and_ps(pz, Abs), _mm256_loadu_ps(B.EZ)));
+    Outside = (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(d, _mm256_sub_ps(_mm256_setzero_ps(), r), _CMP_LT_OQ));
+    Inside = (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(d, r, _CMP_GE_OQ));
+}
+
+MATRIX_SIMD_AVX_TARGET
+static unsigned int overlapsAVX(const AABB8& B, const float* c, const float* e)
+{
+    const __m256 Abs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 x = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(B.CX), _mm256_set1_ps(c[0])), Abs),
+                             _mm256_add_ps(_mm256_loadu_ps(B.EX), _mm256_set1_ps(e[0])), _CMP_LE_OQ);
+    __m256 y = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(B.CY), _mm256_set1_ps(c[1])), Abs),
+                             _mm256_add_ps(_mm256_loadu_ps(B.EY), _mm256_set1_ps(e[1])), _CMP_LE_OQ);
+    __m256 z = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(_mm256_loadu_ps(B.CZ), _mm256_set1_ps(c[2])), Abs),
+                             _mm256_add_ps(_mm256_loadu_ps(B.EZ), _mm256_set1_ps(e[2])), _CMP_LE_OQ);
+    return (unsigned int)_mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(x, y), z));
+}
+
+#endif
+
+void AABB8::classify(const float* Plane, unsigned int& Outside, unsigned int& Inside) const
+{
+#ifdef MATRIX_SIMD_X86
+    const MatrixSIMD::ISA Level = MatrixSIMD::active();
+    if(Level >= MatrixSIMD::AVX)
+    {
+        classifyAVX(*this, Plane, Outside, Inside);
+    }
+    else if(Level >= MatrixSIMD::SSE2)
+    {
+        unsigned int OutHi, InHi;
+        classifySSE(*this, 0, Plane, Outside, Inside);
+        classifySSE(*this, 4, Plane, OutHi, InHi);
+        Outside |= OutHi << 4;
+        Inside |= InHi << 4;
+    }
+    else
+    {
+        classifyScalar(Plane, Outside, Inside);
+        return;
+    }
+    Outside &= validMask();
+    Inside &= validMask();
+#else
+    classifyScalar(Plane, Outside, Inside);
+#endif
+}
+
+unsigned int AABB8::overlaps(const AABB& Box) const
+{
+#ifdef MATRIX_SIMD_X86
+    const float cc[3] = { (Box.Min.X + Box.Max.X) * 0.5f, (Box.Min.Y + Box.Max.Y) * 0.5f, (Box.Min.Z + Box.Max.Z) * 0.5f };
+    const float e[3] = { std::fabs(Box.Max.X - Box.Min.X) * 0.5f, std::fabs(Box.Max.Y - Box.Min.Y) * 0.5f,
+                         std::fabs(Box.Max.Z - Box.Min.Z) * 0.5f };
+    const MatrixSIMD::ISA Level = MatrixSIMD::active();
+    if(Level >= MatrixSIMD::AVX)
+        return overlapsAVX(*this, cc, e) & validMask();
+    if(Level >= MatrixSIMD::SSE2)
+        return (overlapsSSE(*this, 0, cc, e) | (overlapsSSE(*this, 4, cc, e) << 4)) & validMask();
+#endif
+    return overlapsScalar(Box);
+}
@@ -2,7 +2,7 @@
 #define Aabb_hpp
 
 #include "vector.h"
-#include "matrix.h"
+#include "Matrix.h"
 
 class AABB
 {
@@ -20,8 +20,12 @@ public:
     Vector size() const;
     Vector getCenter() const;
     Vector getCenterBottom() const;
-    void   transform(const Matrix& matrix);   // in-place (8 Ecken)
+    // in-place; Zentrum/halbe Ausdehnung mit |M| (Arvo) statt 8 Ecken. Ergebnis ist
+    // dieselbe umschliessende Box, die letzte Matrixzeile wird ignoriert (affin)
+    void   transform(const Matrix& matrix);
+    void   translate(const Vector& delta);    // reine Verschiebung, ohne Matrix
     void   moveTo(const Vector& newCenter);
+    void   merge(const AABB& other);          // umschliesst danach beide
     void   verifyIntegrity();
 
     bool  isCollision = false;   // (Schreibfehler von isColission korrigiert)
@@ -32,4 +36,36 @@ public:
     Vector getSeparationVector(AABB* other);
 };
 
+// 8 Boxen als SoA (Zentrum + halbe Ausdehnung je Achse) fuer Tests gegen viele Boxen
+// auf einmal, z.B. Culling oder Breitphase. Ergebnisse sind Bitmasken, Bit i = Box i.
+// AVX prueft alle 8 in einem Schritt, SSE2 in zwei, sonst skalar (Stufe wie MatrixSIMD).
+class AABB8
+{
+public:
+    enum { SIZE = 8 };
+
+    AABB8();
+    // Eintrag i setzen (0..7); Count waechst bei Bedarf mit
+    void set(unsigned int i, const AABB& Box);
+    AABB get(unsigned int i) const;
+    void clear();
+    unsigned int count() const { return Count; }
+
+    // Ebene (nx, ny, nz, d), innen ist n*p + d >= 0. Outside: Box liegt komplett
+    // aussen, Inside: komplett innen; weder noch = schneidet die Ebene
+    void classify(const float* Plane, unsigned int& Outside, unsigned int& Inside) const;
+    // Boxen, die Box ueberlappen (Beruehrung zaehlt)
+    unsigned int overlaps(const AABB& Box) const;
+
+    // Referenz-Implementierungen
+    void classifyScalar(const float* Plane, unsigned int& Outside, unsigned int& Inside) const;
+    unsigned int overlapsScalar(const AABB& Box) const;
+
+    float CX[SIZE], CY[SIZE], CZ[SIZE];
+    float EX[SIZE], EY[SIZE], EZ[SIZE];
+protected:
+    unsigned int validMask() const { return (1u << Count) - 1u; }
+    unsigned int Count;
+};
+
 #endif /* Aabb_hpp */
@@ -24,6 +24,11 @@
 #include "triangleboxmodel.h"
 #include "model.h"
 #include "terrainshader.h"
+#include "TextureCache.h"
+#include "UniformBlocks.h"
+#include "GLState.h"
+#include "GLDispatch.h"
+#include <vector>
 
 
 #ifdef WIN32
@@ -33,14 +38,33 @@
 #endif
 
 
-Application::Application(GLFWwindow* pWin) : pWindow(pWin), Cam(pWin)
+Application::Application(GLFWwindow* pWin, bool BakeVT) : pWindow(pWin), Cam(pWin)
 {
+    CaptureKeys[0] = CaptureKeys[1] = false;
+    StatsTime = 0;
+    UseQueue = true;
+    QueueKey = false;
+    pDepthShader = new DepthShader();
+    DepthPrepass = true;
+    PrepassKey = false;
+    FillFrame = 0;
+    FillSamples = FillNanos = 0;
+    FillSamplesSum = FillNanosSum = 0;
+    FillResults = 0;
+    ProfileLogKey = false;
+    VisibleModels = 0;
+    TerrainShaders[0] = TerrainShaders[1] = NULL;
+    Tessellation = false;
+    TessKey = false;
+    glGenQueries(4, &FillQueries[0][0]);
     BaseModel* pModel;
     Cam.setPosition(Vector(0.0f, 40.0f, 120.0f));
     
     // --- Skybox ---
     skybox = new Model(ASSET_DIRECTORY "skybox.obj", false);
-    skybox->shader(new PhongShader(), true);
+    skybox->name("skybox");
+    // Himmel auf maximaler Tiefe, wird nach allen opaken Objekten gezeichnet
+    skybox->shader(new PhongShader(true, (PhongShader::ALL_FEATURES | PhongShader::SKY) & ~PhongShader::SHADOWS), true);
     Models.push_back(skybox);
    
     // --- Terrain ---
@@ -58,22 +82,38 @@ Application::Application(GLFWwindow* pWin) : pWindow(pWin), Cam(pWin)
 
     bool ok = pTerrainLocal->generateDiamondSquare(gridSize, roughness, seed,
                                                    worldScale, heightScale, wrapEdges);
-    TerrainShader* pTerrainShader = new TerrainShader(ASSET_DIRECTORY);
-    pTerrainLocal->shader(pTerrainShader, /*deleteOnDestruction*/ true);
-    pTerrainShader->setK(12);          // <<< WICHTIG: kein 0!
-    pTerrainShader->scaling(Vector(1,1,1));
+    // Beleuchtung aus 2x hochgerechneter Normal-Map statt Vertex-Normalen
+    ok = ok && pTerrainLocal->generateNormalMap(2, 0.08f);
     assert(ok);
 
+    // Virtuelle Textur: wird nur mit --bake-vt gebacken (~340 MB, dauert), im Normalbetrieb
+    // nur seitenweise gestreamt. Fehlt die Datei, nimmt der Shader die gekachelten Detail-Maps.
+    {
+        const char* vtFile = ASSET_DIRECTORY "mars_albedo.vtex";
+        if (BakeVT && !pTerrainLocal->bakeVirtualTexture(vtFile, 8192))
+            std::cout << "Terrain: Backen von " << vtFile << " fehlgeschlagen" << std::endl;
+        // Atlas und Page-Table gehen an GL vorbei, mit --gl noop also ohne VT
+        if (GLDispatch::target() == GLDispatch::NOOP)
+            std::cout << "Terrain: GL-Backend noop, ohne virtuelle Textur" << std::endl;
+        else if (!TerrainVT.open(vtFile, ASSET_DIRECTORY))
+            std::cout << "Terrain: ohne virtuelle Textur, Detail-Maps gekachelt (erzeugen mit --bake-vt)" << std::endl;
+    }
+    // Shader gehoeren der Application, F6 tauscht sie
+    TerrainShaders[0] = createTerrainShader(false);
+    pTerrainLocal->shader(TerrainShaders[0]);
+
     {   // Terrain in die Mitte legen
         const float halfX = (gridSize - 1) * worldScale * 0.5f;
         const float halfZ = (gridSize - 1) * worldScale * 0.5f;
         Matrix t; t.translation(Vector(-halfX, 0.0f, -halfZ));
         pTerrainLocal->transform(t * pTerrainLocal->transform());
+        pTerrainLocal->name("terrain");
         Models.push_back(pTerrainLocal);
         pTerrain = pTerrainLocal;
     }
     // --- Drone ---
     playerDrone = new Drone(ASSET_DIRECTORY);
+    playerDrone->name("drone");
     playerDrone->setBaseHoverHeight(0.9f);
     playerDrone->placeOnTerrain(pTerrain, 0.0f, 0.0f);
     Models.push_back(playerDrone);
@@ -95,15 +135,74 @@ Application::Application(GLFWwindow* pWin) : pWindow(pWin), Cam(pWin)
 }
 void Application::start()
 {
-    glEnable (GL_DEPTH_TEST); // enable depth-testing
-    glDepthFunc (GL_LESS); // depth-testing interprets a smaller value as "closer"
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glEnable(GL_BLEND);
-    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::invalidate();
+    GLState::enable(GL_DEPTH_TEST); // enable depth-testing
+    GLState::depthFunc(GL_LESS); // depth-testing interprets a smaller value as "closer"
+    GLState::enable(GL_CULL_FACE);
+    GLState::cullFace(GL_BACK);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Schatten, Profiler und Aufnahme legen ihre Texturen, Framebuffer und Queries direkt
+    // in GL an und binden sie teils ueber GLState; mit --gl noop waeren diese Namen nie
+    // gebunden. Ohne GPU-Arbeit gibt es dort ohnehin nichts zu messen.
+    if (GLDispatch::target() == GLDispatch::NOOP)
+        return;
+    Profiler.init();
+
+    // ferne Kaskaden seltener nachziehen: dort wandert die Kamera langsam ueber die Texel
+    if (Shadows.init(2048, 4, 300.0f)) {
+        const unsigned int Intervals[4] = { 1, 1, 2, 4 };
+        for (unsigned int c = 0; c < 4; ++c)
+            Shadows.updateInterval(c, Intervals[c]);
+        if (pTerrain) Shadows.staticModel(pTerrain);
+        if (playerDrone) Shadows.dynamicModel(playerDrone);
+    }
 }
 
 void Application::update(float dtime) {
+    // --- Aufnahme: F12 Screenshot, F10 Bildsequenz an/aus ---
+    const bool shotKey = glfwGetKey(pWindow, GLFW_KEY_F12) == GLFW_PRESS;
+    const bool recKey  = glfwGetKey(pWindow, GLFW_KEY_F10) == GLFW_PRESS;
+    if (shotKey && !CaptureKeys[0])
+        Capture.screenshot();
+    if (recKey && !CaptureKeys[1]) {
+        if (Capture.recording()) Capture.stopSequence();
+        else Capture.startSequence("capture_");
+    }
+    CaptureKeys[0] = shotKey;
+    CaptureKeys[1] = recKey;
+
+    // F9: RenderQueue an/aus (Vergleich der Zustandswechsel im Fenstertitel)
+    const bool queueKey = glfwGetKey(pWindow, GLFW_KEY_F9) == GLFW_PRESS;
+    if (queueKey && !QueueKey)
+        UseQueue = !UseQueue;
+    QueueKey = queueKey;
+
+    // F8: Depth-Pre-Pass an/aus
+    const bool prepassKey = glfwGetKey(pWindow, GLFW_KEY_F8) == GLFW_PRESS;
+    if (prepassKey && !PrepassKey)
+        DepthPrepass = !DepthPrepass;
+    PrepassKey = prepassKey;
+
+    // F6: Terrain als grobe Patches, Verfeinerung per Tessellation auf der GPU
+    const bool tessKey = glfwGetKey(pWindow, GLFW_KEY_F6) == GLFW_PRESS;
+    if (tessKey && !TessKey && pTerrain) {
+        Tessellation = !Tessellation;
+        if (!TerrainShaders[Tessellation ? 1 : 0])
+            TerrainShaders[Tessellation ? 1 : 0] = createTerrainShader(Tessellation);
+        pTerrain->shader(TerrainShaders[Tessellation ? 1 : 0]);
+    }
+    TessKey = tessKey;
+
+    // F7: GPU-Zeiten pro Frame als CSV mitschreiben an/aus
+    const bool profileKey = glfwGetKey(pWindow, GLFW_KEY_F7) == GLFW_PRESS;
+    if (profileKey && !ProfileLogKey) {
+        if (Profiler.isValid() && !Profiler.logging()) Profiler.openLog("gpu_profile.csv");
+        else Profiler.closeLog();
+    }
+    ProfileLogKey = profileKey;
+
     // --- Drone Eingaben + Terrain-Follow ---
     if (playerDrone) {
         playerDrone->handleInput(pWindow, dtime);
@@ -141,23 +240,198 @@ void Application::update(float dtime) {
 
 void Application::draw()
 {
+    int w = 0, h = 0;
+    glfwGetFramebufferSize(pWindow, &w, &h);
+
+    // GL-Zustandswechsel des letzten Frames: einmal pro Sekunde im Fenstertitel
+    GLState::beginFrame();
+    GLDispatch::beginFrame();
+    Profiler.beginFrame();
+    const double now = glfwGetTime();
+    if (now - StatsTime >= 1.0) {
+        StatsTime = now;
+        const GLState::Stats& s = GLState::lastFrame();
+        char title[256];
+        snprintf(title, sizeof(title), "Computergrafik - %s%s%s: %u Zustandswechsel, %u redundante vermieden"
+                 " | opak %dx%d: %.2f MFragmente, %.2f ms | GPU %.2f ms | Schatten %u/%u/%u/%u"
+                 " | sichtbar %u/%u",
+                 UseQueue ? "RenderQueue" : "Listenreihenfolge",
+                 (UseQueue && DepthPrepass) ? " + Pre-Pass" : "",
+                 Tessellation ? " + Tessellation" : "",
+                 s.Calls - s.Skipped, s.Skipped, w, h, FillSamples / 1.0e6, FillNanos / 1.0e6, Profiler.frameMs(),
+                 Shadows.updates(0), Shadows.updates(1), Shadows.updates(2), Shadows.updates(3),
+                 VisibleModels, (unsigned int)Models.size());
+        glfwSetWindowTitle(pWindow, title);
+    }
+
+    // Kamera + Licht einmal pro Frame in den Frame-Block
+    UniformBlocks::beginFrame(Cam, w, h);
+
+    // unsichtbare Modelle fallen vor allen GL-Aufrufen heraus
+    ViewFrustum.extract(Cam);
+    std::vector<BaseModel*> Visible;
+    Visible.reserve(Models.size());
+    for( ModelList::iterator it = Models.begin(); it != Models.end(); ++it )
+        if ((*it)->isVisible(ViewFrustum))
+            Visible.push_back(*it);
+    VisibleModels = (unsigned int)Visible.size();
+
+    // Schattenkaskaden nachziehen (nur veraltete), Sonne = Richtung von LightPos
+    if (Shadows.isValid()) {
+        Shadows.update(Cam, UniformBlocks::lightPos(), w, h, pDepthShader, &Profiler);
+        Shadows.activate();
+    }
+
+    // Tiefenpuffer beschreibbar fuer die glClear-Aufrufe
+    GLState::depthMask(true);
+    GLState::depthFunc(GL_LESS);
+
+    // 0. Feedback-Pass: benötigte Seiten der virtuellen Textur ermitteln
+    if (TerrainVT.isValid() && pTerrain) {
+        Profiler.begin("vt feedback");
+        TerrainVT.beginFeedback(w, h);
+        pTerrain->drawFeedback(Cam, TerrainVT.feedbackShader());
+        TerrainVT.endFeedback();
+        TerrainVT.update();
+        Profiler.end();
+    }
+
     // 1. clear screen
     glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // 2. setup shaders and draw models
-    for( ModelList::iterator it = Models.begin(); it != Models.end(); ++it )
-    {
-        (*it)->draw(Cam);
+    if (UseQueue) {
+        // einreichen, nach Pass/Shader/Material/Tiefe sortieren, ausfuehren
+        Queue.clear();
+        for (size_t i = 0; i < Visible.size(); ++i)
+            Visible[i]->submit(Queue, Cam);
+        Queue.sort();
+
+        // a) optional nur Tiefe der opaken Geometrie, danach shadet jedes Pixel genau einmal
+        if (DepthPrepass) {
+            Profiler.begin("depth prepass");
+            GLState::colorMask(false);
+            Queue.executeDepth(Cam, pDepthShader);
+            Profiler.end();
+            GLState::colorMask(true);
+            GLState::depthFunc(GL_EQUAL);
+            GLState::depthMask(false);
+        }
+        // b) opak (vorn nach hinten)
+        Profiler.begin("opaque");
+        beginFillQuery();
+        Queue.execute(Cam, RenderQueue::PASS_OPAQUE, &Profiler);
+        endFillQuery();
+        Profiler.end();
+        // c) Alpha-Test (vorn nach hinten, schreibt Tiefe; fehlt im Pre-Pass wegen discard)
+        GLState::depthFunc(GL_LESS);
+        GLState::depthMask(true);
+        Profiler.begin("cutout");
+        Queue.execute(Cam, RenderQueue::PASS_CUTOUT, &Profiler);
+        Profiler.end();
+        // d) Himmel auf z = w nur dort, wo noch nichts steht
+        GLState::depthFunc(GL_LEQUAL);
+        GLState::depthMask(false);
+        Profiler.begin("sky");
+        Queue.execute(Cam, RenderQueue::PASS_SKY, &Profiler);
+        Profiler.end();
+        // e) geblendet (hinten nach vorn)
+        GLState::depthFunc(GL_LESS);
+        GLState::depthMask(true);
+        Profiler.begin("blended");
+        Queue.execute(Cam, RenderQueue::PASS_BLENDED, &Profiler);
+        Profiler.end();
+    } else {
+        // Listenreihenfolge: LEQUAL, damit der Himmel auf maximaler Tiefe sichtbar bleibt
+        GLState::depthFunc(GL_LEQUAL);
+        beginFillQuery();
+        for (size_t i = 0; i < Visible.size(); ++i)
+        {
+            Profiler.begin(Visible[i]->name());
+            Visible[i]->draw(Cam);
+            Profiler.end();
+        }
+        endFillQuery();
     }
     
-    // 3. check once per frame for opengl errors
+    // mit --gl noop gibt es weder Bild noch gebundene Objekte fuer Aufnahme und Fehlerpruefung
+    if (GLDispatch::target() == GLDispatch::NOOP)
+        return;
+
+    // 3. Frame ggf. asynchron aufnehmen (vor dem Swap)
+    Profiler.begin("capture");
+    Capture.captureFrame(pWindow);
+    Profiler.end();
+    Profiler.endFrame();
+
+    // 4. check once per frame for opengl errors
     GLenum Error = glGetError();
     assert(Error==0);
 }
+TerrainShader* Application::createTerrainShader(bool Tessellation)
+{
+    TerrainShader* pShader = new TerrainShader(ASSET_DIRECTORY, Tessellation);
+    pShader->setK(12);          // <<< WICHTIG: kein 0!
+    pShader->scaling(Vector(1,1,1));
+    if (TerrainVT.isValid())
+        pShader->virtualTex(&TerrainVT);
+    return pShader;
+}
+
+void Application::beginFillQuery()
+{
+    // Ergebnis des Vorframes abholen, sofern der Treiber es schon hat
+    GLuint* prev = FillQueries[(FillFrame + 1) & 1];
+    if (FillFrame > 0) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(prev[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            glGetQueryObjectui64v(prev[0], GL_QUERY_RESULT, &FillSamples);
+            glGetQueryObjectui64v(prev[1], GL_QUERY_RESULT, &FillNanos);
+            FillSamplesSum += FillSamples;
+            FillNanosSum += FillNanos;
+            FillResults++;
+        }
+    }
+    GLuint* cur = FillQueries[FillFrame & 1];
+    glBeginQuery(GL_SAMPLES_PASSED, cur[0]);
+    glBeginQuery(GL_TIME_ELAPSED, cur[1]);
+}
+
+void Application::endFillQuery()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    glEndQuery(GL_SAMPLES_PASSED);
+    FillFrame++;
+}
+
 void Application::end()
 {
+    Capture.stopSequence();
+    Capture.finish();
+
     for( ModelList::iterator it = Models.begin(); it != Models.end(); ++it )
         delete *it;
     
     Models.clear();
+    delete TerrainShaders[0];
+    delete TerrainShaders[1];
+    TerrainShaders[0] = TerrainShaders[1] = NULL;
+    delete pDepthShader;
+    pDepthShader = NULL;
+    glDeleteQueries(4, &FillQueries[0][0]);
+    Profiler.print();
+    Profiler.closeLog();
+    Profiler.release();
+    Shadows.release();
+    TerrainVT.close();
+    TextureCache::instance().printStats();
+    if (FillResults > 0)
+        std::cout << "Fill: opaker Pass im Mittel " << FillSamplesSum / 1.0e6 / FillResults << " MFragmente, "
+                  << FillNanosSum / 1.0e6 / FillResults << " ms GPU (" << FillResults << " Frames, "
+                  << (DepthPrepass ? "mit" : "ohne") << " Pre-Pass)" << std::endl;
+    const GLState::Stats& gs = GLState::total();
+    std::cout << "GLState: " << gs.Skipped << " von " << gs.Calls << " Zustandswechseln redundant ("
+              << (gs.Calls ? 100.0 * gs.Skipped / gs.Calls : 0.0) << " %)" << std::endl;
+    UniformBlocks::release();
 }
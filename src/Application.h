@@ -19,24 +19,66 @@
 #include "basemodel.h"
 #include "terrain.h"
 #include "Drone.h"
+#include "FrameCapture.h"
+#include "VirtualTexture.h"
+#include "RenderQueue.h"
+#include "DepthShader.h"
+#include "GPUProfiler.h"
+#include "ShadowMaps.h"
+#include "Frustum.h"
 
 class Application
 {
 public:
     typedef std::list<BaseModel*> ModelList;
-    Application(GLFWwindow* pWin);
+    // BakeVT: virtuelle Textur des Terrains neu backen (--bake-vt), sonst nur laden
+    Application(GLFWwindow* pWin, bool BakeVT = false);
     void start();
     void update(float dtime);
     void draw();
     void end();
+    // Startzustand von F8/F9 fuer Messlaeufe (--no-prepass, --no-queue)
+    void depthPrepass(bool On) { DepthPrepass = On; }
+    void renderQueue(bool On) { UseQueue = On; }
 
 protected:
+    // GPU-Zaehler fuer den opaken Shading-Pass (Fragmente + Zeit), gelesen einen Frame spaeter
+    void beginFillQuery();
+    void endFillQuery();
+    // TerrainShader mit den Einstellungen dieser Szene (k, virtuelle Textur)
+    TerrainShader* createTerrainShader(bool Tessellation);
+
     Camera Cam;
     ModelList Models;
     GLFWwindow* pWindow;
     Terrain* pTerrain;
+    TerrainShader* TerrainShaders[2]; // [0] Dreiecksnetz, [1] Tessellation (erst bei Bedarf erzeugt)
+    bool Tessellation;      // F6
+    bool TessKey;
     Drone* playerDrone;
     BaseModel*  skybox; 
+    VirtualTexture TerrainVT; // terrainweite Albedo, gestreamt
+    FrameCapture Capture;   // F12 Screenshot, F10 Aufnahme an/aus
+    bool CaptureKeys[2];    // Flankenerkennung F12/F10
+    RenderQueue Queue;      // sortierte Draws, F9 schaltet zurueck auf Listenreihenfolge
+    bool UseQueue;
+    bool QueueKey;
+    DepthShader* pDepthShader; // Depth-Pre-Pass (F8), nur mit RenderQueue
+    bool DepthPrepass;
+    bool PrepassKey;
+    GLuint FillQueries[2][2];  // [Frame%2][GL_SAMPLES_PASSED, GL_TIME_ELAPSED]
+    unsigned int FillFrame;
+    GLuint64 FillSamples;
+    GLuint64 FillNanos;
+    GLuint64 FillSamplesSum;   // Summen ueber alle gelesenen Frames, Mittelwert in end()
+    GLuint64 FillNanosSum;
+    unsigned int FillResults;
+    double StatsTime;       // letzte Aktualisierung der GL-Statistik im Fenstertitel
+    GPUProfiler Profiler;   // GPU-Zeit pro Pass und Modell, F7 schreibt gpu_profile.csv
+    bool ProfileLogKey;
+    ShadowMaps Shadows;     // Sonnenschatten: Terrain statisch (gecacht), Drohne dynamisch
+    Frustum ViewFrustum;    // Sichtvolumen der Kamera, pro Frame neu
+    unsigned int VisibleModels; // nach dem Culling im letzten Frame gezeichnet
 };
 
 #endif /* Application_hpp */
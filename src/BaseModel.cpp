@@ -7,12 +7,33 @@
 //
 
 #include "BaseModel.h"
+#include "DepthShader.h"
+#include "Frustum.h"
 
-BaseModel::BaseModel() : pShader(NULL), DeleteShader(false)
+BaseModel::BaseModel() : pShader(NULL), DeleteShader(false), Name("model"), HasBounds(false), WorldBoundsDirty(true), CullPlane(0)
 {
     Transform.identity();
 }
 
+const AABB& BaseModel::worldBounds() const
+{
+    if(WorldBoundsDirty)
+    {
+        WorldBounds = LocalBounds;
+        WorldBounds.transform(Transform);
+        WorldBoundsDirty = false;
+    }
+    return WorldBounds;
+}
+
+bool BaseModel::isVisible(const Frustum& F) const
+{
+    if(!HasBounds)
+        return true;
+    unsigned int Mask = Frustum::ALL_PLANES;
+    return F.aabb(worldBounds(), Mask, CullPlane) != Frustum::OUTSIDE;
+}
+
 BaseModel::~BaseModel()
 {
     if(DeleteShader && pShader)
@@ -27,6 +48,32 @@ void BaseModel::shader( BaseShader* shader, bool deleteOnDestruction )
     DeleteShader = deleteOnDestruction;
 }
 
+void BaseModel::submit(RenderQueue& Queue, const BaseCamera& Cam)
+{
+    if(!pShader)
+        return;
+    const float Depth = (Transform.translation() - Cam.position()).length();
+    Queue.submit(RenderQueue::PASS_OPAQUE, pShader->program(), 0, Depth, this, 0, Transform);
+}
+
+void BaseModel::drawItem(const BaseCamera& Cam, const RenderQueue::Item& Item)
+{
+    draw(Cam);
+}
+
+void BaseModel::drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader)
+{
+    BaseShader* pSaved = pShader;
+    pShader = pDepthShader;
+    draw(Cam);
+    pShader = pSaved;
+}
+
+void BaseModel::drawShadow(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader)
+{
+    drawDepth(Cam, Item, pDepthShader);
+}
+
 void BaseModel::draw(const BaseCamera& Cam)
 {
     if(!pShader) {
@@ -10,9 +10,14 @@
 #define BaseModel_hpp
 
 #include <stdio.h>
+#include <string>
 #include "camera.h"
 #include "matrix.h"
 #include "baseshader.h"
+#include "RenderQueue.h"
+#include "Aabb.h"
+
+class Frustum;
 
 class BaseModel
 {
@@ -20,14 +25,37 @@ public:
     BaseModel();
     virtual ~BaseModel();
     virtual void draw(const BaseCamera& Cam);
+    // Teile in die RenderQueue einreichen; Standard: ein opakes Item, das draw() aufruft
+    virtual void submit(RenderQueue& Queue, const BaseCamera& Cam);
+    virtual void drawItem(const BaseCamera& Cam, const RenderQueue::Item& Item);
+    // Item nur in den Tiefenpuffer; Standard: draw() mit vorübergehend getauschtem Shader
+    virtual void drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader);
+    // Item als Schattenwerfer (Licht-Kamera); Standard: wie drawDepth()
+    virtual void drawShadow(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader);
     const Matrix& transform() const { return Transform; }
-    void transform( const Matrix& m) { Transform = m; }
+    void transform( const Matrix& m) { Transform = m; WorldBoundsDirty = true; }
     virtual void shader( BaseShader* shader, bool deleteOnDestruction=false );
     virtual BaseShader* shader() const { return pShader; }
+    // Anzeigename, z.B. fuer den GPUProfiler
+    const char* name() const { return Name.c_str(); }
+    void name( const char* n) { Name = n; }
+    // Huelle im Modellraum (vor transform()) fuer Culling; ohne Huelle immer sichtbar
+    void bounds( const AABB& Local) { LocalBounds = Local; HasBounds = true; WorldBoundsDirty = true; }
+    bool hasBounds() const { return HasBounds; }
+    // Weltraum-Huelle, wird nach einer Aenderung von transform() neu berechnet
+    const AABB& worldBounds() const;
+    // Test gegen das Sichtvolumen; die verwerfende Ebene wird fuer den naechsten Frame gemerkt
+    bool isVisible(const Frustum& F) const;
 protected:
     Matrix Transform;
     BaseShader* pShader;
     bool DeleteShader;
+    std::string Name;
+    AABB LocalBounds;
+    bool HasBounds;
+    mutable AABB WorldBounds;
+    mutable bool WorldBoundsDirty;
+    mutable unsigned int CullPlane;
         
 };
 
@@ -7,84 +7,256 @@
 //
 
 #include "BaseShader.h"
+#include "GLDispatch.h"
+#include "UniformBlocks.h"
+#include "GLState.h"
+#include <string>
+#include <vector>
+#include <cstring>
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
-const BaseShader* BaseShader::ShaderInPipe = NULL;
+std::string BaseShader::CacheDirectory = "shadercache/";
+BaseShader::CompileStats BaseShader::Stats = { 0, 0, 0, 0.0 };
+
+// Binärdatei: Magic, Binärformat, Länge, danach die Daten von glGetProgramBinary
+static const unsigned int PROGRAM_BINARY_MAGIC = 0x4E494250; // "PBIN"
 
 BaseShader::BaseShader()
 {
     ModelTransform.identity();
 }
 
-bool BaseShader::load( const char* VertexShaderFile, const char* FragmentShaderFile )
+bool BaseShader::load( const char* VertexShaderFile, const char* FragmentShaderFile, const char* Defines )
 {
-    unsigned int VSFileSize=0;
-    unsigned int FSFileSize=0;
-    char* VSFileData = NULL;
-    char* FSFileData = NULL;
-    
-    VSFileData = loadFile(VertexShaderFile, VSFileSize);
-    if( !VSFileData)
+    return load(VertexShaderFile, NULL, NULL, FragmentShaderFile, Defines);
+}
+
+bool BaseShader::load( const char* VertexShaderFile, const char* TessControlShaderFile, const char* TessEvalShaderFile,
+                       const char* FragmentShaderFile, const char* Defines )
+{
+    const char* Files[4] = { VertexShaderFile, TessControlShaderFile, TessEvalShaderFile, FragmentShaderFile };
+    std::string Code[4];
+    for(unsigned int i=0; i<4; ++i)
     {
-        std::cout << "Unable to load shader file " << VertexShaderFile << std::endl;
-        return false;
+        if(!Files[i])
+            continue;
+        unsigned int FileSize=0;
+        char* FileData = loadFile(Files[i], FileSize);
+        if( !FileData)
+        {
+            std::cout << "Unable to load shader file " << Files[i] << std::endl;
+            return false;
+        }
+        Code[i] = injectDefines(FileData, Defines);
+        delete [] FileData;
     }
     
-    FSFileData = loadFile(FragmentShaderFile, FSFileSize);
-    if( !FSFileData)
+    ShaderProgram = createShaderProgram(Code[0].c_str(), Code[3].c_str(),
+                                        Files[1] ? Code[1].c_str() : NULL,
+                                        Files[2] ? Code[2].c_str() : NULL);
+    return true;
+}
+
+void BaseShader::programCacheDirectory(const char* Directory)
+{
+    CacheDirectory = Directory ? Directory : "";
+    if(!CacheDirectory.empty() && CacheDirectory[CacheDirectory.size()-1] != '/')
+        CacheDirectory += '/';
+}
+
+uint64_t BaseShader::programKey(const char* const* Sources, unsigned int Count)
+{
+    // FNV-1a über alle Stufen (inkl. eingefügter #defines) und den Treiber
+    const char* Driver[3] = {
+        (const char*)GLDispatch::getString(GL_VENDOR),
+        (const char*)GLDispatch::getString(GL_RENDERER),
+        (const char*)GLDispatch::getString(GL_VERSION) };
+
+    uint64_t h = 14695981039346656037ull;
+    for(unsigned int i=0; i<Count+3; ++i)
     {
-        std::cout << "Unable to load shader file " << FragmentShaderFile << std::endl;
-        return false;
+        const char* p = i<Count ? Sources[i] : Driver[i-Count];
+        for(; p && *p; ++p)
+        {
+            h ^= (unsigned char)*p;
+            h *= 1099511628211ull;
+        }
+        h ^= 0xFF; // Trenner zwischen den Strings
+        h *= 1099511628211ull;
     }
+    return h;
+}
+
+std::string BaseShader::programCacheFile(uint64_t Key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)Key);
+    return CacheDirectory + name;
+}
+
+std::string BaseShader::injectDefines(const char* Code, const char* Defines)
+{
+    std::string Src(Code);
+    if(!Defines || !*Defines)
+        return Src;
     
-    ShaderProgram = createShaderProgram(VSFileData, FSFileData);
-    
-    delete [] VSFileData;
-    delete [] FSFileData;
-    
-    return true;
+    // #version muss die erste Anweisung bleiben -> Defines in die Zeile danach
+    size_t Pos = 0;
+    const size_t Version = Src.find("#version");
+    if(Version != std::string::npos)
+    {
+        Pos = Src.find('\n', Version);
+        Pos = (Pos == std::string::npos) ? Src.size() : Pos+1;
+    }
+    std::string Block(Defines);
+    if(Block[Block.size()-1] != '\n')
+        Block += '\n';
+    if(Pos == Src.size() && Pos > 0 && Src[Pos-1] != '\n')
+        Block.insert(Block.begin(), '\n');
+    Src.insert(Pos, Block);
+    return Src;
+}
+
+GLuint BaseShader::loadProgramBinary(uint64_t Key)
+{
+    if(CacheDirectory.empty())
+        return 0;
+    GLint Formats = 0;
+    GLDispatch::getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &Formats);
+    if(Formats <= 0)
+        return 0;
+
+    FILE* pFile = fopen(programCacheFile(Key).c_str(), "rb");
+    if(!pFile)
+        return 0;
+
+    unsigned int Header[3] = {0,0,0};
+    std::vector<char> Data;
+    bool ok = fread(Header, sizeof(unsigned int), 3, pFile) == 3 && Header[0] == PROGRAM_BINARY_MAGIC && Header[2] > 0;
+    if(ok)
+    {
+        Data.resize(Header[2]);
+        ok = fread(&Data[0], 1, Header[2], pFile) == Header[2];
+    }
+    fclose(pFile);
+    if(!ok)
+        return 0;
+
+    GLuint Program = GLDispatch::createProgram();
+    GLDispatch::programBinary(Program, (GLenum)Header[1], &Data[0], (GLsizei)Header[2]);
+    GLint Success = GL_FALSE;
+    GLDispatch::getProgramiv(Program, GL_LINK_STATUS, &Success);
+    if(Success == GL_FALSE)
+    {
+        // z.B. nach Treiber-Update: verwerfen und neu kompilieren
+        GLDispatch::deleteProgram(Program);
+        while(GLDispatch::getError() != GL_NO_ERROR) {}
+        return 0;
+    }
+    return Program;
+}
+
+void BaseShader::saveProgramBinary(GLuint Program, uint64_t Key)
+{
+    if(CacheDirectory.empty())
+        return;
+    GLint Formats = 0;
+    GLDispatch::getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &Formats);
+    if(Formats <= 0)
+        return;
+
+    GLint Length = 0;
+    GLDispatch::getProgramiv(Program, GL_PROGRAM_BINARY_LENGTH, &Length);
+    if(Length <= 0)
+        return;
+    std::vector<char> Data(Length);
+    GLenum Format = 0;
+    GLDispatch::getProgramBinary(Program, Length, &Length, &Format, &Data[0]);
+
+#ifdef WIN32
+    _mkdir(CacheDirectory.c_str());
+#else
+    mkdir(CacheDirectory.c_str(), 0755);
+#endif
+    FILE* pFile = fopen(programCacheFile(Key).c_str(), "wb");
+    if(!pFile)
+        return;
+    unsigned int Header[3] = { PROGRAM_BINARY_MAGIC, (unsigned int)Format, (unsigned int)Length };
+    fwrite(Header, sizeof(unsigned int), 3, pFile);
+    fwrite(&Data[0], 1, Length, pFile);
+    fclose(pFile);
+}
+
+void BaseShader::printCompileStats()
+{
+    std::cout << "Shader: " << Stats.Compiled << " kompiliert, " << Stats.FromCache << " aus dem Binär-Cache";
+    if(Stats.Rejected) std::cout << " (" << Stats.Rejected << " verworfen)";
+    std::cout << ", " << (Stats.Seconds*1000.0) << " ms" << std::endl;
 }
 
-GLuint BaseShader::createShaderProgram( const char* VScode, const char* FScode )
+GLuint BaseShader::createShaderProgram( const char* VScode, const char* FScode, const char* TCScode, const char* TEScode )
 {
     ModelTransform.identity();
+    const double StartTime = glfwGetTime();
+
+    // Reihenfolge VS, FS, TCS, TES -> Schluessel fuer reine VS/FS-Programme unveraendert
+    const char* Sources[4] = { VScode, FScode, TCScode, TEScode };
+    unsigned int SourceCount = 2;
+    if(TCScode) Sources[SourceCount++] = TCScode;
+    if(TEScode) Sources[SourceCount++] = TEScode;
+    const uint64_t Key = programKey(Sources, SourceCount);
+    ShaderProgram = loadProgramBinary(Key);
+    if(ShaderProgram)
+    {
+        UniformBlocks::bindProgram(ShaderProgram);
+        Stats.FromCache++;
+        Stats.Seconds += glfwGetTime() - StartTime;
+        return ShaderProgram;
+    }
+    {
+        FILE* pFile = CacheDirectory.empty() ? NULL : fopen(programCacheFile(Key).c_str(), "rb");
+        if(pFile) { fclose(pFile); Stats.Rejected++; }
+    }
+
     const unsigned int LogSize = 64*1024;
     char ShaderLog[LogSize];
     GLsizei WrittenToLog=0;
     GLint Success = 0;
     
-    GLuint VS = glCreateShader(GL_VERTEX_SHADER);
-    GLuint FS = glCreateShader(GL_FRAGMENT_SHADER);
+    // Pipeline-Reihenfolge; Tessellation-Stufen sind optional
+    const char* Code[4] = { VScode, TCScode, TEScode, FScode };
+    const GLenum Types[4] = { GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_FRAGMENT_SHADER };
+    const char* Prefix[4] = { "VS:", "TCS:", "TES:", "FS:" };
+    GLuint Shaders[4] = { 0, 0, 0, 0 };
+    for(unsigned int i=0; i<4; ++i)
+        if(Code[i])
+            Shaders[i] = GLDispatch::createShader(Types[i]);
     
-    GLenum Error = glGetError();
+    GLenum Error = GLDispatch::getError();
     if(Error!=0)
     {
         std::cout << "Unable to create shader objects. Please ensure that the Shader is used for the first time AFTER successful creation of an OpenGL context!";
         exit(0);
     }
     
-    glShaderSource(VS, 1, &VScode, NULL);
-    glShaderSource(FS, 1, &FScode, NULL);
-    
-    glCompileShader(VS);
-    glGetShaderiv(VS, GL_COMPILE_STATUS, &Success);
-    if(Success==GL_FALSE)
+    for(unsigned int i=0; i<4; ++i)
     {
-        sprintf(ShaderLog, "VS:");
-        WrittenToLog+=3;
-        GLsizei Written=0;
-        glGetShaderInfoLog(VS, LogSize-WrittenToLog, &Written, &ShaderLog[WrittenToLog]);
-        WrittenToLog+=Written;
-    }
-
-    glCompileShader(FS);
-    glGetShaderiv(FS, GL_COMPILE_STATUS, &Success);
-    if(Success==GL_FALSE)
-    {
-        sprintf(&ShaderLog[WrittenToLog], "FS:");
-        WrittenToLog+=3;
-        GLsizei Written=0;
-        glGetShaderInfoLog(FS, LogSize-WrittenToLog, &Written, &ShaderLog[WrittenToLog]);
-        WrittenToLog+=Written;
+        if(!Shaders[i])
+            continue;
+        GLDispatch::shaderSource(Shaders[i], 1, &Code[i], NULL);
+        GLDispatch::compileShader(Shaders[i]);
+        GLDispatch::getShaderiv(Shaders[i], GL_COMPILE_STATUS, &Success);
+        if(Success==GL_FALSE)
+        {
+            WrittenToLog += sprintf(&ShaderLog[WrittenToLog], "%s", Prefix[i]);
+            GLsizei Written=0;
+            GLDispatch::getShaderInfoLog(Shaders[i], LogSize-WrittenToLog, &Written, &ShaderLog[WrittenToLog]);
+            WrittenToLog+=Written;
+        }
     }
     
     if( WrittenToLog > 0 )
@@ -94,18 +266,22 @@ GLuint BaseShader::createShaderProgram( const char* VScode, const char* FScode )
         exit(0);
     }
     
-    ShaderProgram = glCreateProgram();
+    ShaderProgram = GLDispatch::createProgram();
     assert(ShaderProgram);
     
-    glAttachShader(ShaderProgram, VS);
-    glDeleteShader(VS);
-    glAttachShader(ShaderProgram, FS);
-    glDeleteShader(FS);
-    glLinkProgram(ShaderProgram);
+    for(unsigned int i=0; i<4; ++i)
+    {
+        if(!Shaders[i])
+            continue;
+        GLDispatch::attachShader(ShaderProgram, Shaders[i]);
+        GLDispatch::deleteShader(Shaders[i]);
+    }
+    GLDispatch::programParameteri(ShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    GLDispatch::linkProgram(ShaderProgram);
     
-    glGetProgramiv(ShaderProgram, GL_LINK_STATUS, &Success);
+    GLDispatch::getProgramiv(ShaderProgram, GL_LINK_STATUS, &Success);
     if(Success==GL_FALSE)
-        glGetShaderInfoLog(ShaderProgram, LogSize-WrittenToLog, NULL, &ShaderLog[WrittenToLog]);
+        GLDispatch::getShaderInfoLog(ShaderProgram, LogSize-WrittenToLog, NULL, &ShaderLog[WrittenToLog]);
 
     if( WrittenToLog > 0 )
     {
@@ -113,6 +289,10 @@ GLuint BaseShader::createShaderProgram( const char* VScode, const char* FScode )
         std::cout << ShaderLog;
         exit(0);
     }
+    saveProgramBinary(ShaderProgram, Key);
+    UniformBlocks::bindProgram(ShaderProgram);
+    Stats.Compiled++;
+    Stats.Seconds += glfwGetTime() - StartTime;
     return ShaderProgram;
 }
 
@@ -142,42 +322,40 @@ char* BaseShader::loadFile( const char* File, unsigned int& Filesize )
 
 void BaseShader::activate(const BaseCamera& Cam) const
 {
-    if(ShaderInPipe != this)
-        glUseProgram(ShaderProgram);
-    ShaderInPipe = this;
+    GLState::useProgram(ShaderProgram);
 }
 
 
 void BaseShader::deactivate() const
 {
-    glUseProgram(0);
+    GLState::useProgram(0);
 }
 
 GLint BaseShader::getParameterID(const char* ParamenterName) const
 {
-    return glGetUniformLocation(ShaderProgram, ParamenterName);
+    return GLDispatch::getUniformLocation(ShaderProgram, ParamenterName);
 }
 
 void BaseShader::setParameter( GLint ID, float Param) const
 {
-    glUniform1f(ID, Param);
+    GLDispatch::uniform1f(ID, Param);
 }
 void BaseShader::setParameter( GLint ID, int Param) const
 {
-    glUniform1i(ID, Param);
+    GLDispatch::uniform1i(ID, Param);
 }
 void BaseShader::setParameter( GLint ID, const Vector& Param) const
 {
-    glUniform3f(ID, Param.X, Param.Y, Param.Z);
+    GLDispatch::uniform3f(ID, Param.X, Param.Y, Param.Z);
 }
 void BaseShader::setParameter( GLint ID, const Color& Param) const
 {
-    glUniform3f(ID, Param.R, Param.G, Param.B);
+    GLDispatch::uniform3f(ID, Param.R, Param.G, Param.B);
 }
 
 void BaseShader::setParameter( GLint ID, const Matrix& Param) const
 {
-    glUniformMatrix4fv(ID, 1, GL_FALSE, Param.m);
+    GLDispatch::uniformMatrix4fv(ID, 1, GL_FALSE, Param.m);
 }
 
 
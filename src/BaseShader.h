@@ -20,6 +20,8 @@
 #endif
 #include <iostream>
 #include <assert.h>
+#include <stdint.h>
+#include <string>
 #include "color.h"
 #include "vector.h"
 #include "matrix.h"
@@ -36,21 +38,44 @@ public:
     virtual void activate(const BaseCamera& Cam) const;
     virtual void deactivate() const;
     
-    bool load( const char* VertexShaderFile, const char* FragmentShaderFile );
+    // Defines: optionale Zeilen ("#define X 1\n..."), werden hinter #version eingefuegt
+    bool load( const char* VertexShaderFile, const char* FragmentShaderFile, const char* Defines=NULL );
+    // mit Tessellation-Stufen (TCS darf fehlen, dann gelten die Default-Tessellierungsstufen)
+    bool load( const char* VertexShaderFile, const char* TessControlShaderFile, const char* TessEvalShaderFile,
+               const char* FragmentShaderFile, const char* Defines=NULL );
     GLint getParameterID(const char* ParamenterName) const;
+    GLuint program() const { return ShaderProgram; }
     
     void setParameter( GLint ID, float Param) const;
     void setParameter( GLint ID, int Param) const;
     void setParameter( GLint ID, const Vector& Param) const;
     void setParameter( GLint ID, const Color& Param) const;
     void setParameter( GLint ID, const Matrix& Param) const;
+
+    // Programm-Binär-Cache (glGetProgramBinary), leerer Pfad = aus
+    struct CompileStats
+    {
+        unsigned int Compiled;
+        unsigned int FromCache;
+        unsigned int Rejected; // Binärdatei vorhanden, aber vom Treiber abgelehnt
+        double Seconds;        // Zeit in createShaderProgram (kompilieren oder laden)
+    };
+    static void programCacheDirectory(const char* Directory);
+    static const CompileStats& compileStats() { return Stats; }
+    static void printCompileStats();
 protected:
     char* loadFile( const char* File, unsigned int& Filesize );
-    GLuint createShaderProgram( const char* VScode, const char* FScode );
+    GLuint createShaderProgram( const char* VScode, const char* FScode, const char* TCScode=NULL, const char* TEScode=NULL );
+    static std::string injectDefines(const char* Code, const char* Defines);
+    static uint64_t programKey(const char* const* Sources, unsigned int Count);
+    static std::string programCacheFile(uint64_t Key);
+    static GLuint loadProgramBinary(uint64_t Key);
+    static void saveProgramBinary(GLuint Program, uint64_t Key);
     Matrix ModelTransform;
     GLuint ShaderProgram;
     
-    static const BaseShader* ShaderInPipe;
+    static std::string CacheDirectory;
+    static CompileStats Stats;
 };
 
 #endif /* BaseShader_hpp */
@@ -37,7 +37,7 @@ public:
     virtual void update() {}
     virtual const Matrix& getViewMatrix() const { return View; }
     virtual const Matrix& getProjectionMatrix() const { return Proj;  }
-    virtual Vector position() const { Matrix m = View; m.invert(); return m.translation(); }
+    virtual Vector position() const { Matrix m = View; m.invertAffine(); return m.translation(); }
     void setViewMatrix(const Matrix& m) { View = m;  }
     void setProjectionMatrix(const Matrix& m) { Proj = m; }
     virtual ~SimpleCamera() {};
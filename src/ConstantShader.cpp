@@ -7,14 +7,17 @@
 //
 
 #include "ConstantShader.h"
+#include "GLDispatch.h"
+#include "UniformBlocks.h"
 
 const char *CVertexShaderCode =
 "#version 400\n"
+UB_FRAME_BLOCK_GLSL
+UB_OBJECT_BLOCK_GLSL
 "in vec4 VertexPos;"
-"uniform mat4 ModelViewProjMat;"
 "void main()"
 "{"
-"    gl_Position = ModelViewProjMat * VertexPos;"
+"    gl_Position = ViewProjMat * (ModelMat * VertexPos);"
 "}";
 
 const char *CFragmentShaderCode =
@@ -30,21 +33,16 @@ ConstantShader::ConstantShader() : Col(1.0f,0.0f,0.0f)
 {
     ShaderProgram = createShaderProgram( CVertexShaderCode, CFragmentShaderCode );
     
-    ColorLoc = glGetUniformLocation(ShaderProgram, "Color");
+    ColorLoc = GLDispatch::getUniformLocation(ShaderProgram, "Color");
     assert(ColorLoc>=0);
-    ModelViewProjLoc  = glGetUniformLocation(ShaderProgram, "ModelViewProjMat");
-    assert(ModelViewProjLoc>=0);
     
 }
 void ConstantShader::activate(const BaseCamera& Cam) const
 {
     BaseShader::activate(Cam);
     
-    glUniform3f(ColorLoc, Col.R, Col.G, Col.B);
-    // always update matrices
-    Matrix ModelView = Cam.getViewMatrix() * ModelTransform;
-    Matrix ModelViewProj = Cam.getProjectionMatrix() * ModelView;
-    glUniformMatrix4fv(ModelViewProjLoc, 1, GL_FALSE, ModelViewProj.m);
+    GLDispatch::uniform3f(ColorLoc, Col.R, Col.G, Col.B);
+    UniformBlocks::object(ModelTransform);
 }
 void ConstantShader::color( const Color& c)
 {
@@ -38,7 +38,6 @@ private:
     Color Col;
     GLuint ShaderProgram;
     GLint ColorLoc;
-    GLint ModelViewProjLoc;
     
 };
 
@@ -0,0 +1,62 @@
+#include "DepthShader.h"
+#include "GLDispatch.h"
+#include "UniformBlocks.h"
+#include "GLState.h"
+
+static const char *DepthVertexShaderCode =
+"#version 400\n"
+"invariant gl_Position;\n"
+UB_FRAME_BLOCK_GLSL "\n"
+UB_OBJECT_BLOCK_GLSL "\n"
+"layout(location=0) in vec4 VertexPos;\n"
+"#if SCALING\n"
+"uniform vec3 Scaling;\n"
+"#endif\n"
+"void main()\n"
+"{\n"
+"#if SCALING\n"
+"    vec4 scaledVertexPos = vec4(VertexPos.xyz * Scaling.xyz,1);\n"
+"    vec4 WorldPos = ModelMat * scaledVertexPos;\n"
+"#else\n"
+"    mat4 M = ModelMat;\n"
+"    vec4 WorldPos = M * VertexPos;\n"
+"#endif\n"
+"    gl_Position = ViewProjMat * WorldPos;\n"
+"}\n";
+
+static const char *DepthFragmentShaderCode =
+"#version 400\n"
+"void main()\n"
+"{\n"
+"}\n";
+
+DepthShader::DepthShader() : Scaling(1, 1, 1), Scaled(false)
+{
+    ScaledProgram = createShaderProgram(injectDefines(DepthVertexShaderCode, "#define SCALING 1\n").c_str(),
+                                        DepthFragmentShaderCode);
+    ScalingLoc = GLDispatch::getUniformLocation(ScaledProgram, "Scaling");
+    PlainProgram = createShaderProgram(injectDefines(DepthVertexShaderCode, "#define SCALING 0\n").c_str(),
+                                       DepthFragmentShaderCode);
+    ShaderProgram = PlainProgram;
+}
+
+void DepthShader::scaling(const Vector& s)
+{
+    Scaling = s;
+    Scaled = true;
+    ShaderProgram = ScaledProgram;
+}
+
+void DepthShader::resetScaling()
+{
+    Scaled = false;
+    ShaderProgram = PlainProgram;
+}
+
+void DepthShader::activate(const BaseCamera& Cam) const
+{
+    BaseShader::activate(Cam);
+    if (Scaled)
+        GLDispatch::uniform3f(ScalingLoc, Scaling.X, Scaling.Y, Scaling.Z);
+    UniformBlocks::object(ModelTransform);
+}
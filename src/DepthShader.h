@@ -0,0 +1,37 @@
+#ifndef DepthShader_hpp
+#define DepthShader_hpp
+
+#include <stdio.h>
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include "vector.h"
+#include "camera.h"
+#include "baseshader.h"
+
+// Nur-Tiefe-Shader fuer den Depth-Pre-Pass. Die Positionsrechnung entspricht
+// Zeile fuer Zeile PhongShader bzw. vsterrain.glsl (mit Scaling), alle drei
+// deklarieren gl_Position als invariant -> der Shading-Pass trifft mit GL_EQUAL
+// exakt dieselben Tiefenwerte. Der Fragment-Shader ist leer.
+class DepthShader : public BaseShader
+{
+public:
+    DepthShader();
+    // Terrain skaliert die Vertices im Shader; ohne Aufruf wird unskaliert gerechnet
+    void scaling(const Vector& s);
+    void resetScaling();
+    virtual void activate(const BaseCamera& Cam) const;
+private:
+    GLuint PlainProgram;
+    GLuint ScaledProgram;
+    GLint ScalingLoc;
+    Vector Scaling;
+    bool Scaled;
+};
+
+#endif /* DepthShader_hpp */
@@ -2,6 +2,7 @@
 #include "phongshader.h"
 #include "texture.h"
 #include "Terrain.h"
+#include "Quaternion.h"
 
 
 template <typename T>
@@ -16,7 +17,7 @@ Drone::Drone(const std::string& assetDir)
     const float kModelScale = 0.01f;
     Matrix S; S.scale(kModelScale);
     this->transform(S * this->transform());
-    m_ScaleM = S;
+    m_Scale = kModelScale;
 
     // 2) AABB mitskalieren
     AABB aabb = this->BoundingBox;
@@ -56,16 +57,13 @@ static void dbg(const std::string& msg) {
 void Drone::setPosition(const Vector& worldPos)
 {
     const Vector centerNow = m_WorldAABB.getCenter();
-    const Vector delta     = worldPos - centerNow;
-    Matrix M; M.translation(delta);
-    m_WorldAABB.transform(M); // in-place
+    m_WorldAABB.translate(worldPos - centerNow);
     m_Dirty = true;
 }
 
 void Drone::applySeparation(const Vector& sep)
 {
-    Matrix M; M.translation(sep);
-    m_WorldAABB.transform(M); // in-place
+    m_WorldAABB.translate(sep);
     m_Dirty = true;
 }
 
@@ -88,8 +86,7 @@ void Drone::placeOnTerrain(Terrain* terrain, float x, float z)
         " dy=" + std::to_string(dy));
     
     // 4) vertikal verschieben
-    Matrix M; M.translation(Vector(0, dy, 0));
-    m_WorldAABB.transform(M);
+    m_WorldAABB.translate(Vector(0, dy, 0));
 
     // 5) sanftes Zeug resetten
     m_Yaw = 0.0f;
@@ -145,8 +142,7 @@ void Drone::handleInput(GLFWwindow* win, float dt)
         (right * (speed * strafe       * norm * dt));
 
     if (deltaPos.length() > 0.0f) {
-        Matrix M; M.translation(deltaPos);
-        m_WorldAABB.transform(M);
+        m_WorldAABB.translate(deltaPos);
     }
 
     // --- Boost ---
@@ -190,22 +186,19 @@ float Drone::desiredBottomYFromTerrain(const AABB& wbox, const Terrain* t) const
     return groundY + m_BaseHoverHeight + m_BoostOffset;
 }
 
-// rotiert XZ um yaw
-static inline Vector rotYaw(const Vector& v, float yaw) {
-    float c = cosf(yaw), s = sinf(yaw);
-    return { v.X * c + v.Z * s, v.Y, -v.X * s + v.Z * c };
-}
-
 // MAX( Terrainhöhe ) an 4 Ecken + Mitte (Fußabdruck)
 float Drone::maxGroundUnder(const AABB& wbox, const Terrain* t, float yaw) const {
     const Vector c = wbox.getCenter();
     const Vector sz = wbox.size();             // AABB im Welt­raum
     const float rx = 0.5f * sz.X, rz = 0.5f * sz.Z;
 
-    const Vector pts[5] = { {+rx,0,+rz},{-rx,0,+rz},{+rx,0,-rz},{-rx,0,-rz},{0,0,0} };
+    Vector pts[5] = { {+rx,0,+rz},{-rx,0,+rz},{+rx,0,-rz},{-rx,0,-rz},{0,0,0} };
+    Matrix T, R;
+    T.translation(c);
+    R.rotationY(yaw);
+    (T * R).transformPoints(pts, pts, 5);
     float hmax = -FLT_MAX;
-    for (auto& pLocal : pts) {
-        Vector p = c + rotYaw(pLocal, yaw);
+    for (auto& p : pts) {
         float h = sampleGroundAt(p.X, p.Z, t);
         if (h > hmax) hmax = h;
     }
@@ -240,8 +233,7 @@ void Drone::update(float dt, Terrain* terrain)
         }
 
         if (fabsf(dy) > 1e-5f) {
-            Matrix M; M.translation({ 0, dy, 0 });
-            m_WorldAABB.transform(M);
+            m_WorldAABB.translate(Vector(0, dy, 0));
             m_Dirty = true;
         }
     }
@@ -251,15 +243,16 @@ void Drone::update(float dt, Terrain* terrain)
 
 void Drone::rebuildTransform()
 {
-    const Vector center = m_WorldAABB.getCenter();
-
-    Matrix T, R, tiltX, tiltZ;
-    T.translation(center);
+    // T * R(yaw) * R(tiltX) * R(tiltZ) * S als TRS; Matrix erst fuer den Shader
+    Quaternion R, TiltX, TiltZ;
     R.rotationY(m_Yaw);
-    tiltX.rotationX(m_TiltX);
-    tiltZ.rotationZ(m_TiltZ);
+    TiltX.rotationX(m_TiltX);
+    TiltZ.rotationZ(m_TiltZ);
+    m_Pose = TRSTransform(m_WorldAABB.getCenter(), R * (TiltX * TiltZ), m_Scale);
 
-    this->transform(T * R * (tiltX * tiltZ) * m_ScaleM);
+    Matrix M;
+    m_Pose.toMatrix(M);
+    this->transform(M);
 
     m_Dirty = false;
 }
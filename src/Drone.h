@@ -1,6 +1,7 @@
 #pragma once
 #include "model.h"
 #include "Aabb.h"
+#include "TRSTransform.h"
 #ifdef WIN32
   #include <GL/glew.h>
   #include <glfw/glfw3.h>
@@ -33,6 +34,8 @@ public:
     Vector position() const    { return m_WorldAABB.getCenter(); }
     float  yaw() const         { return m_Yaw; }
     const AABB& worldAABB()const{ return m_WorldAABB; }
+    // Pose aus dem letzten rebuildTransform(), z.B. fuer TRSTransform::interpolate
+    const TRSTransform& pose() const { return m_Pose; }
     AABB  localAABB() const    { return m_LocalAABB; }
 
     // Hover-Höhe (Abstand Unterkante -> Terrain)
@@ -71,7 +74,8 @@ private:
     float  m_BoostDecaySpeed   = 3.0f;
     float  m_BoostOffset       = 0.0f;
     bool   m_BoostActive       = false;
-    Matrix m_ScaleM;
+    float  m_Scale = 1.0f;
+    TRSTransform m_Pose;
     // AABBs
     AABB   m_LocalAABB; // Modelspace
     AABB   m_WorldAABB; // Weltspace (wird bewegt)
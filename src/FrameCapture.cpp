@@ -0,0 +1,273 @@
+#include "FrameCapture.h"
+#include "rgbimage.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+FrameCapture::FrameCapture(unsigned int ringSize, unsigned int maxQueuedFrames)
+    : Head(0), Pending(0), ShotCounter(0), Recording(false), SeqStep(1), SeqFrame(0), SeqIndex(0),
+      Dropped(0), MaxQueued(maxQueuedFrames ? maxQueuedFrames : 1), Busy(0), Written(0), Quit(false)
+{
+    Ring.resize(ringSize < 2 ? 2 : ringSize);
+    Writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Quit = true;
+    }
+    Cond.notify_all();
+    Writer.join();
+
+    for (size_t i = 0; i < Queue.size(); ++i) delete Queue[i];
+    for (size_t i = 0; i < FreeJobs.size(); ++i) delete FreeJobs[i];
+    // GL-Objekte gibt finish() frei (Kontext ist im Destruktor evtl. schon weg)
+}
+
+void FrameCapture::screenshot(const std::string& filename)
+{
+    if (!filename.empty()) {
+        PendingShot = filename;
+        return;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "screenshot_%03u.bmp", ShotCounter++);
+    PendingShot = name;
+}
+
+void FrameCapture::startSequence(const std::string& prefix, unsigned int frameStep)
+{
+    SeqPrefix = prefix;
+    SeqStep = frameStep ? frameStep : 1;
+    SeqFrame = 0;
+    SeqIndex = 0;
+    Recording = true;
+    std::cout << "Capture: Aufnahme gestartet (" << prefix << "*.bmp)" << std::endl;
+}
+
+void FrameCapture::stopSequence()
+{
+    if (!Recording)
+        return;
+    Recording = false;
+    std::cout << "Capture: Aufnahme beendet, " << SeqIndex << " Frames ("
+              << Dropped << " verworfen)" << std::endl;
+}
+
+unsigned int FrameCapture::framesWritten() const
+{
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Written;
+}
+
+void FrameCapture::initBuffers()
+{
+    for (size_t i = 0; i < Ring.size(); ++i)
+        glGenBuffers(1, &Ring[i].Buffer);
+}
+
+void FrameCapture::releaseBuffers()
+{
+    for (size_t i = 0; i < Ring.size(); ++i) {
+        if (Ring[i].Fence) glDeleteSync(Ring[i].Fence);
+        if (Ring[i].Buffer) glDeleteBuffers(1, &Ring[i].Buffer);
+        Ring[i] = Slot();
+    }
+    Head = Pending = 0;
+}
+
+void FrameCapture::captureFrame(GLFWwindow* pWin)
+{
+    const unsigned int count = (unsigned int)Ring.size();
+
+    // 1. fertige Readbacks (aelteste zuerst) abholen, ohne zu blockieren
+    while (Pending > 0) {
+        Slot& s = Ring[(Head + count - Pending) % count];
+        if (!collect(s, false))
+            break;
+        --Pending;
+    }
+
+    // 2. neuen Readback fuer dieses Frame anstossen
+    if (!PendingShot.empty()) {
+        readback(pWin, PendingShot);
+        PendingShot.clear();
+    }
+    if (Recording && (SeqFrame++ % SeqStep) == 0)
+        readback(pWin, SeqPrefix, true);
+}
+
+void FrameCapture::readback(GLFWwindow* pWin, const std::string& filename, bool sequence)
+{
+    if (Ring[0].Buffer == 0)
+        initBuffers();
+
+    const unsigned int count = (unsigned int)Ring.size();
+    if (Pending == count) {
+        // Ring voll: aeltesten Slot erzwingen (passiert nur, wenn die GPU > ringSize Frames hinterherhaengt)
+        collect(Ring[(Head + count - Pending) % count], true);
+        --Pending;
+    }
+
+    int w = 0, h = 0;
+    glfwGetFramebufferSize(pWin, &w, &h);
+    if (w <= 0 || h <= 0)
+        return;
+
+    Slot& s = Ring[Head];
+    const unsigned int size = (unsigned int)w * (unsigned int)h * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.Buffer);
+    if (s.Size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        s.Size = size;
+    }
+    // BGRA entspricht der BMP-Bytereihenfolge, GL liefert wie BMP die unterste Zeile zuerst
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, w, h, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    s.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    s.Width = (unsigned int)w;
+    s.Height = (unsigned int)h;
+    s.Filename = filename;
+    s.Sequence = sequence;
+
+    Head = (Head + 1) % count;
+    ++Pending;
+}
+
+bool FrameCapture::collect(Slot& s, bool wait)
+{
+    if (s.Fence) {
+        GLenum r = glClientWaitSync(s.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                    wait ? 1000000000ull : 0);
+        if (r == GL_TIMEOUT_EXPIRED && !wait)
+            return false;
+        glDeleteSync(s.Fence);
+        s.Fence = 0;
+    }
+
+    Job* pJob = NULL;
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Queue.size() + Busy < MaxQueued) {
+            if (!FreeJobs.empty()) { pJob = FreeJobs.back(); FreeJobs.pop_back(); }
+            else pJob = new Job();
+        }
+    }
+    if (!pJob) {
+        // Writer kommt nicht hinterher: Frame verwerfen statt den Render-Thread zu bremsen
+        ++Dropped;
+        return true;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, s.Buffer);
+    const void* pData = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, s.Size, GL_MAP_READ_BIT);
+    if (pData) {
+        pJob->Pixels.resize(s.Size);
+        memcpy(&pJob->Pixels[0], pData, s.Size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!pData) {
+        std::cout << "Capture: glMapBufferRange fehlgeschlagen (" << s.Filename << ")" << std::endl;
+        std::lock_guard<std::mutex> lock(Mutex);
+        FreeJobs.push_back(pJob);
+        return true;
+    }
+
+    if (s.Sequence) {
+        // verworfene Frames bekommen keine Nummer, damit die Sequenz keine Luecken hat
+        char num[16];
+        snprintf(num, sizeof(num), "%05u", SeqIndex++);
+        pJob->Filename = s.Filename + num + ".bmp";
+    } else {
+        pJob->Filename = s.Filename;
+    }
+    pJob->Width = s.Width;
+    pJob->Height = s.Height;
+    enqueue(pJob);
+    return true;
+}
+
+void FrameCapture::enqueue(Job* pJob)
+{
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Queue.push_back(pJob);
+    }
+    Cond.notify_one();
+}
+
+void FrameCapture::finish()
+{
+    const unsigned int count = (unsigned int)Ring.size();
+    while (Pending > 0) {
+        collect(Ring[(Head + count - Pending) % count], true);
+        --Pending;
+    }
+    releaseBuffers();
+
+    std::unique_lock<std::mutex> lock(Mutex);
+    while (!Queue.empty() || Busy > 0)
+        Idle.wait(lock);
+}
+
+void FrameCapture::writerLoop()
+{
+    std::vector<unsigned char> row;
+    std::unique_lock<std::mutex> lock(Mutex);
+    for (;;) {
+        while (Queue.empty() && !Quit)
+            Cond.wait(lock);
+        if (Queue.empty())
+            break;
+
+        Job* pJob = Queue.front();
+        Queue.pop_front();
+        ++Busy;
+        lock.unlock();
+
+        bool ok = writeBMP(*pJob, row);
+        if (!ok)
+            std::cout << "Capture: " << pJob->Filename << " konnte nicht geschrieben werden" << std::endl;
+
+        lock.lock();
+        --Busy;
+        if (ok) ++Written;
+        FreeJobs.push_back(pJob);
+        if (Queue.empty() && Busy == 0)
+            Idle.notify_all();
+    }
+}
+
+bool FrameCapture::writeBMP(const Job& job, std::vector<unsigned char>& row)
+{
+    FILE* file = fopen(job.Filename.c_str(), "wb");
+    if (!file)
+        return false;
+
+    unsigned char header[54];
+    RGBImage::bmpHeader(header, job.Width, job.Height);
+    fwrite(header, 1, 54, file);
+
+    // BGRA -> BGR + Padding, eine komplette Zeile pro fwrite
+    const unsigned int stride = (3 * job.Width + 3) & ~3u;
+    row.assign(stride, 0);
+    for (unsigned int y = 0; y < job.Height; ++y) {
+        const unsigned char* src = &job.Pixels[(size_t)y * job.Width * 4];
+        unsigned char* dst = &row[0];
+        for (unsigned int x = 0; x < job.Width; ++x, src += 4, dst += 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+        fwrite(&row[0], 1, stride, file);
+    }
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef FrameCapture_hpp
+#define FrameCapture_hpp
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+
+// Asynchrone Bildschirmaufnahme (Screenshots und Bildsequenzen).
+// Der Framebuffer wird per glReadPixels in einen Ring aus Pixel-Buffer-Objects
+// gelesen (kehrt sofort zurueck) und erst einige Frames spaeter - wenn der Fence
+// signalisiert ist - gemappt. Kodieren und Schreiben der BMP-Dateien erledigt ein
+// Hintergrund-Thread zeilenweise, der Render-Thread wartet nie auf die Platte.
+class FrameCapture
+{
+public:
+    FrameCapture(unsigned int ringSize = 3, unsigned int maxQueuedFrames = 8);
+    ~FrameCapture();
+
+    // Einzelbild beim naechsten captureFrame(); ohne Namen: screenshot_NNN.bmp
+    void screenshot(const std::string& filename = std::string());
+    // Bildsequenz prefixNNNNN.bmp, jedes frameStep-te Frame (z.B. fuer Video-Export)
+    void startSequence(const std::string& prefix = "capture_", unsigned int frameStep = 1);
+    void stopSequence();
+    bool recording() const { return Recording; }
+
+    // Nach dem Zeichnen, vor glfwSwapBuffers aufrufen (braucht aktiven GL-Kontext)
+    void captureFrame(GLFWwindow* pWin);
+    // Ausstehende Readbacks abholen und warten, bis alle Dateien geschrieben sind
+    void finish();
+
+    unsigned int framesWritten() const;
+    unsigned int framesDropped() const { return Dropped; }
+
+protected:
+    struct Slot
+    {
+        GLuint Buffer;
+        GLsync Fence;
+        unsigned int Width, Height;
+        unsigned int Size;
+        std::string Filename;   // bei Sequenzen nur das Praefix
+        bool Sequence;          // Nummer erst vergeben, wenn der Writer das Frame annimmt
+        Slot() : Buffer(0), Fence(0), Width(0), Height(0), Size(0), Sequence(false) {}
+    };
+    struct Job
+    {
+        std::string Filename;
+        unsigned int Width, Height;
+        std::vector<unsigned char> Pixels; // BGRA, Zeilen von unten nach oben (wie GL/BMP)
+    };
+
+    void initBuffers();
+    void releaseBuffers();
+    void readback(GLFWwindow* pWin, const std::string& filename, bool sequence = false);
+    bool collect(Slot& s, bool wait);
+    void enqueue(Job* pJob);
+    void writerLoop();
+    static bool writeBMP(const Job& job, std::vector<unsigned char>& row);
+
+    std::vector<Slot> Ring;
+    unsigned int Head;      // naechster freier Slot
+    unsigned int Pending;   // belegte Slots (aelteste bei Head - Pending)
+
+    std::string PendingShot;
+    unsigned int ShotCounter;
+    bool Recording;
+    std::string SeqPrefix;
+    unsigned int SeqStep;
+    unsigned int SeqFrame;
+    unsigned int SeqIndex;  // naechste Nummer, zaehlt nur angenommene Frames (lueckenlos)
+    unsigned int Dropped;
+
+    // Writer-Thread
+    std::thread Writer;
+    mutable std::mutex Mutex;
+    std::condition_variable Cond;
+    std::condition_variable Idle;
+    std::deque<Job*> Queue;
+    std::vector<Job*> FreeJobs;
+    unsigned int MaxQueued;
+    unsigned int Busy;
+    unsigned int Written;
+    bool Quit;
+};
+
+#endif /* FrameCapture_hpp */
@@ -0,0 +1,118 @@
+#include "Frustum.h"
+#include "camera.h"
+#include <math.h>
+
+Frustum::Frustum()
+{
+    // alles sichtbar, bis extract() aufgerufen wird
+    for(unsigned int i=0; i<PLANE_COUNT; ++i)
+    {
+        Planes[i][0] = Planes[i][1] = Planes[i][2] = 0.0f;
+        Planes[i][3] = 1.0f;
+    }
+}
+
+Frustum::Frustum(const Matrix& ViewProj)
+{
+    extract(ViewProj);
+}
+
+void Frustum::extract(const Matrix& M)
+{
+    // Zeilen von M (spaltenweise gespeichert): Zeile r = (m[r], m[4+r], m[8+r], m[12+r])
+    for(unsigned int i=0; i<PLANE_COUNT; ++i)
+    {
+        const unsigned int Row = i / 2;          // x, y, z
+        const float Sign = (i & 1) ? -1.0f : 1.0f; // links/unten/nah = w + Zeile, sonst w - Zeile
+        float* P = Planes[i];
+        for(unsigned int c=0; c<4; ++c)
+            P[c] = M.m[c*4 + 3] + Sign * M.m[c*4 + Row];
+
+        const float Len = sqrtf(P[0]*P[0] + P[1]*P[1] + P[2]*P[2]);
+        if(Len > 0.0f)
+        {
+            const float Inv = 1.0f / Len;
+            P[0] *= Inv; P[1] *= Inv; P[2] *= Inv; P[3] *= Inv;
+        }
+    }
+}
+
+void Frustum::extract(const BaseCamera& Cam)
+{
+    extract(Cam.getProjectionMatrix() * Cam.getViewMatrix());
+}
+
+Frustum::RESULT Frustum::sphere(const Vector& C, float Radius, unsigned int& Mask, unsigned int& LastPlane) const
+{
+    const unsigned int In = Mask;
+    Mask = 0;
+    for(unsigned int k=0; k<PLANE_COUNT; ++k)
+    {
+        // zuerst die Ebene, die beim letzten Mal verworfen hat
+        const unsigned int i = (k == 0) ? LastPlane : (k == LastPlane ? 0 : k);
+        if(!(In & (1u << i)))
+            continue;
+        const float* P = Planes[i];
+        const float d = P[0]*C.X + P[1]*C.Y + P[2]*C.Z + P[3];
+        if(d < -Radius)
+        {
+            LastPlane = i;
+            return OUTSIDE;
+        }
+        if(d < Radius)
+            Mask |= 1u << i;
+    }
+    return Mask ? INTERSECT : INSIDE;
+}
+
+Frustum::RESULT Frustum::aabb(const AABB& Box, unsigned int& Mask, unsigned int& LastPlane) const
+{
+    // Zentrum/halbe Ausdehnung: Abstand des Zentrums gegen die Projektion der Box auf n
+    const float cx = (Box.Min.X + Box.Max.X) * 0.5f, ex = (Box.Max.X - Box.Min.X) * 0.5f;
+    const float cy = (Box.Min.Y + Box.Max.Y) * 0.5f, ey = (Box.Max.Y - Box.Min.Y) * 0.5f;
+    const float cz = (Box.Min.Z + Box.Max.Z) * 0.5f, ez = (Box.Max.Z - Box.Min.Z) * 0.5f;
+
+    const unsigned int In = Mask;
+    Mask = 0;
+    for(unsigned int k=0; k<PLANE_COUNT; ++k)
+    {
+        const unsigned int i = (k == 0) ? LastPlane : (k == LastPlane ? 0 : k);
+        if(!(In & (1u << i)))
+            continue;
+        const float* P = Planes[i];
+        const float d = P[0]*cx + P[1]*cy + P[2]*cz + P[3];
+        const float r = fabsf(P[0])*ex + fabsf(P[1])*ey + fabsf(P[2])*ez;
+        if(d < -r)
+        {
+            LastPlane = i;
+            return OUTSIDE;
+        }
+        if(d < r)
+            Mask |= 1u << i;
+    }
+    return Mask ? INTERSECT : INSIDE;
+}
+
+bool Frustum::isVisible(const Vector& Center, float Radius) const
+{
+    unsigned int Mask = ALL_PLANES, Last = 0;
+    return sphere(Center, Radius, Mask, Last) != OUTSIDE;
+}
+
+bool Frustum::isVisible(const AABB& Box) const
+{
+    unsigned int Mask = ALL_PLANES, Last = 0;
+    return aabb(Box, Mask, Last) != OUTSIDE;
+}
+
+unsigned int Frustum::visible(const AABB8& Boxes) const
+{
+    unsigned int Culled = 0;
+    for(unsigned int i=0; i<PLANE_COUNT; ++i)
+    {
+        unsigned int Outside, Inside;
+        Boxes.classify(Planes[i], Outside, Inside);
+        Culled |= Outside;
+    }
+    return ~Culled & ((1u << Boxes.count()) - 1u);
+}
@@ -0,0 +1,63 @@
+#ifndef Frustum_hpp
+#define Frustum_hpp
+
+#include "vector.h"
+#include "Matrix.h"
+#include "Aabb.h"
+
+class BaseCamera;
+
+// Sichtvolumen als sechs normierte Ebenen (nx, ny, nz, d), innen: n*p + d >= 0, nach
+// Gribb/Hartmann aus Projektion * View gewonnen. Die Tests kennen zwei Abkuerzungen fuer
+// Hierarchien und aufeinanderfolgende Frames:
+// - Maske: Bit i gesetzt = Ebene i noch pruefen. Liegt ein Elternknoten ganz innerhalb
+//   einer Ebene, wird ihr Bit geloescht und die Kinder ueberspringen sie.
+// - Kohaerenz: die Ebene, an der ein Objekt zuletzt gescheitert ist, wird zuerst geprueft;
+//   ein Objekt ausserhalb des Bildes scheitert meist wieder an derselben.
+class Frustum
+{
+public:
+    enum PLANE
+    {
+        PLANE_LEFT = 0,
+        PLANE_RIGHT,
+        PLANE_BOTTOM,
+        PLANE_TOP,
+        PLANE_NEAR,
+        PLANE_FAR,
+        PLANE_COUNT
+    };
+    enum { ALL_PLANES = (1 << PLANE_COUNT) - 1 };
+    enum RESULT
+    {
+        OUTSIDE = 0,
+        INTERSECT,
+        INSIDE
+    };
+
+    Frustum();
+    explicit Frustum(const Matrix& ViewProj);
+
+    // ViewProj = Projektion * View (Welt -> Clip), OpenGL-Clipraum (-w..w)
+    void extract(const Matrix& ViewProj);
+    void extract(const BaseCamera& Cam);
+
+    const float* plane(unsigned int i) const { return Planes[i]; }
+
+    // Mask: ein = zu pruefende Ebenen, aus = Ebenen, die das Objekt schneidet.
+    // LastPlane: ein = zuerst zu pruefende Ebene, aus = verwerfende Ebene (nur bei OUTSIDE).
+    RESULT sphere(const Vector& Center, float Radius, unsigned int& Mask, unsigned int& LastPlane) const;
+    RESULT aabb(const AABB& Box, unsigned int& Mask, unsigned int& LastPlane) const;
+
+    // ohne Maske/Kohaerenz
+    bool isVisible(const Vector& Center, float Radius) const;
+    bool isVisible(const AABB& Box) const;
+
+    // 8 Boxen auf einmal (SIMD); Bit i in Visible: Box i schneidet oder liegt innen
+    unsigned int visible(const AABB8& Boxes) const;
+
+protected:
+    float Planes[PLANE_COUNT][4];
+};
+
+#endif /* Frustum_hpp */
@@ -0,0 +1,425 @@
+#include "GLDispatch.h"
+#include "GLState.h"
+#include <string.h>
+
+// ---------------------------------------------------------------------------------------
+// REAL: eigene Funktionen statt &glXxx, da GLEW die Einsprungpunkte als Makros auf
+// Zeiger definiert und unter Win32 eine andere Aufrufkonvention gilt
+
+static void realGenBuffers(GLsizei n, GLuint* b) { glGenBuffers(n, b); }
+static void realDeleteBuffers(GLsizei n, const GLuint* b) { glDeleteBuffers(n, b); }
+static void realBindBuffer(GLenum t, GLuint b) { glBindBuffer(t, b); }
+static void realBindBufferBase(GLenum t, GLuint i, GLuint b) { glBindBufferBase(t, i, b); }
+static void realBindBufferRange(GLenum t, GLuint i, GLuint b, GLintptr o, GLsizeiptr s) { glBindBufferRange(t, i, b, o, s); }
+static void realBufferData(GLenum t, GLsizeiptr s, const void* d, GLenum u) { glBufferData(t, s, d, u); }
+static void realBufferSubData(GLenum t, GLintptr o, GLsizeiptr s, const void* d) { glBufferSubData(t, o, s, d); }
+static void realGenVertexArrays(GLsizei n, GLuint* a) { glGenVertexArrays(n, a); }
+static void realDeleteVertexArrays(GLsizei n, const GLuint* a) { glDeleteVertexArrays(n, a); }
+static void realBindVertexArray(GLuint a) { glBindVertexArray(a); }
+static void realEnableVertexAttribArray(GLuint i) { glEnableVertexAttribArray(i); }
+static void realVertexAttribPointer(GLuint i, GLint s, GLenum t, GLboolean n, GLsizei st, const void* p) { glVertexAttribPointer(i, s, t, n, st, p); }
+
+static void realGenTextures(GLsizei n, GLuint* t) { glGenTextures(n, t); }
+static void realDeleteTextures(GLsizei n, const GLuint* t) { glDeleteTextures(n, t); }
+static void realActiveTexture(GLenum u) { glActiveTexture(u); }
+static void realBindTexture(GLenum t, GLuint x) { glBindTexture(t, x); }
+static void realTexImage2D(GLenum t, GLint l, GLint i, GLsizei w, GLsizei h, GLint b, GLenum f, GLenum ty, const void* p)
+{
+    glTexImage2D(t, l, i, w, h, b, f, ty, p);
+}
+static void realTexSubImage2D(GLenum t, GLint l, GLint x, GLint y, GLsizei w, GLsizei h, GLenum f, GLenum ty, const void* p)
+{
+    glTexSubImage2D(t, l, x, y, w, h, f, ty, p);
+}
+static void realTexParameteri(GLenum t, GLenum n, GLint p) { glTexParameteri(t, n, p); }
+static void realGenerateMipmap(GLenum t) { glGenerateMipmap(t); }
+static void realPixelStorei(GLenum n, GLint p) { glPixelStorei(n, p); }
+
+static GLuint realCreateShader(GLenum t) { return glCreateShader(t); }
+static void realShaderSource(GLuint s, GLsizei c, const GLchar* const* code, const GLint* l) { glShaderSource(s, c, code, l); }
+static void realCompileShader(GLuint s) { glCompileShader(s); }
+static void realGetShaderiv(GLuint s, GLenum n, GLint* p) { glGetShaderiv(s, n, p); }
+static void realGetShaderInfoLog(GLuint s, GLsizei b, GLsizei* l, GLchar* log) { glGetShaderInfoLog(s, b, l, log); }
+static void realDeleteShader(GLuint s) { glDeleteShader(s); }
+static GLuint realCreateProgram() { return glCreateProgram(); }
+static void realAttachShader(GLuint p, GLuint s) { glAttachShader(p, s); }
+static void realProgramParameteri(GLuint p, GLenum n, GLint v) { glProgramParameteri(p, n, v); }
+static void realLinkProgram(GLuint p) { glLinkProgram(p); }
+static void realGetProgramiv(GLuint p, GLenum n, GLint* v) { glGetProgramiv(p, n, v); }
+static void realProgramBinary(GLuint p, GLenum f, const void* b, GLsizei l) { glProgramBinary(p, f, b, l); }
+static void realGetProgramBinary(GLuint p, GLsizei s, GLsizei* l, GLenum* f, void* b) { glGetProgramBinary(p, s, l, f, b); }
+static void realDeleteProgram(GLuint p) { glDeleteProgram(p); }
+static void realUseProgram(GLuint p) { glUseProgram(p); }
+
+static GLint realGetUniformLocation(GLuint p, const GLchar* n) { return glGetUniformLocation(p, n); }
+static GLuint realGetUniformBlockIndex(GLuint p, const GLchar* n) { return glGetUniformBlockIndex(p, n); }
+static void realUniformBlockBinding(GLuint p, GLuint i, GLuint b) { glUniformBlockBinding(p, i, b); }
+static void realUniform1i(GLint l, GLint v) { glUniform1i(l, v); }
+static void realUniform1f(GLint l, GLfloat v) { glUniform1f(l, v); }
+static void realUniform3f(GLint l, GLfloat x, GLfloat y, GLfloat z) { glUniform3f(l, x, y, z); }
+static void realUniformMatrix4fv(GLint l, GLsizei c, GLboolean t, const GLfloat* v) { glUniformMatrix4fv(l, c, t, v); }
+
+static void realEnable(GLenum c) { glEnable(c); }
+static void realDisable(GLenum c) { glDisable(c); }
+static void realDepthFunc(GLenum f) { glDepthFunc(f); }
+static void realDepthMask(GLboolean f) { glDepthMask(f); }
+static void realBlendFunc(GLenum s, GLenum d) { glBlendFunc(s, d); }
+static void realCullFace(GLenum f) { glCullFace(f); }
+static void realColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) { glColorMask(r, g, b, a); }
+static void realPatchParameteri(GLenum n, GLint v) { glPatchParameteri(n, v); }
+
+static void realDrawElements(GLenum m, GLsizei c, GLenum t, const void* i) { glDrawElements(m, c, t, i); }
+static void realDrawArrays(GLenum m, GLint f, GLsizei c) { glDrawArrays(m, f, c); }
+
+static void realGetIntegerv(GLenum n, GLint* d) { glGetIntegerv(n, d); }
+static const GLubyte* realGetString(GLenum n) { return glGetString(n); }
+static GLenum realGetError() { return glGetError(); }
+
+static const GLDispatch::Table RealTable = {
+    realGenBuffers, realDeleteBuffers, realBindBuffer, realBindBufferBase, realBindBufferRange,
+    realBufferData, realBufferSubData, realGenVertexArrays, realDeleteVertexArrays, realBindVertexArray,
+    realEnableVertexAttribArray, realVertexAttribPointer,
+    realGenTextures, realDeleteTextures, realActiveTexture, realBindTexture, realTexImage2D,
+    realTexSubImage2D, realTexParameteri, realGenerateMipmap, realPixelStorei,
+    realCreateShader, realShaderSource, realCompileShader, realGetShaderiv, realGetShaderInfoLog,
+    realDeleteShader, realCreateProgram, realAttachShader, realProgramParameteri, realLinkProgram,
+    realGetProgramiv, realProgramBinary, realGetProgramBinary, realDeleteProgram, realUseProgram,
+    realGetUniformLocation, realGetUniformBlockIndex, realUniformBlockBinding, realUniform1i,
+    realUniform1f, realUniform3f, realUniformMatrix4fv,
+    realEnable, realDisable, realDepthFunc, realDepthMask, realBlendFunc, realCullFace, realColorMask,
+    realPatchParameteri,
+    realDrawElements, realDrawArrays,
+    realGetIntegerv, realGetString, realGetError
+};
+
+// ---------------------------------------------------------------------------------------
+// NOOP: keine GL-Arbeit. Namen zaehlen hoch (0 bleibt "kein Objekt"), Abfragen liefern
+// Werte, mit denen BaseShader, UniformBlocks und Co. den Normalfall nehmen.
+
+static GLuint NoopNames = 0;
+
+static void noopGen(GLsizei n, GLuint* Names) { for (GLsizei i = 0; i < n; ++i) Names[i] = ++NoopNames; }
+static void noopDelete(GLsizei, const GLuint*) {}
+static void noopEnum(GLenum) {}
+static void noopUInt(GLuint) {}
+static void noopEnumUInt(GLenum, GLuint) {}
+static void noopBindBufferBase(GLenum, GLuint, GLuint) {}
+static void noopBindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) {}
+static void noopBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+static void noopBufferSubData(GLenum, GLintptr, GLsizeiptr, const void*) {}
+static void noopVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+static void noopTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+static void noopTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) {}
+static void noopTexParameteri(GLenum, GLenum, GLint) {}
+static void noopEnumInt(GLenum, GLint) {}
+
+static GLuint noopCreateShader(GLenum) { return ++NoopNames; }
+static void noopShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+static void noopGetShaderiv(GLuint, GLenum Name, GLint* Param) { *Param = (Name == GL_COMPILE_STATUS) ? GL_TRUE : 0; }
+static void noopGetInfoLog(GLuint, GLsizei BufSize, GLsizei* Length, GLchar* Log)
+{
+    if (Length) *Length = 0;
+    if (Log && BufSize > 0) Log[0] = 0;
+}
+static GLuint noopCreateProgram() { return ++NoopNames; }
+static void noopAttachShader(GLuint, GLuint) {}
+static void noopProgramParameteri(GLuint, GLenum, GLint) {}
+static void noopGetProgramiv(GLuint, GLenum Name, GLint* Param) { *Param = (Name == GL_LINK_STATUS) ? GL_TRUE : 0; }
+static void noopProgramBinary(GLuint, GLenum, const void*, GLsizei) {}
+static void noopGetProgramBinary(GLuint, GLsizei, GLsizei* Length, GLenum*, void*) { if (Length) *Length = 0; }
+
+static GLint noopGetUniformLocation(GLuint, const GLchar*) { return 0; }
+static GLuint noopGetUniformBlockIndex(GLuint, const GLchar*) { return 0; }
+static void noopUniformBlockBinding(GLuint, GLuint, GLuint) {}
+static void noopUniform1i(GLint, GLint) {}
+static void noopUniform1f(GLint, GLfloat) {}
+static void noopUniform3f(GLint, GLfloat, GLfloat, GLfloat) {}
+static void noopUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+
+static void noopDepthMask(GLboolean) {}
+static void noopBlendFunc(GLenum, GLenum) {}
+static void noopColorMask(GLboolean, GLboolean, GLboolean, GLboolean) {}
+static void noopDrawElements(GLenum, GLsizei, GLenum, const void*) {}
+static void noopDrawArrays(GLenum, GLint, GLsizei) {}
+
+static void noopGetIntegerv(GLenum Name, GLint* Data)
+{
+    // 0 Binaerformate: BaseShader laesst den Programm-Cache aus
+    *Data = (Name == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT) ? 256 : 0;
+}
+static const GLubyte* noopGetString(GLenum) { return (const GLubyte*)"GLDispatch NOOP"; }
+static GLenum noopGetError() { return GL_NO_ERROR; }
+
+static const GLDispatch::Table NoopTable = {
+    noopGen, noopDelete, noopEnumUInt, noopBindBufferBase, noopBindBufferRange,
+    noopBufferData, noopBufferSubData, noopGen, noopDelete, noopUInt,
+    noopUInt, noopVertexAttribPointer,
+    noopGen, noopDelete, noopEnum, noopEnumUInt, noopTexImage2D,
+    noopTexSubImage2D, noopTexParameteri, noopEnum, noopEnumInt,
+    noopCreateShader, noopShaderSource, noopUInt, noopGetShaderiv, noopGetInfoLog,
+    noopUInt, noopCreateProgram, noopAttachShader, noopProgramParameteri, noopUInt,
+    noopGetProgramiv, noopProgramBinary, noopGetProgramBinary, noopUInt, noopUInt,
+    noopGetUniformLocation, noopGetUniformBlockIndex, noopUniformBlockBinding, noopUniform1i,
+    noopUniform1f, noopUniform3f, noopUniformMatrix4fv,
+    noopEnum, noopEnum, noopEnum, noopDepthMask, noopBlendFunc, noopEnum, noopColorMask,
+    noopEnumInt,
+    noopDrawElements, noopDrawArrays,
+    noopGetIntegerv, noopGetString, noopGetError
+};
+
+// ---------------------------------------------------------------------------------------
+// RECORD: zaehlen, dann an Forward (REAL oder NOOP)
+
+// Bytes eines Texturbilds ohne Zeilen-Alignment; unbekannte Formate zaehlen 4 Byte/Texel
+static unsigned long long texelBytes(GLsizei Width, GLsizei Height, GLenum Format, GLenum Type)
+{
+    unsigned int Components = 4;
+    switch (Format) {
+    case GL_RED: case GL_DEPTH_COMPONENT: Components = 1; break;
+    case GL_RG: Components = 2; break;
+    case GL_RGB: case GL_BGR: Components = 3; break;
+    default: break;
+    }
+    unsigned int Size = 1;
+    switch (Type) {
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: Size = 2; break;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: Size = 4; break;
+    default: break;
+    }
+    return (unsigned long long)Width * Height * Components * Size;
+}
+
+struct GLRecord
+{
+    static GLDispatch::Stats& frame() { return GLDispatch::Frame; }
+    static const GLDispatch::Table& next() { return *GLDispatch::Forward; }
+    static void call() { GLDispatch::Frame.Calls++; }
+    static void state() { GLDispatch::Frame.Calls++; GLDispatch::Frame.StateChanges++; }
+    static void uniform(unsigned int Bytes)
+    {
+        GLDispatch::Frame.Calls++;
+        GLDispatch::Frame.UniformWrites++;
+        GLDispatch::Frame.UniformBytes += Bytes;
+    }
+    static void draw(GLsizei Count)
+    {
+        GLDispatch::Frame.Calls++;
+        GLDispatch::Frame.DrawCalls++;
+        GLDispatch::Frame.Elements += Count;
+    }
+
+    static void genBuffers(GLsizei n, GLuint* b) { call(); next().GenBuffers(n, b); }
+    static void deleteBuffers(GLsizei n, const GLuint* b) { call(); next().DeleteBuffers(n, b); }
+    static void bindBuffer(GLenum t, GLuint b) { state(); next().BindBuffer(t, b); }
+    static void bindBufferBase(GLenum t, GLuint i, GLuint b) { state(); next().BindBufferBase(t, i, b); }
+    static void bindBufferRange(GLenum t, GLuint i, GLuint b, GLintptr o, GLsizeiptr s) { state(); next().BindBufferRange(t, i, b, o, s); }
+    static void bufferData(GLenum t, GLsizeiptr s, const void* d, GLenum u)
+    {
+        call();
+        // ohne Daten nur Speicher anlegen bzw. verwaisen lassen, nichts hochgeladen
+        if (d) { frame().BufferUploads++; frame().BufferBytes += s; }
+        next().BufferData(t, s, d, u);
+    }
+    static void bufferSubData(GLenum t, GLintptr o, GLsizeiptr s, const void* d)
+    {
+        call();
+        frame().BufferUploads++;
+        frame().BufferBytes += s;
+        next().BufferSubData(t, o, s, d);
+    }
+    static void genVertexArrays(GLsizei n, GLuint* a) { call(); next().GenVertexArrays(n, a); }
+    static void deleteVertexArrays(GLsizei n, const GLuint* a) { call(); next().DeleteVertexArrays(n, a); }
+    static void bindVertexArray(GLuint a) { state(); next().BindVertexArray(a); }
+    static void enableVertexAttribArray(GLuint i) { call(); next().EnableVertexAttribArray(i); }
+    static void vertexAttribPointer(GLuint i, GLint s, GLenum t, GLboolean n, GLsizei st, const void* p)
+    {
+        call();
+        next().VertexAttribPointer(i, s, t, n, st, p);
+    }
+
+    static void genTextures(GLsizei n, GLuint* t) { call(); next().GenTextures(n, t); }
+    static void deleteTextures(GLsizei n, const GLuint* t) { call(); next().DeleteTextures(n, t); }
+    static void activeTexture(GLenum u) { state(); next().ActiveTexture(u); }
+    static void bindTexture(GLenum t, GLuint x) { state(); next().BindTexture(t, x); }
+    static void texImage2D(GLenum t, GLint l, GLint i, GLsizei w, GLsizei h, GLint b, GLenum f, GLenum ty, const void* p)
+    {
+        call();
+        if (p) { frame().TextureUploads++; frame().TextureBytes += texelBytes(w, h, f, ty); }
+        next().TexImage2D(t, l, i, w, h, b, f, ty, p);
+    }
+    static void texSubImage2D(GLenum t, GLint l, GLint x, GLint y, GLsizei w, GLsizei h, GLenum f, GLenum ty, const void* p)
+    {
+        call();
+        frame().TextureUploads++;
+        frame().TextureBytes += texelBytes(w, h, f, ty);
+        next().TexSubImage2D(t, l, x, y, w, h, f, ty, p);
+    }
+    static void texParameteri(GLenum t, GLenum n, GLint p) { call(); next().TexParameteri(t, n, p); }
+    static void generateMipmap(GLenum t) { call(); next().GenerateMipmap(t); }
+    static void pixelStorei(GLenum n, GLint p) { call(); next().PixelStorei(n, p); }
+
+    static GLuint createShader(GLenum t) { call(); return next().CreateShader(t); }
+    static void shaderSource(GLuint s, GLsizei c, const GLchar* const* code, const GLint* l) { call(); next().ShaderSource(s, c, code, l); }
+    static void compileShader(GLuint s) { call(); next().CompileShader(s); }
+    static void getShaderiv(GLuint s, GLenum n, GLint* p) { call(); next().GetShaderiv(s, n, p); }
+    static void getShaderInfoLog(GLuint s, GLsizei b, GLsizei* l, GLchar* log) { call(); next().GetShaderInfoLog(s, b, l, log); }
+    static void deleteShader(GLuint s) { call(); next().DeleteShader(s); }
+    static GLuint createProgram() { call(); return next().CreateProgram(); }
+    static void attachShader(GLuint p, GLuint s) { call(); next().AttachShader(p, s); }
+    static void programParameteri(GLuint p, GLenum n, GLint v) { call(); next().ProgramParameteri(p, n, v); }
+    static void linkProgram(GLuint p) { call(); next().LinkProgram(p); }
+    static void getProgramiv(GLuint p, GLenum n, GLint* v) { call(); next().GetProgramiv(p, n, v); }
+    static void programBinary(GLuint p, GLenum f, const void* b, GLsizei l) { call(); next().ProgramBinary(p, f, b, l); }
+    static void getProgramBinary(GLuint p, GLsizei s, GLsizei* l, GLenum* f, void* b) { call(); next().GetProgramBinary(p, s, l, f, b); }
+    static void deleteProgram(GLuint p) { call(); next().DeleteProgram(p); }
+    static void useProgram(GLuint p) { state(); next().UseProgram(p); }
+
+    static GLint getUniformLocation(GLuint p, const GLchar* n) { call(); return next().GetUniformLocation(p, n); }
+    static GLuint getUniformBlockIndex(GLuint p, const GLchar* n) { call(); return next().GetUniformBlockIndex(p, n); }
+    static void uniformBlockBinding(GLuint p, GLuint i, GLuint b) { call(); next().UniformBlockBinding(p, i, b); }
+    static void uniform1i(GLint l, GLint v) { uniform(sizeof(GLint)); next().Uniform1i(l, v); }
+    static void uniform1f(GLint l, GLfloat v) { uniform(sizeof(GLfloat)); next().Uniform1f(l, v); }
+    static void uniform3f(GLint l, GLfloat x, GLfloat y, GLfloat z) { uniform(3 * sizeof(GLfloat)); next().Uniform3f(l, x, y, z); }
+    static void uniformMatrix4fv(GLint l, GLsizei c, GLboolean t, const GLfloat* v)
+    {
+        uniform(c * 16 * sizeof(GLfloat));
+        next().UniformMatrix4fv(l, c, t, v);
+    }
+
+    static void enable(GLenum c) { state(); next().Enable(c); }
+    static void disable(GLenum c) { state(); next().Disable(c); }
+    static void depthFunc(GLenum f) { state(); next().DepthFunc(f); }
+    static void depthMask(GLboolean f) { state(); next().DepthMask(f); }
+    static void blendFunc(GLenum s, GLenum d) { state(); next().BlendFunc(s, d); }
+    static void cullFace(GLenum f) { state(); next().CullFace(f); }
+    static void colorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) { state(); next().ColorMask(r, g, b, a); }
+    static void patchParameteri(GLenum n, GLint v) { state(); next().PatchParameteri(n, v); }
+
+    static void drawElements(GLenum m, GLsizei c, GLenum t, const void* i) { draw(c); next().DrawElements(m, c, t, i); }
+    static void drawArrays(GLenum m, GLint f, GLsizei c) { draw(c); next().DrawArrays(m, f, c); }
+
+    static void getIntegerv(GLenum n, GLint* d) { call(); next().GetIntegerv(n, d); }
+    static const GLubyte* getString(GLenum n) { call(); return next().GetString(n); }
+    static GLenum getError() { call(); return next().GetError(); }
+};
+
+static const GLDispatch::Table RecordTable = {
+    GLRecord::genBuffers, GLRecord::deleteBuffers, GLRecord::bindBuffer, GLRecord::bindBufferBase, GLRecord::bindBufferRange,
+    GLRecord::bufferData, GLRecord::bufferSubData, GLRecord::genVertexArrays, GLRecord::deleteVertexArrays, GLRecord::bindVertexArray,
+    GLRecord::enableVertexAttribArray, GLRecord::vertexAttribPointer,
+    GLRecord::genTextures, GLRecord::deleteTextures, GLRecord::activeTexture, GLRecord::bindTexture, GLRecord::texImage2D,
+    GLRecord::texSubImage2D, GLRecord::texParameteri, GLRecord::generateMipmap, GLRecord::pixelStorei,
+    GLRecord::createShader, GLRecord::shaderSource, GLRecord::compileShader, GLRecord::getShaderiv, GLRecord::getShaderInfoLog,
+    GLRecord::deleteShader, GLRecord::createProgram, GLRecord::attachShader, GLRecord::programParameteri, GLRecord::linkProgram,
+    GLRecord::getProgramiv, GLRecord::programBinary, GLRecord::getProgramBinary, GLRecord::deleteProgram, GLRecord::useProgram,
+    GLRecord::getUniformLocation, GLRecord::getUniformBlockIndex, GLRecord::uniformBlockBinding, GLRecord::uniform1i,
+    GLRecord::uniform1f, GLRecord::uniform3f, GLRecord::uniformMatrix4fv,
+    GLRecord::enable, GLRecord::disable, GLRecord::depthFunc, GLRecord::depthMask, GLRecord::blendFunc, GLRecord::cullFace,
+    GLRecord::colorMask, GLRecord::patchParameteri,
+    GLRecord::drawElements, GLRecord::drawArrays,
+    GLRecord::getIntegerv, GLRecord::getString, GLRecord::getError
+};
+
+// ---------------------------------------------------------------------------------------
+
+const GLDispatch::Table* GLDispatch::Active = &RealTable;
+const GLDispatch::Table* GLDispatch::Forward = &RealTable;
+GLDispatch::BACKEND GLDispatch::Backend = GLDispatch::REAL;
+GLDispatch::BACKEND GLDispatch::Target = GLDispatch::REAL;
+GLDispatch::Stats GLDispatch::Frame = {};
+GLDispatch::Stats GLDispatch::LastFrame = {};
+GLDispatch::Stats GLDispatch::Total = {};
+unsigned int GLDispatch::Frames = 0;
+FILE* GLDispatch::pLog = NULL;
+std::string GLDispatch::LogName;
+
+void GLDispatch::select(BACKEND NewBackend, BACKEND NewTarget)
+{
+    Backend = NewBackend;
+    // ohne RECORD ist das Ziel das Backend selbst
+    if (Backend == RECORD)
+        Target = (NewTarget == NOOP) ? NOOP : REAL;
+    else
+        Target = (Backend == NOOP) ? NOOP : REAL;
+    Forward = (Target == NOOP) ? &NoopTable : &RealTable;
+    Active = (Backend == RECORD) ? &RecordTable : Forward;
+    // der Cache kennt den Zustand des neuen Backends nicht
+    GLState::invalidate();
+}
+
+const char* GLDispatch::name(BACKEND Backend)
+{
+    switch (Backend) {
+    case NOOP: return "noop";
+    case RECORD: return "record";
+    default: return "real";
+    }
+}
+
+void GLDispatch::beginFrame()
+{
+    if (Backend != RECORD)
+        return;
+    LastFrame = Frame;
+    Total.Calls += Frame.Calls;
+    Total.DrawCalls += Frame.DrawCalls;
+    Total.Elements += Frame.Elements;
+    Total.StateChanges += Frame.StateChanges;
+    Total.BufferUploads += Frame.BufferUploads;
+    Total.BufferBytes += Frame.BufferBytes;
+    Total.TextureUploads += Frame.TextureUploads;
+    Total.TextureBytes += Frame.TextureBytes;
+    Total.UniformWrites += Frame.UniformWrites;
+    Total.UniformBytes += Frame.UniformBytes;
+    if (pLog)
+        writeLog();
+    Frames++;
+    memset(&Frame, 0, sizeof(Frame));
+}
+
+void GLDispatch::print()
+{
+    if (Backend != RECORD) {
+        printf("GLDispatch: %s\n", name(Backend));
+        return;
+    }
+    // Frame 0 enthaelt das Laden (Puffer, Texturen, Shader)
+    const Stats& s = LastFrame;
+    printf("GLDispatch: record -> %s, %u Frames, %u Aufrufe gesamt, %.1f MB Puffer, %.1f MB Texturen\n",
+           name(Target), Frames, Total.Calls, Total.BufferBytes / 1.0e6, Total.TextureBytes / 1.0e6);
+    printf("GLDispatch: letztes Frame %u Aufrufe, %u Draws (%llu Elemente), %u Zustandswechsel, "
+           "%u Uploads (%llu B Puffer, %llu B Texturen), %u Uniforms (%u B)\n",
+           s.Calls, s.DrawCalls, s.Elements, s.StateChanges, s.BufferUploads + s.TextureUploads,
+           s.BufferBytes, s.TextureBytes, s.UniformWrites, s.UniformBytes);
+}
+
+bool GLDispatch::openLog(const char* Filename)
+{
+    closeLog();
+    pLog = fopen(Filename, "w");
+    if (!pLog) {
+        printf("GLDispatch: kann %s nicht anlegen\n", Filename);
+        return false;
+    }
+    LogName = Filename;
+    fprintf(pLog, "frame,calls,draws,elements,state,buffer_uploads,buffer_bytes,"
+                  "texture_uploads,texture_bytes,uniforms,uniform_bytes\n");
+    return true;
+}
+
+void GLDispatch::closeLog()
+{
+    if (!pLog)
+        return;
+    fclose(pLog);
+    pLog = NULL;
+    printf("GLDispatch: Log %s geschrieben\n", LogName.c_str());
+}
+
+void GLDispatch::writeLog()
+{
+    const Stats& s = Frame;
+    fprintf(pLog, "%u,%u,%u,%llu,%u,%u,%llu,%u,%llu,%u,%u\n", Frames, s.Calls, s.DrawCalls, s.Elements,
+            s.StateChanges, s.BufferUploads, s.BufferBytes, s.TextureUploads, s.TextureBytes,
+            s.UniformWrites, s.UniformBytes);
+}
@@ -0,0 +1,259 @@
+#ifndef GLDispatch_hpp
+#define GLDispatch_hpp
+
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include <stdio.h>
+#include <string>
+
+// Duenne Schicht vor den GL-Aufrufen von VertexBuffer, IndexBuffer, Texture, BaseShader,
+// UniformBlocks, GLState und den Draw-Calls. Jede Funktion geht ueber eine Tabelle von
+// Funktionszeigern an das gewaehlte Backend (Aufbau wie MatrixSIMD):
+// - REAL:   direkt an GL
+// - NOOP:   tut nichts; liefert neue Namen, erfolgreiche Compile/Link-Status und
+//           Uniform-Location 0, damit der Renderer ohne GPU-Arbeit durchlaeuft
+// - RECORD: zaehlt pro Frame Draw-Calls, Zustandswechsel, hochgeladene Bytes und
+//           Uniform-Schreibzugriffe und reicht dann an REAL oder NOOP weiter
+// Alles andere (Framebuffer, Queries, Syncs, Readback) ruft GL weiterhin direkt auf,
+// ein GL-Kontext wird also auch mit NOOP gebraucht. Das Backend vor dem Anlegen der
+// ersten GL-Objekte waehlen: Namen aus NOOP sind in GL nicht gueltig. Module, die eigene
+// GL-Objekte anlegen (Schatten, virtuelle Textur, Aufnahme, Profiler), laesst die
+// Application deshalb bei target() == NOOP weg.
+class GLDispatch
+{
+public:
+    enum BACKEND
+    {
+        REAL = 0,
+        NOOP = 1,
+        RECORD = 2
+    };
+
+    // zaehlt nur mit RECORD
+    struct Stats
+    {
+        unsigned int Calls;          // alle Aufrufe ueber GLDispatch
+        unsigned int DrawCalls;
+        unsigned long long Elements; // Indizes bzw. Vertices der Draw-Calls
+        unsigned int StateChanges;   // Binds, Enables, Programme, Depth/Blend/Cull/Mask, Patch-Groesse
+        unsigned int BufferUploads;
+        unsigned long long BufferBytes;
+        unsigned int TextureUploads;
+        unsigned long long TextureBytes;
+        unsigned int UniformWrites;
+        unsigned int UniformBytes;
+    };
+
+    // Target: wohin RECORD weiterreicht (REAL oder NOOP)
+    static void select(BACKEND Backend, BACKEND Target = REAL);
+    static BACKEND backend() { return Backend; }
+    static BACKEND target() { return Target; }
+    static const char* name(BACKEND Backend);
+
+    // Zaehler des abgelaufenen Frames sichern, ggf. als Zeile ins Log, zuruecksetzen
+    static void beginFrame();
+    static const Stats& lastFrame() { return LastFrame; }
+    static const Stats& total() { return Total; }
+    static unsigned int frames() { return Frames; }
+    static void print();
+
+    // CSV, eine Zeile pro Frame (Spalten wie Stats). Nur mit RECORD sinnvoll.
+    static bool openLog(const char* Filename);
+    static void closeLog();
+    static bool logging() { return pLog != NULL; }
+
+    // Puffer und Vertex-Arrays
+    static void genBuffers(GLsizei n, GLuint* Buffers) { Active->GenBuffers(n, Buffers); }
+    static void deleteBuffers(GLsizei n, const GLuint* Buffers) { Active->DeleteBuffers(n, Buffers); }
+    static void bindBuffer(GLenum Target, GLuint Buffer) { Active->BindBuffer(Target, Buffer); }
+    static void bindBufferBase(GLenum Target, GLuint Index, GLuint Buffer) { Active->BindBufferBase(Target, Index, Buffer); }
+    static void bindBufferRange(GLenum Target, GLuint Index, GLuint Buffer, GLintptr Offset, GLsizeiptr Size)
+    {
+        Active->BindBufferRange(Target, Index, Buffer, Offset, Size);
+    }
+    static void bufferData(GLenum Target, GLsizeiptr Size, const void* Data, GLenum Usage) { Active->BufferData(Target, Size, Data, Usage); }
+    static void bufferSubData(GLenum Target, GLintptr Offset, GLsizeiptr Size, const void* Data)
+    {
+        Active->BufferSubData(Target, Offset, Size, Data);
+    }
+    static void genVertexArrays(GLsizei n, GLuint* Arrays) { Active->GenVertexArrays(n, Arrays); }
+    static void deleteVertexArrays(GLsizei n, const GLuint* Arrays) { Active->DeleteVertexArrays(n, Arrays); }
+    static void bindVertexArray(GLuint Array) { Active->BindVertexArray(Array); }
+    static void enableVertexAttribArray(GLuint Index) { Active->EnableVertexAttribArray(Index); }
+    static void vertexAttribPointer(GLuint Index, GLint Size, GLenum Type, GLboolean Normalized, GLsizei Stride, const void* Pointer)
+    {
+        Active->VertexAttribPointer(Index, Size, Type, Normalized, Stride, Pointer);
+    }
+
+    // Texturen
+    static void genTextures(GLsizei n, GLuint* Textures) { Active->GenTextures(n, Textures); }
+    static void deleteTextures(GLsizei n, const GLuint* Textures) { Active->DeleteTextures(n, Textures); }
+    static void activeTexture(GLenum Unit) { Active->ActiveTexture(Unit); }
+    static void bindTexture(GLenum Target, GLuint Texture) { Active->BindTexture(Target, Texture); }
+    static void texImage2D(GLenum Target, GLint Level, GLint InternalFormat, GLsizei Width, GLsizei Height,
+                           GLint Border, GLenum Format, GLenum Type, const void* Pixels)
+    {
+        Active->TexImage2D(Target, Level, InternalFormat, Width, Height, Border, Format, Type, Pixels);
+    }
+    static void texSubImage2D(GLenum Target, GLint Level, GLint X, GLint Y, GLsizei Width, GLsizei Height,
+                              GLenum Format, GLenum Type, const void* Pixels)
+    {
+        Active->TexSubImage2D(Target, Level, X, Y, Width, Height, Format, Type, Pixels);
+    }
+    static void texParameteri(GLenum Target, GLenum Name, GLint Param) { Active->TexParameteri(Target, Name, Param); }
+    static void generateMipmap(GLenum Target) { Active->GenerateMipmap(Target); }
+    static void pixelStorei(GLenum Name, GLint Param) { Active->PixelStorei(Name, Param); }
+
+    // Shader und Programme
+    static GLuint createShader(GLenum Type) { return Active->CreateShader(Type); }
+    static void shaderSource(GLuint Shader, GLsizei Count, const GLchar* const* Code, const GLint* Length)
+    {
+        Active->ShaderSource(Shader, Count, Code, Length);
+    }
+    static void compileShader(GLuint Shader) { Active->CompileShader(Shader); }
+    static void getShaderiv(GLuint Shader, GLenum Name, GLint* Param) { Active->GetShaderiv(Shader, Name, Param); }
+    static void getShaderInfoLog(GLuint Shader, GLsizei BufSize, GLsizei* Length, GLchar* Log)
+    {
+        Active->GetShaderInfoLog(Shader, BufSize, Length, Log);
+    }
+    static void deleteShader(GLuint Shader) { Active->DeleteShader(Shader); }
+    static GLuint createProgram() { return Active->CreateProgram(); }
+    static void attachShader(GLuint Program, GLuint Shader) { Active->AttachShader(Program, Shader); }
+    static void programParameteri(GLuint Program, GLenum Name, GLint Value) { Active->ProgramParameteri(Program, Name, Value); }
+    static void linkProgram(GLuint Program) { Active->LinkProgram(Program); }
+    static void getProgramiv(GLuint Program, GLenum Name, GLint* Param) { Active->GetProgramiv(Program, Name, Param); }
+    static void programBinary(GLuint Program, GLenum Format, const void* Binary, GLsizei Length)
+    {
+        Active->ProgramBinary(Program, Format, Binary, Length);
+    }
+    static void getProgramBinary(GLuint Program, GLsizei BufSize, GLsizei* Length, GLenum* Format, void* Binary)
+    {
+        Active->GetProgramBinary(Program, BufSize, Length, Format, Binary);
+    }
+    static void deleteProgram(GLuint Program) { Active->DeleteProgram(Program); }
+    static void useProgram(GLuint Program) { Active->UseProgram(Program); }
+
+    // Uniforms
+    static GLint getUniformLocation(GLuint Program, const GLchar* Name) { return Active->GetUniformLocation(Program, Name); }
+    static GLuint getUniformBlockIndex(GLuint Program, const GLchar* Name) { return Active->GetUniformBlockIndex(Program, Name); }
+    static void uniformBlockBinding(GLuint Program, GLuint Index, GLuint Binding) { Active->UniformBlockBinding(Program, Index, Binding); }
+    static void uniform1i(GLint Location, GLint v) { Active->Uniform1i(Location, v); }
+    static void uniform1f(GLint Location, GLfloat v) { Active->Uniform1f(Location, v); }
+    static void uniform3f(GLint Location, GLfloat x, GLfloat y, GLfloat z) { Active->Uniform3f(Location, x, y, z); }
+    static void uniformMatrix4fv(GLint Location, GLsizei Count, GLboolean Transpose, const GLfloat* Value)
+    {
+        Active->UniformMatrix4fv(Location, Count, Transpose, Value);
+    }
+
+    // feste Funktionen
+    static void enable(GLenum Cap) { Active->Enable(Cap); }
+    static void disable(GLenum Cap) { Active->Disable(Cap); }
+    static void depthFunc(GLenum Func) { Active->DepthFunc(Func); }
+    static void depthMask(GLboolean Flag) { Active->DepthMask(Flag); }
+    static void blendFunc(GLenum Src, GLenum Dst) { Active->BlendFunc(Src, Dst); }
+    static void cullFace(GLenum Face) { Active->CullFace(Face); }
+    static void colorMask(GLboolean R, GLboolean G, GLboolean B, GLboolean A) { Active->ColorMask(R, G, B, A); }
+    static void patchParameteri(GLenum Name, GLint Value) { Active->PatchParameteri(Name, Value); }
+
+    // Zeichnen
+    static void drawElements(GLenum Mode, GLsizei Count, GLenum Type, const void* Indices) { Active->DrawElements(Mode, Count, Type, Indices); }
+    static void drawArrays(GLenum Mode, GLint First, GLsizei Count) { Active->DrawArrays(Mode, First, Count); }
+
+    // Abfragen
+    static void getIntegerv(GLenum Name, GLint* Data) { Active->GetIntegerv(Name, Data); }
+    static const GLubyte* getString(GLenum Name) { return Active->GetString(Name); }
+    static GLenum getError() { return Active->GetError(); }
+
+    // Reihenfolge = Reihenfolge der Initialisierung in GLDispatch.cpp
+    struct Table
+    {
+        void (*GenBuffers)(GLsizei, GLuint*);
+        void (*DeleteBuffers)(GLsizei, const GLuint*);
+        void (*BindBuffer)(GLenum, GLuint);
+        void (*BindBufferBase)(GLenum, GLuint, GLuint);
+        void (*BindBufferRange)(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr);
+        void (*BufferData)(GLenum, GLsizeiptr, const void*, GLenum);
+        void (*BufferSubData)(GLenum, GLintptr, GLsizeiptr, const void*);
+        void (*GenVertexArrays)(GLsizei, GLuint*);
+        void (*DeleteVertexArrays)(GLsizei, const GLuint*);
+        void (*BindVertexArray)(GLuint);
+        void (*EnableVertexAttribArray)(GLuint);
+        void (*VertexAttribPointer)(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*);
+
+        void (*GenTextures)(GLsizei, GLuint*);
+        void (*DeleteTextures)(GLsizei, const GLuint*);
+        void (*ActiveTexture)(GLenum);
+        void (*BindTexture)(GLenum, GLuint);
+        void (*TexImage2D)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*);
+        void (*TexSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*);
+        void (*TexParameteri)(GLenum, GLenum, GLint);
+        void (*GenerateMipmap)(GLenum);
+        void (*PixelStorei)(GLenum, GLint);
+
+        GLuint (*CreateShader)(GLenum);
+        void (*ShaderSource)(GLuint, GLsizei, const GLchar* const*, const GLint*);
+        void (*CompileShader)(GLuint);
+        void (*GetShaderiv)(GLuint, GLenum, GLint*);
+        void (*GetShaderInfoLog)(GLuint, GLsizei, GLsizei*, GLchar*);
+        void (*DeleteShader)(GLuint);
+        GLuint (*CreateProgram)();
+        void (*AttachShader)(GLuint, GLuint);
+        void (*ProgramParameteri)(GLuint, GLenum, GLint);
+        void (*LinkProgram)(GLuint);
+        void (*GetProgramiv)(GLuint, GLenum, GLint*);
+        void (*ProgramBinary)(GLuint, GLenum, const void*, GLsizei);
+        void (*GetProgramBinary)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+        void (*DeleteProgram)(GLuint);
+        void (*UseProgram)(GLuint);
+
+        GLint (*GetUniformLocation)(GLuint, const GLchar*);
+        GLuint (*GetUniformBlockIndex)(GLuint, const GLchar*);
+        void (*UniformBlockBinding)(GLuint, GLuint, GLuint);
+        void (*Uniform1i)(GLint, GLint);
+        void (*Uniform1f)(GLint, GLfloat);
+        void (*Uniform3f)(GLint, GLfloat, GLfloat, GLfloat);
+        void (*UniformMatrix4fv)(GLint, GLsizei, GLboolean, const GLfloat*);
+
+        void (*Enable)(GLenum);
+        void (*Disable)(GLenum);
+        void (*DepthFunc)(GLenum);
+        void (*DepthMask)(GLboolean);
+        void (*BlendFunc)(GLenum, GLenum);
+        void (*CullFace)(GLenum);
+        void (*ColorMask)(GLboolean, GLboolean, GLboolean, GLboolean);
+        void (*PatchParameteri)(GLenum, GLint);
+
+        void (*DrawElements)(GLenum, GLsizei, GLenum, const void*);
+        void (*DrawArrays)(GLenum, GLint, GLsizei);
+
+        void (*GetIntegerv)(GLenum, GLint*);
+        const GLubyte* (*GetString)(GLenum);
+        GLenum (*GetError)();
+    };
+
+protected:
+    static void writeLog();
+
+    static const Table* Active;
+    static const Table* Forward; // Ziel von RECORD
+    static BACKEND Backend;
+    static BACKEND Target;
+
+    static Stats Frame;
+    static Stats LastFrame;
+    static Stats Total;
+    static unsigned int Frames;
+
+    static FILE* pLog;
+    static std::string LogName;
+
+    friend struct GLRecord;
+};
+
+#endif /* GLDispatch_hpp */
@@ -0,0 +1,211 @@
+#include "GLState.h"
+#include "GLDispatch.h"
+
+GLuint GLState::Program = GLState::UNKNOWN;
+GLuint GLState::VertexArray = GLState::UNKNOWN;
+std::vector<GLuint> GLState::ElementBuffers;
+GLuint GLState::ActiveUnit = GLState::UNKNOWN;
+GLuint GLState::Textures[GLState::MAX_TEXTURE_UNITS][2];
+GLuint GLState::Caps[GLState::CAP_COUNT];
+GLuint GLState::DepthFunc = GLState::UNKNOWN;
+GLuint GLState::DepthMask = GLState::UNKNOWN;
+GLuint GLState::BlendSrc = GLState::UNKNOWN;
+GLuint GLState::BlendDst = GLState::UNKNOWN;
+GLuint GLState::CullFace = GLState::UNKNOWN;
+GLuint GLState::ColorMask = GLState::UNKNOWN;
+GLState::Stats GLState::Frame = { 0, 0 };
+GLState::Stats GLState::LastFrame = { 0, 0 };
+GLState::Stats GLState::Total = { 0, 0 };
+
+// Texturtabelle/Caps sind Arrays -> einmal beim Programmstart als unbekannt markieren
+static struct GLStateInit { GLStateInit() { GLState::invalidate(); } } StateInit;
+
+bool GLState::changed(GLuint& cached, GLuint value)
+{
+    Frame.Calls++;
+    Total.Calls++;
+    if (cached == value) {
+        Frame.Skipped++;
+        Total.Skipped++;
+        return false;
+    }
+    cached = value;
+    return true;
+}
+
+int GLState::capIndex(GLenum cap)
+{
+    switch (cap) {
+    case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+    case GL_BLEND:      return CAP_BLEND;
+    case GL_CULL_FACE:  return CAP_CULL_FACE;
+    default:            return -1;
+    }
+}
+
+int GLState::targetIndex(GLenum target)
+{
+    switch (target) {
+    case GL_TEXTURE_2D:       return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    default:                  return -1;
+    }
+}
+
+void GLState::useProgram(GLuint program)
+{
+    if (changed(Program, program))
+        GLDispatch::useProgram(program);
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+    if (changed(VertexArray, vao))
+        GLDispatch::bindVertexArray(vao);
+}
+
+void GLState::bindElementBuffer(GLuint ibo)
+{
+    if (VertexArray == UNKNOWN) {
+        // unbekanntes VAO: binden, aber nichts merken
+        Frame.Calls++;
+        Total.Calls++;
+        GLDispatch::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        return;
+    }
+    if (VertexArray >= ElementBuffers.size())
+        ElementBuffers.resize(VertexArray + 1, UNKNOWN);
+    if (changed(ElementBuffers[VertexArray], ibo))
+        GLDispatch::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+}
+
+void GLState::activeTexture(unsigned int unit)
+{
+    if (changed(ActiveUnit, unit))
+        GLDispatch::activeTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::bindTexture(unsigned int unit, GLuint tex, GLenum target)
+{
+    const int t = targetIndex(target);
+    if (unit >= MAX_TEXTURE_UNITS || t < 0) {
+        activeTexture(unit);
+        Frame.Calls++;
+        Total.Calls++;
+        GLDispatch::bindTexture(target, tex);
+        return;
+    }
+    // Unit nur wechseln, wenn wirklich gebunden werden muss
+    Frame.Calls++;
+    Total.Calls++;
+    if (Textures[unit][t] == tex) {
+        Frame.Skipped++;
+        Total.Skipped++;
+        return;
+    }
+    Textures[unit][t] = tex;
+    activeTexture(unit);
+    GLDispatch::bindTexture(target, tex);
+}
+
+void GLState::bindForUpload(GLuint tex, GLenum target)
+{
+    if (ActiveUnit == UNKNOWN)
+        activeTexture(0);
+    bindTexture(ActiveUnit, tex, target);
+}
+
+void GLState::enable(GLenum cap, bool on)
+{
+    const int i = capIndex(cap);
+    if (i >= 0 && !changed(Caps[i], on ? 1u : 0u))
+        return;
+    if (on) GLDispatch::enable(cap);
+    else GLDispatch::disable(cap);
+}
+
+void GLState::depthFunc(GLenum func)
+{
+    if (changed(DepthFunc, func))
+        GLDispatch::depthFunc(func);
+}
+
+void GLState::depthMask(bool write)
+{
+    if (changed(DepthMask, write ? 1u : 0u))
+        GLDispatch::depthMask(write ? GL_TRUE : GL_FALSE);
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst)
+{
+    Frame.Calls++;
+    Total.Calls++;
+    if (BlendSrc == src && BlendDst == dst) {
+        Frame.Skipped++;
+        Total.Skipped++;
+        return;
+    }
+    BlendSrc = src;
+    BlendDst = dst;
+    GLDispatch::blendFunc(src, dst);
+}
+
+void GLState::cullFace(GLenum face)
+{
+    if (changed(CullFace, face))
+        GLDispatch::cullFace(face);
+}
+
+void GLState::colorMask(bool write)
+{
+    if (changed(ColorMask, write ? 1u : 0u)) {
+        const GLboolean w = write ? GL_TRUE : GL_FALSE;
+        GLDispatch::colorMask(w, w, w, w);
+    }
+}
+
+void GLState::programDeleted(GLuint program)
+{
+    if (Program == program)
+        Program = UNKNOWN;
+}
+
+void GLState::vertexArrayDeleted(GLuint vao)
+{
+    if (VertexArray == vao)
+        VertexArray = UNKNOWN;
+    if (vao < ElementBuffers.size())
+        ElementBuffers[vao] = UNKNOWN;
+}
+
+void GLState::bufferDeleted(GLuint buffer)
+{
+    for (size_t i = 0; i < ElementBuffers.size(); ++i)
+        if (ElementBuffers[i] == buffer)
+            ElementBuffers[i] = UNKNOWN;
+}
+
+void GLState::textureDeleted(GLuint tex)
+{
+    for (unsigned int u = 0; u < MAX_TEXTURE_UNITS; ++u)
+        for (unsigned int t = 0; t < 2; ++t)
+            if (Textures[u][t] == tex)
+                Textures[u][t] = UNKNOWN;
+}
+
+void GLState::invalidate()
+{
+    Program = VertexArray = ActiveUnit = UNKNOWN;
+    ElementBuffers.clear();
+    for (unsigned int u = 0; u < MAX_TEXTURE_UNITS; ++u)
+        Textures[u][0] = Textures[u][1] = UNKNOWN;
+    for (unsigned int i = 0; i < CAP_COUNT; ++i)
+        Caps[i] = UNKNOWN;
+    DepthFunc = DepthMask = BlendSrc = BlendDst = CullFace = ColorMask = UNKNOWN;
+}
+
+void GLState::beginFrame()
+{
+    LastFrame = Frame;
+    Frame.Calls = Frame.Skipped = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef GLState_hpp
+#define GLState_hpp
+
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include <vector>
+
+// Zentraler Schatten des GL-Zustands. Alle Binds/Enables im Renderer laufen hier
+// durch; ist der gewuenschte Zustand bereits gesetzt, entfaellt der GL-Aufruf.
+// - Programm, VAO, Element-Buffer (gehoert zum VAO und wird pro VAO gemerkt),
+//   Textur-Units (2D und 2D-Array), Depth/Blend/Cull-Zustand
+// - wer GL-Objekte loescht, meldet das ueber ...Deleted(), da GL die Bindung
+//   dabei implizit aufhebt und der Name wiederverwendet werden kann
+// - Code, der am Cache vorbei bindet, ruft danach invalidate()
+// - was durchkommt, geht ueber GLDispatch (Backend real/noop/record)
+class GLState
+{
+public:
+    enum { MAX_TEXTURE_UNITS = 16 };
+
+    struct Stats
+    {
+        unsigned int Calls;   // angefragte Zustandsaenderungen
+        unsigned int Skipped; // davon redundant (kein GL-Aufruf)
+    };
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vao);
+    // bindet in das aktuell gebundene VAO (Element-Buffer ist VAO-Zustand)
+    static void bindElementBuffer(GLuint ibo);
+
+    static void activeTexture(unsigned int unit);
+    static void bindTexture(unsigned int unit, GLuint tex, GLenum target = GL_TEXTURE_2D);
+    // auf der aktiven Unit binden, um die Textur zu befuellen
+    static void bindForUpload(GLuint tex, GLenum target = GL_TEXTURE_2D);
+
+    static void enable(GLenum cap, bool on = true);
+    static void disable(GLenum cap) { enable(cap, false); }
+    static void depthFunc(GLenum func);
+    static void depthMask(bool write);
+    static void blendFunc(GLenum src, GLenum dst);
+    static void cullFace(GLenum face);
+    static void colorMask(bool write);
+    // zuletzt gesetzter Wert (GL-Wert unbekannt nach invalidate())
+    static GLenum depthFunc() { return DepthFunc; }
+    static bool depthMask() { return DepthMask == 1u; }
+
+    static void programDeleted(GLuint program);
+    static void vertexArrayDeleted(GLuint vao);
+    static void bufferDeleted(GLuint buffer);
+    static void textureDeleted(GLuint tex);
+
+    // Zustand unbekannt: der naechste Aufruf geht in jedem Fall an GL
+    static void invalidate();
+
+    // Zaehler des abgelaufenen Frames sichern und zuruecksetzen
+    static void beginFrame();
+    static const Stats& lastFrame() { return LastFrame; }
+    static const Stats& total() { return Total; }
+
+protected:
+    enum { UNKNOWN = 0xFFFFFFFFu };
+    enum CAPS { CAP_DEPTH_TEST, CAP_BLEND, CAP_CULL_FACE, CAP_COUNT };
+
+    static bool changed(GLuint& cached, GLuint value);
+    static int capIndex(GLenum cap);
+    static int targetIndex(GLenum target);
+
+    static GLuint Program;
+    static GLuint VertexArray;
+    static std::vector<GLuint> ElementBuffers; // pro VAO-Name
+    static GLuint ActiveUnit;
+    static GLuint Textures[MAX_TEXTURE_UNITS][2];
+    static GLuint Caps[CAP_COUNT];
+    static GLuint DepthFunc;
+    static GLuint DepthMask;
+    static GLuint BlendSrc, BlendDst;
+    static GLuint CullFace;
+    static GLuint ColorMask;
+
+    static Stats Frame;
+    static Stats LastFrame;
+    static Stats Total;
+};
+
+#endif /* GLState_hpp */
@@ -0,0 +1,232 @@
+#include "GPUProfiler.h"
+#include <iostream>
+#include <cstring>
+
+static const unsigned int NO_RECORD = 0xFFFFFFFFu;
+
+GPUProfiler::GPUProfiler() : FrameMs(0), ResultFrame(0), Frame(0), Dropped(0), Valid(false), InFrame(false),
+    pLog(NULL), LogColumns(0), LogLines(0), LogMaxLines(0)
+{
+    for (unsigned int i = 0; i < FRAMES; ++i) {
+        memset(Slots[i].Queries, 0, sizeof(Slots[i].Queries));
+        Slots[i].Used = 0;
+        Slots[i].Frame = 0;
+        Slots[i].Pending = false;
+    }
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    closeLog();
+    // GL-Objekte gibt release() frei, solange der Kontext noch existiert
+}
+
+bool GPUProfiler::init()
+{
+    if (Valid)
+        return true;
+    GLint Bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &Bits);
+    if (Bits == 0) {
+        std::cout << "GPUProfiler::init(): WARNING GL_TIMESTAMP queries not supported, profiling disabled." << std::endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < FRAMES; ++i) {
+        glGenQueries(2 * MAX_SCOPES + 2, Slots[i].Queries);
+        Slots[i].Records.reserve(MAX_SCOPES);
+        Slots[i].Pending = false;
+    }
+    Stack.reserve(MAX_SCOPES);
+    Valid = true;
+    return true;
+}
+
+void GPUProfiler::release()
+{
+    if (!Valid)
+        return;
+    for (unsigned int i = 0; i < FRAMES; ++i) {
+        glDeleteQueries(2 * MAX_SCOPES + 2, Slots[i].Queries);
+        Slots[i].Pending = false;
+    }
+    Valid = InFrame = false;
+}
+
+unsigned int GPUProfiler::nameIndex(const char* Name)
+{
+    for (unsigned int i = 0; i < Names.size(); ++i)
+        if (Names[i] == Name)
+            return i;
+    Names.push_back(Name);
+    return (unsigned int)Names.size() - 1;
+}
+
+void GPUProfiler::beginFrame()
+{
+    if (!Valid)
+        return;
+    if (InFrame)
+        endFrame();
+
+    // Ring-Platz wird wiederverwendet -> vorher dessen Ergebnis abholen (falls schon da)
+    Slot& s = Slots[Frame % FRAMES];
+    if (s.Pending)
+        collect(s);
+
+    s.Used = 2;
+    s.Frame = Frame;
+    s.Records.clear();
+    Stack.clear();
+    glQueryCounter(s.Queries[0], GL_TIMESTAMP);
+    InFrame = true;
+}
+
+void GPUProfiler::endFrame()
+{
+    if (!InFrame)
+        return;
+    while (!Stack.empty())
+        end();
+    Slot& s = Slots[Frame % FRAMES];
+    glQueryCounter(s.Queries[1], GL_TIMESTAMP);
+    s.Pending = true;
+    InFrame = false;
+    Frame++;
+}
+
+void GPUProfiler::begin(const char* Name)
+{
+    if (!InFrame)
+        return;
+    Slot& s = Slots[Frame % FRAMES];
+    if (s.Used + 2 > 2 * MAX_SCOPES + 2) {
+        // Ring-Platz voll: Bereich nur fuer das passende end() merken
+        Stack.push_back(NO_RECORD);
+        return;
+    }
+    Record r;
+    r.Name = nameIndex(Name);
+    r.Depth = (unsigned int)Stack.size();
+    r.Begin = s.Used++;
+    r.End = 0;
+    glQueryCounter(s.Queries[r.Begin], GL_TIMESTAMP);
+    Stack.push_back((unsigned int)s.Records.size());
+    s.Records.push_back(r);
+}
+
+void GPUProfiler::end()
+{
+    if (!InFrame || Stack.empty())
+        return;
+    const unsigned int i = Stack.back();
+    Stack.pop_back();
+    if (i == NO_RECORD)
+        return;
+    Slot& s = Slots[Frame % FRAMES];
+    Record& r = s.Records[i];
+    r.End = s.Used++;
+    glQueryCounter(s.Queries[r.End], GL_TIMESTAMP);
+}
+
+void GPUProfiler::collect(Slot& s)
+{
+    s.Pending = false;
+    // Zeitstempel werden in Reihenfolge fertig: liegt der letzte vor, liegen alle vor
+    GLuint Available = 0;
+    glGetQueryObjectuiv(s.Queries[1], GL_QUERY_RESULT_AVAILABLE, &Available);
+    if (!Available) {
+        Dropped++;
+        return;
+    }
+
+    GLuint64 Stamps[2 * MAX_SCOPES + 2];
+    for (unsigned int i = 0; i < s.Used; ++i)
+        glGetQueryObjectui64v(s.Queries[i], GL_QUERY_RESULT, &Stamps[i]);
+
+    Results.resize(s.Records.size());
+    for (size_t i = 0; i < s.Records.size(); ++i) {
+        const Record& r = s.Records[i];
+        Results[i].Name = r.Name;
+        Results[i].Depth = r.Depth;
+        Results[i].Ms = Stamps[r.End] > Stamps[r.Begin] ? (Stamps[r.End] - Stamps[r.Begin]) / 1.0e6 : 0.0;
+    }
+    FrameMs = Stamps[1] > Stamps[0] ? (Stamps[1] - Stamps[0]) / 1.0e6 : 0.0;
+    ResultFrame = s.Frame;
+
+    writeLog();
+}
+
+double GPUProfiler::ms(const char* Name) const
+{
+    double Sum = 0;
+    for (size_t i = 0; i < Results.size(); ++i)
+        if (Names[Results[i].Name] == Name)
+            Sum += Results[i].Ms;
+    return Sum;
+}
+
+void GPUProfiler::print() const
+{
+    std::cout << "GPU frame " << ResultFrame << ": " << FrameMs << " ms" << std::endl;
+    for (size_t i = 0; i < Results.size(); ++i)
+        std::cout << std::string(2 * (Results[i].Depth + 1), ' ') << Names[Results[i].Name]
+                  << ": " << Results[i].Ms << " ms" << std::endl;
+}
+
+bool GPUProfiler::openLog(const char* Filename, unsigned int MaxLines)
+{
+    closeLog();
+    pLog = fopen(Filename, "w");
+    if (!pLog) {
+        std::cout << "GPUProfiler::openLog(): WARNING unable to open " << Filename << std::endl;
+        return false;
+    }
+    LogName = Filename;
+    LogMaxLines = MaxLines;
+    LogColumns = 0;
+    LogLines = 0;
+    return true;
+}
+
+void GPUProfiler::closeLog()
+{
+    if (pLog)
+        fclose(pLog);
+    pLog = NULL;
+}
+
+void GPUProfiler::writeLog()
+{
+    if (!pLog)
+        return;
+
+    // neue Spalte oder Datei voll: bisherige Datei nach .old, neue mit Kopfzeile
+    if (LogLines > 0 && (Names.size() != LogColumns || (LogMaxLines && LogLines >= LogMaxLines))) {
+        fclose(pLog);
+        const std::string Old = LogName + ".old";
+        remove(Old.c_str());
+        rename(LogName.c_str(), Old.c_str());
+        pLog = fopen(LogName.c_str(), "w");
+        if (!pLog)
+            return;
+        LogLines = 0;
+    }
+    if (LogLines == 0) {
+        fprintf(pLog, "frame,gpu_ms");
+        for (size_t i = 0; i < Names.size(); ++i)
+            fprintf(pLog, ",%s", Names[i].c_str());
+        fprintf(pLog, "\n");
+        LogColumns = (unsigned int)Names.size();
+    }
+
+    fprintf(pLog, "%u,%.4f", ResultFrame, FrameMs);
+    for (size_t n = 0; n < Names.size(); ++n) {
+        double Sum = 0;
+        for (size_t i = 0; i < Results.size(); ++i)
+            if (Results[i].Name == n)
+                Sum += Results[i].Ms;
+        fprintf(pLog, ",%.4f", Sum);
+    }
+    fprintf(pLog, "\n");
+    LogLines++;
+}
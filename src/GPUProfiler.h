@@ -0,0 +1,106 @@
+#ifndef GPUProfiler_hpp
+#define GPUProfiler_hpp
+
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// GPU-Zeitmessung mit benannten, verschachtelbaren Bereichen (Passes, Modelle).
+// Jeder begin()/end() setzt einen GL_TIMESTAMP-Zeitstempel (glQueryCounter), daher
+// duerfen sich Bereiche beliebig schachteln und mit GL_TIME_ELAPSED-Queries
+// ueberlappen. Die Queries liegen in einem Ring ueber FRAMES Frames; gelesen wird
+// erst, wenn ein Ring-Platz wiederverwendet wird, und nur, wenn das Ergebnis schon
+// vorliegt - sonst wird das Frame verworfen. Der Render-Thread wartet nie.
+//
+//   Profiler.beginFrame();
+//   Profiler.begin("terrain"); ... Profiler.end();
+//   Profiler.endFrame();
+//   Profiler.ms("terrain")   // Wert des letzten ausgewerteten Frames
+class GPUProfiler
+{
+public:
+    enum { FRAMES = 4, MAX_SCOPES = 64 };
+
+    struct Scope
+    {
+        unsigned int Name;  // Index in names()
+        unsigned int Depth; // Schachtelungstiefe, 0 = oberste Ebene
+        double Ms;
+    };
+
+    GPUProfiler();
+    ~GPUProfiler();
+
+    // braucht aktiven GL-Kontext; false, wenn der Treiber keine Zeitstempel liefert
+    bool init();
+    void release();
+    bool isValid() const { return Valid; }
+
+    void beginFrame();
+    void endFrame();
+    void begin(const char* Name);
+    void end();
+
+    // Ergebnisse des zuletzt ausgewerteten Frames (einige Frames alt)
+    const std::vector<Scope>& scopes() const { return Results; }
+    const std::vector<std::string>& names() const { return Names; }
+    // Summe aller Bereiche dieses Namens (z.B. mehrfach geoeffnetes Modell)
+    double ms(const char* Name) const;
+    double frameMs() const { return FrameMs; }
+    unsigned int resultFrame() const { return ResultFrame; }
+    unsigned int framesDropped() const { return Dropped; }
+    void print() const;
+
+    // CSV: eine Zeile pro ausgewertetem Frame, Spalten = Namen in erster Reihenfolge.
+    // Nach MaxLines Zeilen wird die Datei nach <Filename>.old verschoben und neu begonnen.
+    bool openLog(const char* Filename, unsigned int MaxLines = 10000);
+    void closeLog();
+    bool logging() const { return pLog != NULL; }
+
+protected:
+    struct Record
+    {
+        unsigned int Name;
+        unsigned int Depth;
+        unsigned int Begin, End; // Query-Index im Ring-Platz
+    };
+    struct Slot
+    {
+        GLuint Queries[2 * MAX_SCOPES + 2]; // [0] Frame-Beginn, [1] Frame-Ende
+        unsigned int Used;
+        unsigned int Frame;
+        bool Pending;
+        std::vector<Record> Records;
+    };
+
+    unsigned int nameIndex(const char* Name);
+    void collect(Slot& s);
+    void writeLog();
+
+    Slot Slots[FRAMES];
+    std::vector<unsigned int> Stack; // offene Records im aktuellen Frame
+    std::vector<std::string> Names;
+    std::vector<Scope> Results;
+    double FrameMs;
+    unsigned int ResultFrame;
+    unsigned int Frame;
+    unsigned int Dropped;
+    bool Valid;
+    bool InFrame;
+
+    FILE* pLog;
+    std::string LogName;
+    unsigned int LogColumns; // Anzahl Namen in der aktuellen Kopfzeile
+    unsigned int LogLines;
+    unsigned int LogMaxLines;
+};
+
+#endif /* GPUProfiler_hpp */
@@ -0,0 +1,430 @@
+#include "ImageKernels.h"
+#include "rgbimage.h"
+#include "color.h"
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+// ------------------- SIMD-Hilfsfunktionen -------------------
+// Breite richtet sich nach den Compiler-Flags (z. B. -mavx bzw. /arch:AVX).
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define IK_WIDTH 8
+typedef __m256 vfloat;
+static inline vfloat vload(const float* p)      { return _mm256_loadu_ps(p); }
+static inline void   vstore(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+static inline vfloat vset(float f)              { return _mm256_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b)   { return _mm256_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b)   { return _mm256_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b)   { return _mm256_mul_ps(a, b); }
+static inline vfloat vsqrt(vfloat a)            { return _mm256_sqrt_ps(a); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IK_WIDTH 4
+typedef __m128 vfloat;
+static inline vfloat vload(const float* p)      { return _mm_loadu_ps(p); }
+static inline void   vstore(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+static inline vfloat vset(float f)              { return _mm_set1_ps(f); }
+static inline vfloat vadd(vfloat a, vfloat b)   { return _mm_add_ps(a, b); }
+static inline vfloat vsub(vfloat a, vfloat b)   { return _mm_sub_ps(a, b); }
+static inline vfloat vmul(vfloat a, vfloat b)   { return _mm_mul_ps(a, b); }
+static inline vfloat vsqrt(vfloat a)            { return _mm_sqrt_ps(a); }
+#else
+#define IK_WIDTH 1
+typedef float vfloat;
+static inline vfloat vload(const float* p)      { return *p; }
+static inline void   vstore(float* p, vfloat v) { *p = v; }
+static inline vfloat vset(float f)              { return f; }
+static inline vfloat vadd(vfloat a, vfloat b)   { return a + b; }
+static inline vfloat vsub(vfloat a, vfloat b)   { return a - b; }
+static inline vfloat vmul(vfloat a, vfloat b)   { return a * b; }
+static inline vfloat vsqrt(vfloat a)            { return sqrtf(a); }
+#endif
+
+static_assert(sizeof(Color) == 3 * sizeof(float), "RGBImage-Daten muessen dicht gepackte RGB-floats sein");
+
+static inline const float* channels(const RGBImage& img) { return reinterpret_cast<const float*>(img.data()); }
+static inline float* channels(RGBImage& img) { return reinterpret_cast<float*>(img.data()); }
+
+static inline int clampi(int v, int lo, int hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
+
+// out[i] += w * in[i] fuer eine ganze Zeile
+static inline void rowMulAdd(float* out, const float* in, float w, unsigned int n)
+{
+    const vfloat vw = vset(w);
+    unsigned int i = 0;
+    for (; i + IK_WIDTH <= n; i += IK_WIDTH)
+        vstore(out + i, vadd(vload(out + i), vmul(vload(in + i), vw)));
+    for (; i < n; ++i)
+        out[i] += in[i] * w;
+}
+
+// ------------------- Threading -------------------
+
+unsigned int ImageKernels::ThreadCount = 0;
+
+void ImageKernels::threadCount(unsigned int count)
+{
+    ThreadCount = count;
+}
+
+unsigned int ImageKernels::threadCount()
+{
+    if (ThreadCount > 0)
+        return ThreadCount;
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+void ImageKernels::parallelRows(unsigned int rows, const std::function<void(unsigned int, unsigned int)>& fn)
+{
+    const unsigned int MinBlockRows = 16;
+    const unsigned int threads = threadCount();
+    if (threads <= 1 || rows < 2 * MinBlockRows) {
+        if (rows > 0) fn(0, rows);
+        return;
+    }
+
+    // mehr Bloecke als Threads, damit ungleich teure Zeilen sich ausgleichen
+    const unsigned int blocks    = std::min(rows / MinBlockRows, threads * 4);
+    const unsigned int blockRows = (rows + blocks - 1) / blocks;
+    std::atomic<unsigned int> next(0);
+
+    auto worker = [&]() {
+        for (;;) {
+            const unsigned int b = next++;
+            const unsigned int first = b * blockRows;
+            if (b >= blocks || first >= rows) break;
+            fn(first, std::min(rows, first + blockRows));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t)
+        pool.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); ++t)
+        pool[t].join();
+}
+
+// ------------------- Sobel -------------------
+
+RGBImage& ImageKernels::sobel(RGBImage& dst, const RGBImage& src, float factor)
+{
+    assert(dst.width() == src.width() && dst.height() == src.height());
+    assert(&dst != &src);
+
+    const unsigned int w = src.width();
+    const unsigned int h = src.height();
+    if (w < 3 || h < 3)
+        return dst;
+
+    const unsigned int n = w * 3; // floats pro Zeile
+    const float* in = channels(src);
+    float* out = channels(dst);
+
+    parallelRows(h - 2, [&](unsigned int first, unsigned int end) {
+        std::vector<float> s(n), d(n);
+        const vfloat two = vset(2.0f);
+        const vfloat f   = vset(factor);
+
+        for (unsigned int r = first; r < end; ++r) {
+            const unsigned int y = r + 1;
+            const float* a = in + (y - 1) * n;
+            const float* b = in + y * n;
+            const float* c = in + (y + 1) * n;
+
+            // vertikal: Glaettung (1,2,1) und Differenz (1,0,-1)
+            unsigned int i = 0;
+            for (; i + IK_WIDTH <= n; i += IK_WIDTH) {
+                const vfloat va = vload(a + i), vb = vload(b + i), vc = vload(c + i);
+                vstore(&s[i], vadd(vadd(va, vc), vmul(vb, two)));
+                vstore(&d[i], vsub(va, vc));
+            }
+            for (; i < n; ++i) {
+                s[i] = a[i] + 2.0f * b[i] + c[i];
+                d[i] = a[i] - c[i];
+            }
+
+            // horizontal: Gx = Differenz der Glaettung, Gy = Glaettung der Differenz
+            float* o = out + y * n;
+            i = 3;
+            for (; i + IK_WIDTH <= n - 3; i += IK_WIDTH) {
+                const vfloat gx = vsub(vload(&s[i - 3]), vload(&s[i + 3]));
+                const vfloat gy = vadd(vadd(vload(&d[i - 3]), vload(&d[i + 3])), vmul(vload(&d[i]), two));
+                vstore(o + i, vmul(vsqrt(vadd(vmul(gx, gx), vmul(gy, gy))), f));
+            }
+            for (; i < n - 3; ++i) {
+                const float gx = s[i - 3] - s[i + 3];
+                const float gy = d[i - 3] + 2.0f * d[i] + d[i + 3];
+                o[i] = sqrtf(gx * gx + gy * gy) * factor;
+            }
+        }
+    });
+
+    return dst;
+}
+
+// ------------------- Gauss / Box -------------------
+
+// separierbare Faltung mit symmetrischem Kernel (Laenge 2r+1), Rand geklemmt
+static void convolveSeparable(float* out, const float* in, unsigned int w, unsigned int h,
+                              const std::vector<float>& k)
+{
+    const int r = (int)k.size() / 2;
+    const unsigned int n = w * 3;
+    std::vector<float> tmp((size_t)n * h);
+
+    // horizontal: in -> tmp
+    ImageKernels::parallelRows(h, [&](unsigned int first, unsigned int end) {
+        for (unsigned int y = first; y < end; ++y) {
+            const float* src = in + (size_t)y * n;
+            float* dst = &tmp[(size_t)y * n];
+
+            // Innenbereich ohne Klemmung
+            const int x0 = std::min(r, (int)w);
+            const int x1 = std::max(x0, (int)w - r);
+            if (x1 > x0) {
+                memset(dst + x0 * 3, 0, sizeof(float) * (x1 - x0) * 3);
+                for (int j = -r; j <= r; ++j)
+                    rowMulAdd(dst + x0 * 3, src + (x0 + j) * 3, k[j + r], (x1 - x0) * 3);
+            }
+
+            // Raender
+            for (int x = 0; x < (int)w; ++x) {
+                if (x == x0) x = x1;
+                if (x >= (int)w) break;
+                float acc[3] = { 0, 0, 0 };
+                for (int j = -r; j <= r; ++j) {
+                    const float* p = src + clampi(x + j, 0, (int)w - 1) * 3;
+                    acc[0] += p[0] * k[j + r];
+                    acc[1] += p[1] * k[j + r];
+                    acc[2] += p[2] * k[j + r];
+                }
+                dst[x * 3 + 0] = acc[0];
+                dst[x * 3 + 1] = acc[1];
+                dst[x * 3 + 2] = acc[2];
+            }
+        }
+    });
+
+    // vertikal: tmp -> out (ganze Zeilen)
+    ImageKernels::parallelRows(h, [&](unsigned int first, unsigned int end) {
+        for (unsigned int y = first; y < end; ++y) {
+            float* dst = out + (size_t)y * n;
+            memset(dst, 0, sizeof(float) * n);
+            for (int j = -r; j <= r; ++j) {
+                const int sy = clampi((int)y + j, 0, (int)h - 1);
+                rowMulAdd(dst, &tmp[(size_t)sy * n], k[j + r], n);
+            }
+        }
+    });
+}
+
+RGBImage& ImageKernels::gaussianBlur(RGBImage& dst, const RGBImage& src, float sigma)
+{
+    assert(dst.width() == src.width() && dst.height() == src.height());
+    const unsigned int w = src.width();
+    const unsigned int h = src.height();
+
+    if (sigma <= 0.0f) {
+        if (&dst != &src)
+            memcpy(channels(dst), channels(src), sizeof(float) * 3 * w * h);
+        return dst;
+    }
+
+    const int r = (int)ceilf(3.0f * sigma);
+    std::vector<float> k(2 * r + 1);
+    float sum = 0.0f;
+    for (int i = -r; i <= r; ++i) {
+        k[i + r] = expf(-(float)(i * i) / (2.0f * sigma * sigma));
+        sum += k[i + r];
+    }
+    for (size_t i = 0; i < k.size(); ++i)
+        k[i] /= sum;
+
+    convolveSeparable(channels(dst), channels(src), w, h, k);
+    return dst;
+}
+
+RGBImage& ImageKernels::boxFilter(RGBImage& dst, const RGBImage& src, unsigned int radius)
+{
+    assert(dst.width() == src.width() && dst.height() == src.height());
+    const int w = (int)src.width();
+    const int h = (int)src.height();
+    const int r = (int)radius;
+    const unsigned int n = w * 3;
+    const float inv = 1.0f / (float)(2 * r + 1);
+    const float* in = channels(src);
+    float* out = channels(dst);
+    std::vector<float> tmp((size_t)n * h);
+
+    // horizontal: gleitende Summe pro Zeile
+    parallelRows(h, [&](unsigned int first, unsigned int end) {
+        for (unsigned int y = first; y < end; ++y) {
+            const float* s = in + (size_t)y * n;
+            float* d = &tmp[(size_t)y * n];
+            double acc[3] = { 0, 0, 0 };
+            for (int j = -r; j <= r; ++j) {
+                const float* p = s + clampi(j, 0, w - 1) * 3;
+                acc[0] += p[0]; acc[1] += p[1]; acc[2] += p[2];
+            }
+            for (int x = 0; x < w; ++x) {
+                d[x * 3 + 0] = (float)acc[0] * inv;
+                d[x * 3 + 1] = (float)acc[1] * inv;
+                d[x * 3 + 2] = (float)acc[2] * inv;
+                const float* pin  = s + clampi(x + r + 1, 0, w - 1) * 3;
+                const float* pout = s + clampi(x - r, 0, w - 1) * 3;
+                acc[0] += pin[0] - pout[0];
+                acc[1] += pin[1] - pout[1];
+                acc[2] += pin[2] - pout[2];
+            }
+        }
+    });
+
+    // vertikal: gleitende Zeilensumme pro Block
+    parallelRows(h, [&](unsigned int first, unsigned int end) {
+        std::vector<float> acc(n, 0.0f);
+        for (int j = -r; j <= r; ++j)
+            rowMulAdd(&acc[0], &tmp[(size_t)clampi((int)first + j, 0, h - 1) * n], 1.0f, n);
+
+        const vfloat vinv = vset(inv);
+        for (int y = (int)first; y < (int)end; ++y) {
+            float* d = out + (size_t)y * n;
+            unsigned int i = 0;
+            for (; i + IK_WIDTH <= n; i += IK_WIDTH)
+                vstore(d + i, vmul(vload(&acc[i]), vinv));
+            for (; i < n; ++i)
+                d[i] = acc[i] * inv;
+
+            rowMulAdd(&acc[0], &tmp[(size_t)clampi(y + r + 1, 0, h - 1) * n], 1.0f, n);
+            rowMulAdd(&acc[0], &tmp[(size_t)clampi(y - r, 0, h - 1) * n], -1.0f, n);
+        }
+    });
+
+    return dst;
+}
+
+// ------------------- Skalierung -------------------
+
+struct Contribution
+{
+    int First;
+    int Count;
+    unsigned int Offset; // in Weights
+};
+
+static float lanczos(float x, float a)
+{
+    if (x == 0.0f) return 1.0f;
+    if (x <= -a || x >= a) return 0.0f;
+    const float px = 3.14159265358979f * x;
+    return a * sinf(px) * sinf(px / a) / (px * px);
+}
+
+static void buildContributions(unsigned int srcSize, unsigned int dstSize, bool useLanczos, float lobes,
+                               std::vector<Contribution>& contribs, std::vector<float>& weights)
+{
+    const float scale       = (float)dstSize / (float)srcSize;
+    const float filterScale = scale < 1.0f ? scale : 1.0f; // beim Verkleinern Filter strecken
+    const float support     = (useLanczos ? lobes : 1.0f) / filterScale;
+
+    contribs.resize(dstSize);
+    weights.clear();
+    for (unsigned int i = 0; i < dstSize; ++i) {
+        const float center = ((float)i + 0.5f) / scale - 0.5f;
+        const int first = std::max(0, (int)ceilf(center - support));
+        const int last  = std::min((int)srcSize - 1, (int)floorf(center + support));
+
+        Contribution& c = contribs[i];
+        c.Offset = (unsigned int)weights.size();
+        c.First  = first;
+        c.Count  = 0;
+
+        float sum = 0.0f;
+        for (int j = first; j <= last; ++j) {
+            const float x  = ((float)j - center) * filterScale;
+            const float wt = useLanczos ? lanczos(x, lobes) : std::max(0.0f, 1.0f - fabsf(x));
+            weights.push_back(wt);
+            sum += wt;
+            ++c.Count;
+        }
+        if (c.Count == 0) { // Quelle kleiner als Filter: naechstes Pixel
+            c.First = clampi((int)floorf(center + 0.5f), 0, (int)srcSize - 1);
+            c.Count = 1;
+            weights.push_back(1.0f);
+            sum = 1.0f;
+        }
+        for (int j = 0; j < c.Count; ++j)
+            weights[c.Offset + j] /= sum;
+    }
+}
+
+RGBImage& ImageKernels::resizeBilinear(RGBImage& dst, const RGBImage& src)
+{
+    return resize(dst, src, false, 1);
+}
+
+RGBImage& ImageKernels::resizeLanczos(RGBImage& dst, const RGBImage& src, unsigned int lobes)
+{
+    return resize(dst, src, true, lobes > 0 ? lobes : 3);
+}
+
+RGBImage& ImageKernels::resize(RGBImage& dst, const RGBImage& src, bool useLanczos, unsigned int lobes)
+{
+    assert(&dst != &src);
+    const unsigned int sw = src.width(), sh = src.height();
+    const unsigned int dw = dst.width(), dh = dst.height();
+    if (sw == 0 || sh == 0 || dw == 0 || dh == 0)
+        return dst;
+
+    std::vector<Contribution> cx, cy;
+    std::vector<float> wx, wy;
+    buildContributions(sw, dw, useLanczos, (float)lobes, cx, wx);
+    buildContributions(sh, dh, useLanczos, (float)lobes, cy, wy);
+
+    const float* in = channels(src);
+    float* out = channels(dst);
+    const unsigned int sn = sw * 3, dn = dw * 3;
+    std::vector<float> tmp((size_t)dn * sh);
+
+    // horizontal: src (sw x sh) -> tmp (dw x sh)
+    parallelRows(sh, [&](unsigned int first, unsigned int end) {
+        for (unsigned int y = first; y < end; ++y) {
+            const float* s = in + (size_t)y * sn;
+            float* d = &tmp[(size_t)y * dn];
+            for (unsigned int x = 0; x < dw; ++x) {
+                const Contribution& c = cx[x];
+                const float* p = s + c.First * 3;
+                const float* wt = &wx[c.Offset];
+                float r = 0, g = 0, b = 0;
+                for (int j = 0; j < c.Count; ++j, p += 3) {
+                    r += p[0] * wt[j];
+                    g += p[1] * wt[j];
+                    b += p[2] * wt[j];
+                }
+                d[x * 3 + 0] = r;
+                d[x * 3 + 1] = g;
+                d[x * 3 + 2] = b;
+            }
+        }
+    });
+
+    // vertikal: tmp -> dst (ganze Zeilen)
+    parallelRows(dh, [&](unsigned int first, unsigned int end) {
+        for (unsigned int y = first; y < end; ++y) {
+            const Contribution& c = cy[y];
+            float* d = out + (size_t)y * dn;
+            memset(d, 0, sizeof(float) * dn);
+            for (int j = 0; j < c.Count; ++j)
+                rowMulAdd(d, &tmp[(size_t)(c.First + j) * dn], wy[c.Offset + j], dn);
+        }
+    });
+
+    return dst;
+}
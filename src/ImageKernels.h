@@ -0,0 +1,41 @@
+#ifndef ImageKernels_hpp
+#define ImageKernels_hpp
+
+#include <functional>
+
+class RGBImage;
+
+// Separierbare Bildfilter auf RGBImage-Daten.
+// Alle Kernel arbeiten zeilenweise auf den rohen float-Daten (R,G,B hintereinander),
+// verteilen Zeilenbloecke auf mehrere Threads und nutzen SSE/AVX, falls beim
+// Kompilieren verfuegbar (sonst skalarer Fallback).
+class ImageKernels
+{
+public:
+    // Gradientenbetrag (wie RGBImage::SobelFilter), Randpixel bleiben unveraendert.
+    // dst und src muessen gleich gross und verschieden sein.
+    static RGBImage& sobel(RGBImage& dst, const RGBImage& src, float factor = 1.0f);
+
+    // Gauss-Weichzeichner (Radius = ceil(3*sigma)), Rand wird geklemmt. dst == src erlaubt.
+    static RGBImage& gaussianBlur(RGBImage& dst, const RGBImage& src, float sigma);
+
+    // Mittelwertfilter ueber (2*radius+1)^2 Pixel, O(1) pro Pixel. dst == src erlaubt.
+    static RGBImage& boxFilter(RGBImage& dst, const RGBImage& src, unsigned int radius);
+
+    // Skalierung von src auf die Groesse von dst
+    static RGBImage& resizeBilinear(RGBImage& dst, const RGBImage& src);
+    static RGBImage& resizeLanczos(RGBImage& dst, const RGBImage& src, unsigned int lobes = 3);
+
+    // Anzahl Worker-Threads (0 = std::thread::hardware_concurrency())
+    static void threadCount(unsigned int count);
+    static unsigned int threadCount();
+
+    // Verteilt [0,rows) in Bloecken auf die Worker; fn(firstRow, endRow) wird pro Block aufgerufen.
+    static void parallelRows(unsigned int rows, const std::function<void(unsigned int, unsigned int)>& fn);
+
+protected:
+    static RGBImage& resize(RGBImage& dst, const RGBImage& src, bool lanczos, unsigned int lobes);
+    static unsigned int ThreadCount;
+};
+
+#endif /* ImageKernels_hpp */
@@ -7,6 +7,8 @@
 //
 
 #include "IndexBuffer.h"
+#include "GLDispatch.h"
+#include "GLState.h"
 #include <assert.h>
 
 IndexBuffer::IndexBuffer() : BufferInitialized(false), WithinBeginAndEnd(false), IndexFormat(GL_UNSIGNED_INT), IndexCount(0)
@@ -22,7 +24,8 @@ IndexBuffer::~IndexBuffer()
 void IndexBuffer::begin()
 {
     if( BufferInitialized) {
-        glDeleteBuffers(1, &IBO);
+        GLState::bufferDeleted(IBO);
+        GLDispatch::deleteBuffers(1, &IBO);
     }
     IndexCount = 0;
     Indices.clear();
@@ -45,8 +48,10 @@ void IndexBuffer::end()
     }
  
     IndexCount = (unsigned int)Indices.size();
-    glGenBuffers(1, &IBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+    GLDispatch::genBuffers(1, &IBO);
+    // Element-Buffer ist VAO-Zustand: nicht in ein noch gebundenes VAO haengen
+    GLState::bindVertexArray(0);
+    GLState::bindElementBuffer(IBO);
     
     if(Indices.size() < 0xFFFF)
     {
@@ -55,15 +60,14 @@ void IndexBuffer::end()
         for( unsigned int i=0; i<Indices.size(); ++i)
             Data[i] = Indices[i];
         
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size()*sizeof(unsigned short), Data, GL_STATIC_DRAW);
+        GLDispatch::bufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size()*sizeof(unsigned short), Data, GL_STATIC_DRAW);
         delete [] Data;
         IndexFormat = GL_UNSIGNED_SHORT;
     }
     else
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size()*sizeof(unsigned int), &Indices[0], GL_STATIC_DRAW);
+        GLDispatch::bufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size()*sizeof(unsigned int), &Indices[0], GL_STATIC_DRAW);
     
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     WithinBeginAndEnd = false;
     
     
@@ -71,10 +75,10 @@ void IndexBuffer::end()
 
 void IndexBuffer::activate()
 {
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+   GLState::bindElementBuffer(IBO);
 }
 
 void IndexBuffer::deactivate()
 {
-   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+   // bleibt am VAO haengen (ein Binden von 0 wuerde es vom VAO loesen)
 }
@@ -7,6 +7,7 @@
 //
 
 #include "LinePlaneModel.h"
+#include "GLDispatch.h"
 
 LinePlaneModel::LinePlaneModel( float DimX, float DimZ, int NumSegX, int NumSegZ )
 {
@@ -39,7 +40,7 @@ void LinePlaneModel::draw(const BaseCamera& Cam)
 
     VB.activate();
     
-    glDrawArrays(GL_LINES, 0, VB.vertexCount());
+    GLDispatch::drawArrays(GL_LINES, 0, VB.vertexCount());
     
     VB.deactivate();
 }
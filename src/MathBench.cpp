@@ -0,0 +1,614 @@
+#include "MathBench.h"
+#include "vector.h"
+#include "color.h"
+#include "Matrix.h"
+#include "MatrixSIMD.h"
+#include "Aabb.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+// Ergebnis-Senke fuer die Benchmarks, damit der Compiler nichts wegoptimiert
+static volatile float Sink = 0;
+
+// xorshift32: klein und auf allen Plattformen gleich (std::*_distribution ist es nicht)
+class BenchRandom
+{
+public:
+    explicit BenchRandom(unsigned int Seed) : State(Seed ? Seed : 0x9E3779B9u) {}
+    unsigned int next()
+    {
+        State ^= State << 13;
+        State ^= State >> 17;
+        State ^= State << 5;
+        return State;
+    }
+    float uniform(float Lo, float Hi) { return Lo + (Hi - Lo) * (float)((next() >> 8) * (1.0 / 16777216.0)); }
+    Vector vector(float Lo, float Hi) { return Vector(uniform(Lo, Hi), uniform(Lo, Hi), uniform(Lo, Hi)); }
+    Vector direction()
+    {
+        Vector d;
+        do { d = vector(-1, 1); } while (d.lengthSquared() < 1e-4f || d.lengthSquared() > 1.0f);
+        return d.normalize();
+    }
+    // Drehung um zufaellige Achse, je Achse skaliert (Skalierung 1 = starr), verschoben
+    Matrix trs(float MinScale, float MaxScale, float MaxTranslation)
+    {
+        Matrix T, R, S;
+        T.translation(vector(-MaxTranslation, MaxTranslation));
+        R.rotationAxis(direction(), uniform(-3.14159265f, 3.14159265f));
+        S.scale(uniform(MinScale, MaxScale), uniform(MinScale, MaxScale), uniform(MinScale, MaxScale));
+        return T * R * S;
+    }
+    // Projektion * View wie in der Anwendung (nicht affin)
+    Matrix viewProjection()
+    {
+        Matrix P, V;
+        P.perspective(uniform(0.5f, 1.5f), uniform(0.75f, 2.0f), uniform(0.05f, 1.0f), uniform(50.0f, 1000.0f));
+        const Vector Pos = vector(-100, 100);
+        V.lookAt(Pos + direction() * uniform(1.0f, 50.0f), Vector(0, 1, 0), Pos);
+        return P * V;
+    }
+
+protected:
+    unsigned int State;
+};
+
+// ---------------------------------------------------------------------------------------
+// double-Referenzen, gleiche Speicherordnung wie Matrix::m (spaltenweise)
+
+static void toDouble(const Matrix& M, double* Out)
+{
+    for (int i = 0; i < 16; ++i) Out[i] = M.m[i];
+}
+
+static void multiplyD(const double* A, const double* B, double* Out)
+{
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            Out[c * 4 + r] = A[r] * B[c * 4] + A[4 + r] * B[c * 4 + 1] + A[8 + r] * B[c * 4 + 2] + A[12 + r] * B[c * 4 + 3];
+}
+
+// Gauss-Jordan mit Spaltenpivotsuche; false bei (numerisch) singulaerer Matrix
+static bool invertD(const double* M, double* Out)
+{
+    double A[4][8];
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c) {
+            A[r][c] = M[c * 4 + r];
+            A[r][c + 4] = (r == c) ? 1.0 : 0.0;
+        }
+    for (int c = 0; c < 4; ++c) {
+        int Pivot = c;
+        for (int r = c + 1; r < 4; ++r)
+            if (fabs(A[r][c]) > fabs(A[Pivot][c])) Pivot = r;
+        if (fabs(A[Pivot][c]) < 1e-300) return false;
+        for (int k = 0; k < 8; ++k) { const double t = A[c][k]; A[c][k] = A[Pivot][k]; A[Pivot][k] = t; }
+        const double Inv = 1.0 / A[c][c];
+        for (int k = 0; k < 8; ++k) A[c][k] *= Inv;
+        for (int r = 0; r < 4; ++r) {
+            if (r == c) continue;
+            const double f = A[r][c];
+            for (int k = 0; k < 8; ++k) A[r][k] -= f * A[c][k];
+        }
+    }
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c) Out[c * 4 + r] = A[r][c + 4];
+    return true;
+}
+
+static void lookAtD(const Vector& Target, const Vector& Up, const Vector& Position, double* Out)
+{
+    double f[3] = { (double)Target.X - Position.X, (double)Target.Y - Position.Y, (double)Target.Z - Position.Z };
+    double u[3] = { Up.X, Up.Y, Up.Z };
+    const double p[3] = { Position.X, Position.Y, Position.Z };
+    const double lf = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    const double lu = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    for (int i = 0; i < 3; ++i) { f[i] /= lf; u[i] /= lu; }
+    double r[3] = { f[1] * u[2] - f[2] * u[1], f[2] * u[0] - f[0] * u[2], f[0] * u[1] - f[1] * u[0] };
+    const double lr = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    for (int i = 0; i < 3; ++i) r[i] /= lr;
+    u[0] = r[1] * f[2] - r[2] * f[1]; u[1] = r[2] * f[0] - r[0] * f[2]; u[2] = r[0] * f[1] - r[1] * f[0];
+    for (int i = 0; i < 3; ++i) {
+        Out[i * 4 + 0] = r[i];
+        Out[i * 4 + 1] = u[i];
+        Out[i * 4 + 2] = -f[i];
+        Out[i * 4 + 3] = 0;
+    }
+    Out[12] = -(r[0] * p[0] + r[1] * p[1] + r[2] * p[2]);
+    Out[13] = -(u[0] * p[0] + u[1] * p[1] + u[2] * p[2]);
+    Out[14] = f[0] * p[0] + f[1] * p[1] + f[2] * p[2];
+    Out[15] = 1;
+}
+
+static void perspectiveD(double Fovy, double Aspect, double Near, double Far, double* Out)
+{
+    const double f = 1.0 / tan(Fovy * 0.5);
+    for (int i = 0; i < 16; ++i) Out[i] = 0;
+    Out[0] = f / Aspect;
+    Out[5] = f;
+    Out[10] = (Far + Near) / (Near - Far);
+    Out[11] = -1;
+    Out[14] = 2.0 * Far * Near / (Near - Far);
+}
+
+// groesster Betragsfehler, bezogen auf den groessten Betrag der Referenz
+static double relError(const float* Value, const double* Ref, int n)
+{
+    double MaxRef = 0, MaxErr = 0;
+    for (int i = 0; i < n; ++i) {
+        if (fabs(Ref[i]) > MaxRef) MaxRef = fabs(Ref[i]);
+        if (fabs(Value[i] - Ref[i]) > MaxErr) MaxErr = fabs(Value[i] - Ref[i]);
+    }
+    return MaxErr / (MaxRef > 1e-30 ? MaxRef : 1.0);
+}
+
+// Zeilensummennorm; Konditionszahl = norm(A) * norm(A^-1)
+static double normInf(const double* M)
+{
+    double Max = 0;
+    for (int r = 0; r < 4; ++r)
+        Max = fmax(Max, fabs(M[r]) + fabs(M[4 + r]) + fabs(M[8 + r]) + fabs(M[12 + r]));
+    return Max;
+}
+
+// Fehler einer Inversen: schlecht konditionierte Matrizen verlieren bei jedem
+// Verfahren Stellen, deshalb relativ zur Konditionszahl
+static double invError(const float* Value, const double* M, const double* Ref)
+{
+    return relError(Value, Ref, 16) / (normInf(M) * normInf(Ref));
+}
+
+// ---------------------------------------------------------------------------------------
+// Ausgabe
+
+static bool report(const char* Name, const char* Level, double Error, double Tolerance)
+{
+    const bool Ok = Error <= Tolerance; // NaN faellt durch
+    printf("check %-28s %-6s max %.3e tol %.1e %s\n", Name, Level, Error, Tolerance, Ok ? "ok" : "FEHLER");
+    return Ok;
+}
+
+// Stufen, die dieser Rechner kann; MatrixSIMD::force() schaltet um
+static std::vector<MatrixSIMD::ISA> levels()
+{
+    std::vector<MatrixSIMD::ISA> Levels;
+    for (int l = MatrixSIMD::SCALAR; l <= MatrixSIMD::detected(); ++l)
+        Levels.push_back((MatrixSIMD::ISA)l);
+    return Levels;
+}
+
+// ---------------------------------------------------------------------------------------
+// Genauigkeit
+
+static bool checkVector(BenchRandom& Rnd, unsigned int Samples)
+{
+    double ErrDot = 0, ErrCross = 0, ErrNorm = 0;
+    for (unsigned int i = 0; i < Samples; ++i) {
+        const Vector a = Rnd.vector(-100, 100), b = Rnd.vector(-100, 100);
+        const double ax = a.X, ay = a.Y, az = a.Z, bx = b.X, by = b.Y, bz = b.Z;
+        const double Scale = sqrt(ax * ax + ay * ay + az * az) * sqrt(bx * bx + by * by + bz * bz) + 1e-30;
+
+        const double Dot = ax * bx + ay * by + az * bz;
+        ErrDot = fmax(ErrDot, fabs(a.dot(b) - Dot) / Scale);
+
+        const Vector c = a.cross(b);
+        const double Ref[3] = { ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx };
+        for (int k = 0; k < 3; ++k) ErrCross = fmax(ErrCross, fabs((&c.X)[k] - Ref[k]) / Scale);
+
+        Vector n = a;
+        n.normalize();
+        const double nx = n.X, ny = n.Y, nz = n.Z;
+        ErrNorm = fmax(ErrNorm, fabs(sqrt(nx * nx + ny * ny + nz * nz) - 1.0));
+    }
+    bool Ok = report("vector.dot", "-", ErrDot, 1e-6);
+    Ok &= report("vector.cross", "-", ErrCross, 1e-6);
+    Ok &= report("vector.normalize", "-", ErrNorm, 1e-6);
+    return Ok;
+}
+
+static bool checkColor(BenchRandom& Rnd, unsigned int Samples)
+{
+    double Err = 0;
+    for (unsigned int i = 0; i < Samples; ++i) {
+        const Color a(Rnd.uniform(0, 1), Rnd.uniform(0, 1), Rnd.uniform(0, 1));
+        const Color b(Rnd.uniform(0, 1), Rnd.uniform(0, 1), Rnd.uniform(0, 1));
+        const float f = Rnd.uniform(0, 4);
+        const Color c = a * b + a * f;
+        const double Ref[3] = { (double)a.R * b.R + (double)a.R * f, (double)a.G * b.G + (double)a.G * f,
+                                (double)a.B * b.B + (double)a.B * f };
+        for (int k = 0; k < 3; ++k) Err = fmax(Err, fabs((&c.R)[k] - Ref[k]) / (fabs(Ref[k]) + 1e-30));
+    }
+    return report("color.mul_add", "-", Err, 1e-6);
+}
+
+static bool checkMatrixLevel(BenchRandom& Rnd, unsigned int Samples, const char* Level)
+{
+    double ErrMul = 0, ErrInv = 0, ErrAffine = 0, ErrRigid = 0, ErrAoS = 0, ErrSoA = 0;
+    double A[16], B[16], Ref[16], Inv[16];
+    const size_t n = 67; // kein Vielfaches von 4/8: Reste werden mitgeprueft
+    Vector In[n], Out[n];
+    float InX[n], InY[n], InZ[n], OutX[n], OutY[n], OutZ[n];
+
+    for (unsigned int i = 0; i < Samples; ++i) {
+        const Matrix Ma = (i & 1) ? Rnd.viewProjection() : Rnd.trs(0.2f, 5.0f, 100.0f);
+        const Matrix Mb = Rnd.trs(0.2f, 5.0f, 100.0f);
+        toDouble(Ma, A);
+        toDouble(Mb, B);
+
+        // Fehler je Element relativ zu sum |a_rk * b_kc| (Schranke der Rundung)
+        const Matrix Mc = Ma * Mb;
+        multiplyD(A, B, Ref);
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r) {
+                double Bound = 1e-30;
+                for (int k = 0; k < 4; ++k) Bound += fabs(A[k * 4 + r] * B[c * 4 + k]);
+                ErrMul = fmax(ErrMul, fabs(Mc.m[c * 4 + r] - Ref[c * 4 + r]) / Bound);
+            }
+
+        Matrix Mi = Ma;
+        Mi.invert();
+        if (invertD(A, Inv)) ErrInv = fmax(ErrInv, invError(Mi.m, A, Inv));
+
+        Matrix Maff = Mb;
+        Maff.invertAffine();
+        invertD(B, Inv);
+        ErrAffine = fmax(ErrAffine, invError(Maff.m, B, Inv));
+
+        const Matrix Mr = Rnd.trs(1.0f, 1.0f, 100.0f);
+        Matrix Mri = Mr;
+        Mri.invertRigid();
+        toDouble(Mr, B);
+        invertD(B, Inv);
+        ErrRigid = fmax(ErrRigid, invError(Mri.m, B, Inv));
+
+        // Punkte/Richtungen nur in jedem 16. Durchlauf, sonst dominieren sie die Laufzeit
+        if (i % 16) continue;
+        toDouble(Mb, B);
+        const float W = (i & 16) ? 0.0f : 1.0f;
+        for (size_t k = 0; k < n; ++k) {
+            In[k] = Rnd.vector(-50, 50);
+            InX[k] = In[k].X; InY[k] = In[k].Y; InZ[k] = In[k].Z;
+        }
+        if (W == 1.0f) {
+            Mb.transformPoints(In, Out, n);
+            Mb.transformPoints(InX, InY, InZ, OutX, OutY, OutZ, n);
+        } else {
+            Mb.transformDirections(In, Out, n);
+            Mb.transformDirections(InX, InY, InZ, OutX, OutY, OutZ, n);
+        }
+        for (size_t k = 0; k < n; ++k) {
+            const double p[4] = { In[k].X, In[k].Y, In[k].Z, W };
+            for (int r = 0; r < 3; ++r) {
+                double Sum = 0, Bound = 1e-30;
+                for (int c = 0; c < 4; ++c) { Sum += B[c * 4 + r] * p[c]; Bound += fabs(B[c * 4 + r] * p[c]); }
+                const float SoA = (r == 0) ? OutX[k] : (r == 1) ? OutY[k] : OutZ[k];
+                ErrAoS = fmax(ErrAoS, fabs((&Out[k].X)[r] - Sum) / Bound);
+                ErrSoA = fmax(ErrSoA, fabs(SoA - Sum) / Bound);
+            }
+        }
+    }
+    bool Ok = report("matrix.multiply", Level, ErrMul, 1e-6);
+    Ok &= report("matrix.invert", Level, ErrInv, 1e-6);
+    Ok &= report("matrix.invertAffine", Level, ErrAffine, 1e-6);
+    Ok &= report("matrix.invertRigid", Level, ErrRigid, 1e-6);
+    Ok &= report("matrix.transformPoints.aos", Level, ErrAoS, 1e-6);
+    Ok &= report("matrix.transformPoints.soa", Level, ErrSoA, 1e-6);
+    return Ok;
+}
+
+static bool checkCamera(BenchRandom& Rnd, unsigned int Samples)
+{
+    double ErrLook = 0, ErrPersp = 0, ErrVec4 = 0;
+    double Ref[16];
+    for (unsigned int i = 0; i < Samples; ++i) {
+        const Vector Pos = Rnd.vector(-100, 100);
+        const Vector Target = Pos + Rnd.direction() * Rnd.uniform(0.1f, 100.0f);
+        Vector Up = Rnd.direction();
+        const Vector f = (Target - Pos).normalize();
+        if (fabsf(f.dot(Up)) > 0.99f) continue; // Blickrichtung ~ Up ist undefiniert
+        Matrix V;
+        V.lookAt(Target, Up, Pos);
+        lookAtD(Target, Up, Pos, Ref);
+        // Translationsanteil skaliert mit |Position|
+        const double Scale = fmax(1.0, sqrt((double)Pos.lengthSquared()));
+        for (int k = 0; k < 16; ++k) ErrLook = fmax(ErrLook, fabs(V.m[k] - Ref[k]) / Scale);
+
+        const float Fovy = Rnd.uniform(0.3f, 2.5f), Aspect = Rnd.uniform(0.5f, 3.0f);
+        const float Near = Rnd.uniform(0.01f, 1.0f), Far = Rnd.uniform(10.0f, 5000.0f);
+        Matrix P;
+        P.perspective(Fovy, Aspect, Near, Far);
+        perspectiveD(Fovy, Aspect, Near, Far, Ref);
+        for (int k = 0; k < 16; ++k)
+            ErrPersp = fmax(ErrPersp, fabs(P.m[k] - Ref[k]) / fmax(fabs(Ref[k]), 1e-30) * (Ref[k] != 0));
+
+        // transformVec4x4 mit Division durch w: Punkt vor der Kamera in NDC
+        const Matrix VP = P * V;
+        const Vector p = Pos + f * Rnd.uniform(Near * 2.0f, Far * 0.5f) + Rnd.vector(-1, 1);
+        const Vector q = VP.transformVec4x4(p);
+        double M[16], h[4];
+        toDouble(VP, M);
+        for (int r = 0; r < 4; ++r) h[r] = M[r] * p.X + M[4 + r] * p.Y + M[8 + r] * p.Z + M[12 + r];
+        if (h[3] < Near) continue;
+        const double Ndc[3] = { h[0] / h[3], h[1] / h[3], h[2] / h[3] };
+        for (int k = 0; k < 3; ++k) ErrVec4 = fmax(ErrVec4, fabs((&q.X)[k] - Ndc[k]) / fmax(1.0, fabs(Ndc[k])));
+    }
+    bool Ok = report("matrix.lookAt", "-", ErrLook, 1e-5);
+    Ok &= report("matrix.perspective", "-", ErrPersp, 1e-6);
+    // NDC-Fehler waechst mit Far/Near (Tiefenwert), daher grosszuegiger
+    Ok &= report("matrix.transformVec4x4", "-", ErrVec4, 1e-3);
+    return Ok;
+}
+
+static bool checkAABB(BenchRandom& Rnd, unsigned int Samples)
+{
+    double Err = 0;
+    double M[16];
+    for (unsigned int i = 0; i < Samples; ++i) {
+        const Vector c = Rnd.vector(-100, 100), e = Rnd.vector(0.01f, 20.0f);
+        AABB Box(c - e, c + e);
+        const Matrix T = Rnd.trs(0.2f, 5.0f, 100.0f);
+        toDouble(T, M);
+        // Referenz: alle 8 Ecken in double transformieren
+        double Lo[3] = { 1e300, 1e300, 1e300 }, Hi[3] = { -1e300, -1e300, -1e300 };
+        for (int k = 0; k < 8; ++k) {
+            const double p[3] = { (k & 1) ? Box.Max.X : Box.Min.X, (k & 2) ? Box.Max.Y : Box.Min.Y,
+                                  (k & 4) ? Box.Max.Z : Box.Min.Z };
+            for (int r = 0; r < 3; ++r) {
+                const double v = M[r] * p[0] + M[4 + r] * p[1] + M[8 + r] * p[2] + M[12 + r];
+                Lo[r] = fmin(Lo[r], v);
+                Hi[r] = fmax(Hi[r], v);
+            }
+        }
+        Box.transform(T);
+        double Scale = 1.0;
+        for (int r = 0; r < 3; ++r) Scale = fmax(Scale, fmax(fabs(Lo[r]), fabs(Hi[r])));
+        for (int r = 0; r < 3; ++r) {
+            Err = fmax(Err, fabs((&Box.Min.X)[r] - Lo[r]) / Scale);
+            Err = fmax(Err, fabs((&Box.Max.X)[r] - Hi[r]) / Scale);
+        }
+    }
+    return report("aabb.transform", "-", Err, 1e-5);
+}
+
+// SIMD-Klassifikation gegen die Skalar-Referenz; Fehler = Anteil abweichender Boxen
+static bool checkAABB8Level(BenchRandom& Rnd, unsigned int Samples, const char* Level)
+{
+    unsigned int Wrong = 0, Total = 0;
+    AABB8 Boxes;
+    for (unsigned int i = 0; i < Samples / 8 + 1; ++i) {
+        Boxes.clear();
+        const unsigned int Count = 1 + Rnd.next() % 8;
+        for (unsigned int k = 0; k < Count; ++k) {
+            const Vector c = Rnd.vector(-50, 50), e = Rnd.vector(0.1f, 10.0f);
+            Boxes.set(k, AABB(c - e, c + e));
+        }
+        const Vector n = Rnd.direction();
+        const float Plane[4] = { n.X, n.Y, n.Z, Rnd.uniform(-50, 50) };
+        unsigned int Out, In, OutRef, InRef;
+        Boxes.classify(Plane, Out, In);
+        Boxes.classifyScalar(Plane, OutRef, InRef);
+        const AABB Probe(Rnd.vector(-60, 0), Rnd.vector(0, 60));
+        const unsigned int Hit = Boxes.overlaps(Probe), HitRef = Boxes.overlapsScalar(Probe);
+        for (unsigned int k = 0; k < Count; ++k) {
+            const unsigned int b = 1u << k;
+            Wrong += ((Out ^ OutRef) & b) || ((In ^ InRef) & b) || ((Hit ^ HitRef) & b);
+        }
+        Total += Count;
+    }
+    return report("aabb8.classify_overlaps", Level, (double)Wrong / (Total ? Total : 1), 0.0);
+}
+
+bool MathBench::check(unsigned int Seed, unsigned int Samples)
+{
+    printf("check seed %u samples %u isa %s\n", Seed, Samples, MatrixSIMD::name(MatrixSIMD::detected()));
+    bool Ok = true;
+    {
+        BenchRandom Rnd(Seed);
+        Ok &= checkVector(Rnd, Samples);
+    }
+    {
+        BenchRandom Rnd(Seed);
+        Ok &= checkColor(Rnd, Samples);
+    }
+    {
+        BenchRandom Rnd(Seed);
+        Ok &= checkCamera(Rnd, Samples);
+    }
+    {
+        BenchRandom Rnd(Seed);
+        Ok &= checkAABB(Rnd, Samples);
+    }
+    // jede SIMD-Stufe mit denselben Daten
+    const std::vector<MatrixSIMD::ISA> Levels = levels();
+    for (size_t l = 0; l < Levels.size(); ++l) {
+        MatrixSIMD::force(Levels[l]);
+        BenchRandom Rnd(Seed);
+        Ok &= checkMatrixLevel(Rnd, Samples, MatrixSIMD::name(Levels[l]));
+        Ok &= checkAABB8Level(Rnd, Samples, MatrixSIMD::name(Levels[l]));
+    }
+    MatrixSIMD::force(MatrixSIMD::detected());
+    printf("check %s\n", Ok ? "ok" : "FEHLER");
+    return Ok;
+}
+
+// ---------------------------------------------------------------------------------------
+// Durchsatz
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Body() bearbeitet OpsPerCall Operationen und liefert einen Wert fuer die Senke
+template <typename Fn>
+static double nsPerOp(Fn Body, unsigned int OpsPerCall, double Seconds)
+{
+    Sink = Sink + Body(); // aufwaermen (Caches, Dispatch, Taktfrequenz)
+    const double RoundSeconds = Seconds / 5.0;
+    double Best = 1e30;
+    for (int Round = 0; Round < 5; ++Round) {
+        unsigned long long Calls = 0;
+        double Elapsed = 0;
+        const BenchClock::time_point Start = BenchClock::now();
+        do {
+            Sink = Sink + Body();
+            ++Calls;
+            Elapsed = std::chrono::duration<double>(BenchClock::now() - Start).count();
+        } while (Elapsed < RoundSeconds);
+        Best = fmin(Best, Elapsed * 1e9 / ((double)Calls * OpsPerCall));
+    }
+    return Best;
+}
+
+static void printBench(const char* Name, const char* Level, double Ns)
+{
+    printf("bench %-28s %-6s %9.2f ns/op\n", Name, Level, Ns);
+}
+
+void MathBench::bench(double Seconds)
+{
+    printf("bench seconds %.2f isa %s\n", Seconds, MatrixSIMD::name(MatrixSIMD::detected()));
+
+    // Daten passen in L1/L2: gemessen wird Rechenzeit, nicht Speicherbandbreite
+    const unsigned int N = 256;
+    BenchRandom Rnd(1);
+    std::vector<Vector> Va(N), Vb(N), Vout(N);
+    std::vector<float> Xa(N), Ya(N), Za(N), Xo(N), Yo(N), Zo(N);
+    std::vector<Color> Ca(N), Cb(N);
+    std::vector<Matrix> Ma(N), Mb(N), Mr(N), Mout(N);
+    std::vector<AABB> Boxes(N);
+    std::vector<float> Params(N);
+    for (unsigned int i = 0; i < N; ++i) {
+        Va[i] = Rnd.vector(-100, 100);
+        Vb[i] = Rnd.vector(-100, 100);
+        Xa[i] = Va[i].X; Ya[i] = Va[i].Y; Za[i] = Va[i].Z;
+        Ca[i] = Color(Rnd.uniform(0, 1), Rnd.uniform(0, 1), Rnd.uniform(0, 1));
+        Cb[i] = Color(Rnd.uniform(0, 1), Rnd.uniform(0, 1), Rnd.uniform(0, 1));
+        Ma[i] = (i & 1) ? Rnd.viewProjection() : Rnd.trs(0.2f, 5.0f, 100.0f);
+        Mb[i] = Rnd.trs(0.2f, 5.0f, 100.0f);
+        Mr[i] = Rnd.trs(1.0f, 1.0f, 100.0f);
+        const Vector e = Rnd.vector(0.1f, 10.0f);
+        Boxes[i] = AABB(Va[i] - e, Va[i] + e);
+        Params[i] = Rnd.uniform(0.5f, 1.5f);
+    }
+    AABB8 Box8;
+    for (unsigned int k = 0; k < 8; ++k) Box8.set(k, Boxes[k]);
+
+    printBench("vector.dot", "-", nsPerOp([&]() {
+        float s = 0;
+        for (unsigned int i = 0; i < N; ++i) s += Va[i].dot(Vb[i]);
+        return s;
+    }, N, Seconds));
+    printBench("vector.cross", "-", nsPerOp([&]() {
+        for (unsigned int i = 0; i < N; ++i) Vout[i] = Va[i].cross(Vb[i]);
+        return Vout[N / 2].X;
+    }, N, Seconds));
+    printBench("vector.normalize", "-", nsPerOp([&]() {
+        for (unsigned int i = 0; i < N; ++i) { Vout[i] = Va[i]; Vout[i].normalize(); }
+        return Vout[N / 2].X;
+    }, N, Seconds));
+    printBench("color.mul_add", "-", nsPerOp([&]() {
+        Color Sum;
+        for (unsigned int i = 0; i < N; ++i) Sum += Ca[i] * Cb[i] + Ca[i] * Params[i];
+        return Sum.R;
+    }, N, Seconds));
+    printBench("matrix.lookAt", "-", nsPerOp([&]() {
+        for (unsigned int i = 0; i < N; ++i) Mout[i].lookAt(Vb[i], Vector(0, 1, 0), Va[i]);
+        return Mout[N / 2].m03;
+    }, N, Seconds));
+    printBench("matrix.perspective", "-", nsPerOp([&]() {
+        for (unsigned int i = 0; i < N; ++i) Mout[i].perspective(Params[i], 1.5f, 0.1f, 1000.0f);
+        return Mout[N / 2].m00;
+    }, N, Seconds));
+    printBench("matrix.transformVec4x4", "-", nsPerOp([&]() {
+        for (unsigned int i = 0; i < N; ++i) Vout[i] = Ma[i].transformVec4x4(Va[i]);
+        return Vout[N / 2].X;
+    }, N, Seconds));
+    printBench("aabb.transform", "-", nsPerOp([&]() {
+        float s = 0;
+        for (unsigned int i = 0; i < N; ++i) {
+            AABB b = Boxes[i];
+            b.transform(Mb[i]);
+            s += b.Max.X;
+        }
+        return s;
+    }, N, Seconds));
+
+    const std::vector<MatrixSIMD::ISA> Levels = levels();
+    for (size_t l = 0; l < Levels.size(); ++l) {
+        MatrixSIMD::force(Levels[l]);
+        const char* Level = MatrixSIMD::name(Levels[l]);
+        printBench("matrix.multiply", Level, nsPerOp([&]() {
+            for (unsigned int i = 0; i < N; ++i) Mout[i] = Ma[i] * Mb[i];
+            return Mout[N / 2].m00;
+        }, N, Seconds));
+        printBench("matrix.invert", Level, nsPerOp([&]() {
+            for (unsigned int i = 0; i < N; ++i) { Mout[i] = Ma[i]; Mout[i].invert(); }
+            return Mout[N / 2].m00;
+        }, N, Seconds));
+        printBench("matrix.invertAffine", Level, nsPerOp([&]() {
+            for (unsigned int i = 0; i < N; ++i) { Mout[i] = Mb[i]; Mout[i].invertAffine(); }
+            return Mout[N / 2].m00;
+        }, N, Seconds));
+        printBench("matrix.invertRigid", Level, nsPerOp([&]() {
+            for (unsigned int i = 0; i < N; ++i) { Mout[i] = Mr[i]; Mout[i].invertRigid(); }
+            return Mout[N / 2].m00;
+        }, N, Seconds));
+        // je Punkt
+        printBench("matrix.transformPoints.aos", Level, nsPerOp([&]() {
+            Mb[0].transformPoints(&Va[0], &Vout[0], N);
+            return Vout[N / 2].X;
+        }, N, Seconds));
+        printBench("matrix.transformPoints.soa", Level, nsPerOp([&]() {
+            Mb[0].transformPoints(&Xa[0], &Ya[0], &Za[0], &Xo[0], &Yo[0], &Zo[0], N);
+            return Xo[N / 2];
+        }, N, Seconds));
+        // je Aufruf mit 8 Boxen
+        printBench("aabb8.classify", Level, nsPerOp([&]() {
+            unsigned int Acc = 0;
+            for (unsigned int i = 0; i < N; ++i) {
+                const float Plane[4] = { Vb[i].X, Vb[i].Y, Vb[i].Z, Params[i] };
+                unsigned int Out, In;
+                Box8.classify(Plane, Out, In);
+                Acc += Out ^ In;
+            }
+            return (float)Acc;
+        }, N, Seconds));
+    }
+    MatrixSIMD::force(MatrixSIMD::detected());
+}
+
+int MathBench::run(int argc, char** argv)
+{
+    bool Check = false, Bench = false;
+    unsigned int Seed = 1, Samples = 100000;
+    double Seconds = 0.25;
+    for (int i = 1; i < argc; ++i) {
+        const bool HasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--check-math") == 0) Check = true;
+        else if (strcmp(argv[i], "--bench-math") == 0) Bench = true;
+        else if (strcmp(argv[i], "--seed") == 0 && HasValue) Seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--samples") == 0 && HasValue) Samples = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bench-time") == 0 && HasValue) Seconds = atof(argv[++i]);
+    }
+    if (!Check && !Bench)
+        return -1;
+
+    bool Ok = true;
+    if (Check) Ok = check(Seed, Samples ? Samples : 1);
+    if (Bench) bench(Seconds > 0 ? Seconds : 0.25);
+    fflush(stdout);
+    return Ok ? 0 : 1;
+}
+
+#ifdef MATHBENCH_MAIN
+int main(int argc, char** argv)
+{
+    const int Result = MathBench::run(argc, argv);
+    if (Result >= 0)
+        return Result;
+    // ohne Option: erst pruefen, dann messen
+    return MathBench::check() ? (MathBench::bench(), 0) : 1;
+}
+#endif
@@ -0,0 +1,35 @@
+#ifndef MathBench_hpp
+#define MathBench_hpp
+
+// Mikro-Benchmarks und randomisierte Genauigkeitstests fuer Vector, Color, Matrix und
+// AABB. Braucht keinen GL-Kontext und kein Fenster, laeuft also auch auf Rechnern ohne
+// Grafik (z.B. Linux-Server):
+//   <Programm> --check-math [--seed N] [--samples N]
+//   <Programm> --bench-math [--bench-time S]
+// oder ohne den Rest des Programms:
+//   g++ -std=gnu++11 -O2 -DMATHBENCH_MAIN -o mathbench MathBench.cpp Matrix.cpp
+//       MatrixSIMD.cpp vector.cpp color.cpp Aabb.cpp RayIntersect.cpp   (eine Zeile)
+//
+// Jede Zeile beschreibt eine Operation (bei SIMD-Kernen je Stufe einmal) in festem
+// Format, damit Ausgaben verschiedener Commits per diff vergleichbar sind:
+//   check <name> <stufe> max <fehler> tol <toleranz> ok|FEHLER
+//   bench <name> <stufe> <ns> ns/op
+// Fehler sind relativ zur Groesse der Eingaben gegen eine double-Referenz gerechnet,
+// bei Inversen zusaetzlich durch die Konditionszahl geteilt.
+// Zufallszahlen kommen aus einem eigenen Generator, gleicher Seed = gleiche Daten auf
+// allen Plattformen.
+class MathBench
+{
+public:
+    // false, wenn mindestens ein Test seine Toleranz ueberschreitet
+    static bool check(unsigned int Seed = 1, unsigned int Samples = 100000);
+    // Durchsatz je Operation, SecondsPerOp verteilt auf 5 Runden (die schnellste zaehlt)
+    static void bench(double SecondsPerOp = 0.25);
+
+    // wertet --check-math, --bench-math, --seed, --samples und --bench-time aus.
+    // -1: keine dieser Optionen, das Programm laeuft normal weiter;
+    // sonst Exit-Code (0 = alle Tests bestanden)
+    static int run(int argc, char** argv);
+};
+
+#endif /* MathBench_hpp */
@@ -10,7 +10,9 @@
 #define __RealtimeRending__Matrix__
 
 #include <iostream>
+#include <type_traits>
 #include "vector.h"
+#include "MatrixSIMD.h"
 
 class Matrix
 {
@@ -25,38 +27,51 @@ public:
         };
         struct { float m[16]; };
     };
-    Matrix();
-    Matrix( float _00, float _01, float _02, float _03,
-            float _10, float _11, float _12, float _13,
-            float _20, float _21, float _22, float _23,
-            float _30, float _31, float _32, float _33 );
+    // bleibt uninitialisiert wie bisher; fuer Konstanten identityMatrix() oder den
+    // 16-Werte-Konstruktor nehmen
+    Matrix() noexcept {}
+    constexpr Matrix( float _00, float _01, float _02, float _03,
+                      float _10, float _11, float _12, float _13,
+                      float _20, float _21, float _22, float _23,
+                      float _30, float _31, float _32, float _33 ) noexcept :
+        m00(_00), m10(_10), m20(_20), m30(_30),
+        m01(_01), m11(_11), m21(_21), m31(_31),
+        m02(_02), m12(_12), m22(_22), m32(_32),
+        m03(_03), m13(_13), m23(_23), m33(_33) {}
+    static constexpr Matrix identityMatrix() noexcept
+    {
+        return Matrix(1, 0, 0, 0,
+                      0, 1, 0, 0,
+                      0, 0, 1, 0,
+                      0, 0, 0, 1);
+    }
 
     
-    operator float*();
-    operator const float* const();
+    operator float*() { return m; }
+    operator const float* const() { return m; }
     
     Matrix operator*(const Matrix& M) const;
-    Matrix& operator*=(const Matrix& M);
-    Vector operator*(const Vector& v) const;
+    Matrix& operator*=(const Matrix& M) { return multiply(M); }
+    Vector operator*(const Vector& v) const { return transformVec4x4(v); }
     
     bool operator==(const Matrix& M);
-    bool operator!=(const Matrix& M);
+    bool operator!=(const Matrix& M) { return !(*this==M); }
     
-    Vector left() const;
-    Vector right() const;
-    Vector up() const;
-    Vector down() const;
-    Vector forward() const;
-    Vector backward() const;
-    Vector translation() const;
+    constexpr Vector left() const noexcept { return Vector(-m00, -m10, -m20); }
+    constexpr Vector right() const noexcept { return Vector(m00, m10, m20); }
+    constexpr Vector up() const noexcept { return Vector(m01, m11, m21); }
+    constexpr Vector down() const noexcept { return Vector(-m01, -m11, -m21); }
+    constexpr Vector forward() const noexcept { return Vector(m02, m12, m22); }
+    constexpr Vector backward() const noexcept { return Vector(-m02, -m12, -m22); }
+    constexpr Vector translation() const noexcept { return Vector(m03, m13, m23); }
     
-    void up( const Vector& v);
-    void forward( const Vector& v);
-    void right( const Vector& v);
+    void up( const Vector& v) { m01 = v.X; m11 = v.Y; m21 = v.Z; }
+    void forward( const Vector& v) { m02 = v.X; m12 = v.Y; m22 = v.Z; }
+    void right( const Vector& v) { m00 = v.X; m10 = v.Y; m20 = v.Z; }
     
-    Matrix& multiply(const Matrix& M );
+    Matrix& multiply(const Matrix& M ) { MatrixSIMD::multiply(m, M.m, m); return *this; }
     Matrix& translation(float X, float Y, float Z );
-    Matrix& translation(const Vector& XYZ );
+    Matrix& translation(const Vector& XYZ ) { return translation(XYZ.X, XYZ.Y, XYZ.Z); }
     Matrix& rotationX(float Angle );
     Matrix& rotationY(float Angle );
     Matrix& rotationZ(float Angle );
@@ -64,18 +79,84 @@ public:
     Matrix& rotationYawPitchRoll(const Vector& Angles );
     Matrix& rotationAxis(const Vector& Axis, float Angle);
     Matrix& scale(float ScaleX, float ScaleY, float ScaleZ );
-    Matrix& scale(const Vector& Scalings );
-    Matrix& scale(float Scaling );
-    Matrix& identity();
+    Matrix& scale(const Vector& Scalings ) { return scale(Scalings.X, Scalings.Y, Scalings.Z); }
+    Matrix& scale(float Scaling ) { return scale(Scaling, Scaling, Scaling); }
+    Matrix& identity() { *this = identityMatrix(); return *this; }
     Matrix& transpose();
-    Matrix& invert();
+    // allgemeine Inverse; fuer Modell- und View-Matrizen sind die beiden folgenden billiger
+    Matrix& invert() { MatrixSIMD::invert(m, m); return *this; }
+    // nur fuer affine Matrizen (letzte Zeile 0,0,0,1)
+    Matrix& invertAffine() { MatrixSIMD::invertAffine(m, m); return *this; }
+    // nur fuer Drehung + Translation (View-Matrizen aus lookAt, Transformationen ohne Skalierung)
+    Matrix& invertRigid() { MatrixSIMD::invertRigid(m, m); return *this; }
     Matrix& lookAt(const Vector& Target, const Vector& Up, const Vector& Position );
     Matrix& perspective(float Fovy, float AspectRatio, float NearPlane, float FarPlane );
     Matrix& orthographic(float Width, float Height, float Near, float Far );
     Vector transformVec4x4( const Vector& v) const;
-    Vector transformVec3x3( const Vector& v) const;
+    constexpr Vector transformVec3x3( const Vector& v) const noexcept
+    {
+        return Vector(m00*v.X + m01*v.Y + m02*v.Z,
+                      m10*v.X + m11*v.Y + m12*v.Z,
+                      m20*v.X + m21*v.Y + m22*v.Z);
+    }
+    // viele Punkte (w = 1) bzw. Richtungen (w = 0) auf einmal (SIMD), ohne Division durch w.
+    // AoS: n-mal x,y,z hintereinander, SoA: ein Array pro Komponente. Ein- und Ausgabe
+    // duerfen identisch sein.
+    void transformPoints( const float* in, float* out, size_t n) const { MatrixSIMD::transformAoS(m, in, out, n, 1.0f); }
+    void transformDirections( const float* in, float* out, size_t n) const { MatrixSIMD::transformAoS(m, in, out, n, 0.0f); }
+    void transformPoints( const Vector* in, Vector* out, size_t n) const { MatrixSIMD::transformAoS(m, &in->X, &out->X, n, 1.0f); }
+    void transformDirections( const Vector* in, Vector* out, size_t n) const { MatrixSIMD::transformAoS(m, &in->X, &out->X, n, 0.0f); }
+    void transformPoints( const float* inX, const float* inY, const float* inZ,
+                          float* outX, float* outY, float* outZ, size_t n) const
+    {
+        MatrixSIMD::transformSoA(m, inX, inY, inZ, outX, outY, outZ, n, 1.0f);
+    }
+    void transformDirections( const float* inX, const float* inY, const float* inZ,
+                              float* outX, float* outY, float* outZ, size_t n) const
+    {
+        MatrixSIMD::transformSoA(m, inX, inY, inZ, outX, outY, outZ, n, 0.0f);
+    }
     float determinat();
 };
 
+inline Matrix Matrix::operator*(const Matrix& M) const
+{
+    Matrix Out;
+    MatrixSIMD::multiply(m, M.m, Out.m);
+    return Out;
+}
+
+inline Matrix& Matrix::translation(float X, float Y, float Z )
+{
+    m00= 1;	m01= 0;	m02= 0;	m03= X;
+    m10= 0;	m11= 1;	m12= 0;	m13= Y;
+    m20= 0;	m21= 0;	m22= 1;	m23= Z;
+    m30= 0;	m31= 0;	m32= 0;	m33= 1;
+    return *this;
+}
+
+inline Matrix& Matrix::scale(float ScaleX, float ScaleY, float ScaleZ )
+{
+    m00= ScaleX;	m01= 0;			m02= 0;			m03= 0;
+    m10= 0;			m11= ScaleY;	m12= 0;			m13= 0;
+    m20= 0;			m21= 0;			m22= ScaleZ;	m23= 0;
+    m30= 0;			m31= 0;			m32= 0;			m33= 1;
+    return *this;
+}
+
+inline Vector Matrix::transformVec4x4( const Vector& v) const
+{
+    const float X = m00*v.X + m01*v.Y + m02*v.Z + m03;
+    const float Y = m10*v.X + m11*v.Y + m12*v.Z + m13;
+    const float Z = m20*v.X + m21*v.Y + m22*v.Z + m23;
+    const float W = m30*v.X + m31*v.Y + m32*v.Z + m33;
+    return Vector( X/W, Y/W, Z/W);
+}
+
+static_assert(sizeof(Matrix) == 16 * sizeof(float), "Matrix must be 16 packed floats");
+static_assert(std::is_standard_layout<Matrix>::value, "Matrix must have standard layout");
+static_assert(std::is_trivially_copyable<Matrix>::value, "Matrix must be trivially copyable");
+static_assert(std::is_nothrow_move_constructible<Matrix>::value, "Matrix moves must not throw");
+
 
 #endif /* defined(__RealtimeRending__Matrix__) */
@@ -0,0 +1,515 @@
+#include "MatrixSIMD.h"
+#include <string.h>
+
+#ifdef MATRIX_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+MatrixSIMD::BinaryFn MatrixSIMD::Multiply = MatrixSIMD::multiplyInit;
+MatrixSIMD::BinaryFn MatrixSIMD::Transform = MatrixSIMD::transformInit;
+MatrixSIMD::UnaryFn MatrixSIMD::Invert = MatrixSIMD::invertInit;
+MatrixSIMD::UnaryFn MatrixSIMD::InvertAffine = MatrixSIMD::invertAffineInit;
+MatrixSIMD::UnaryFn MatrixSIMD::InvertRigid = MatrixSIMD::invertRigidInit;
+MatrixSIMD::AoSFn MatrixSIMD::TransformAoS = MatrixSIMD::transformAoSInit;
+MatrixSIMD::SoAFn MatrixSIMD::TransformSoA = MatrixSIMD::transformSoAInit;
+int MatrixSIMD::Active = -1;
+
+// ---------------------------------------------------------------------------
+// Skalar
+
+void MatrixSIMD::multiplyScalar(const float* A, const float* B, float* Out)
+{
+    float Tmp[16];
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            Tmp[c*4+r] = A[r] * B[c*4] + A[4+r] * B[c*4+1] + A[8+r] * B[c*4+2] + A[12+r] * B[c*4+3];
+    memcpy(Out, Tmp, sizeof(Tmp));
+}
+
+void MatrixSIMD::transformScalar(const float* M, const float* In, float* Out)
+{
+    const float x = In[0], y = In[1], z = In[2], w = In[3];
+    Out[0] = M[0] * x + M[4] * y + M[8] * z + M[12] * w;
+    Out[1] = M[1] * x + M[5] * y + M[9] * z + M[13] * w;
+    Out[2] = M[2] * x + M[6] * y + M[10] * z + M[14] * w;
+    Out[3] = M[3] * x + M[7] * y + M[11] * z + M[15] * w;
+}
+
+void MatrixSIMD::invertScalar(const float* M, float* Out)
+{
+    // Kofaktoren, vormals Matrix::invert (numRC = Element Zeile R, Spalte C)
+    const float num5 = M[0];
+    const float num4 = M[4];
+    const float num3 = M[8];
+    const float num2 = M[12];
+    const float num9 = M[1];
+    const float num8 = M[5];
+    const float num7 = M[9];
+    const float num6 = M[13];
+    const float num17 = M[2];
+    const float num16 = M[6];
+    const float num15 = M[10];
+    const float num14 = M[14];
+    const float num13 = M[3];
+    const float num12 = M[7];
+    const float num11 = M[11];
+    const float num10 = M[15];
+    const float num23 = (num15 * num10) - (num14 * num11);
+    const float num22 = (num16 * num10) - (num14 * num12);
+    const float num21 = (num16 * num11) - (num15 * num12);
+    const float num20 = (num17 * num10) - (num14 * num13);
+    const float num19 = (num17 * num11) - (num15 * num13);
+    const float num18 = (num17 * num12) - (num16 * num13);
+    const float num39 = ((num8 * num23) - (num7 * num22)) + (num6 * num21);
+    const float num38 = -(((num9 * num23) - (num7 * num20)) + (num6 * num19));
+    const float num37 = ((num9 * num22) - (num8 * num20)) + (num6 * num18);
+    const float num36 = -(((num9 * num21) - (num8 * num19)) + (num7 * num18));
+    const float num = (float)1 / ((((num5 * num39) + (num4 * num38)) + (num3 * num37)) + (num2 * num36));
+    float Tmp[16];
+    Tmp[0] = num39 * num;
+    Tmp[1] = num38 * num;
+    Tmp[2] = num37 * num;
+    Tmp[3] = num36 * num;
+    Tmp[4] = -(((num4 * num23) - (num3 * num22)) + (num2 * num21)) * num;
+    Tmp[5] = (((num5 * num23) - (num3 * num20)) + (num2 * num19)) * num;
+    Tmp[6] = -(((num5 * num22) - (num4 * num20)) + (num2 * num18)) * num;
+    Tmp[7] = (((num5 * num21) - (num4 * num19)) + (num3 * num18)) * num;
+    const float num35 = (num7 * num10) - (num6 * num11);
+    const float num34 = (num8 * num10) - (num6 * num12);
+    const float num33 = (num8 * num11) - (num7 * num12);
+    const float num32 = (num9 * num10) - (num6 * num13);
+    const float num31 = (num9 * num11) - (num7 * num13);
+    const float num30 = (num9 * num12) - (num8 * num13);
+    Tmp[8] = (((num4 * num35) - (num3 * num34)) + (num2 * num33)) * num;
+    Tmp[9] = -(((num5 * num35) - (num3 * num32)) + (num2 * num31)) * num;
+    Tmp[10] = (((num5 * num34) - (num4 * num32)) + (num2 * num30)) * num;
+    Tmp[11] = -(((num5 * num33) - (num4 * num31)) + (num3 * num30)) * num;
+    const float num29 = (num7 * num14) - (num6 * num15);
+    const float num28 = (num8 * num14) - (num6 * num16);
+    const float num27 = (num8 * num15) - (num7 * num16);
+    const float num26 = (num9 * num14) - (num6 * num17);
+    const float num25 = (num9 * num15) - (num7 * num17);
+    const float num24 = (num9 * num16) - (num8 * num17);
+    Tmp[12] = -(((num4 * num29) - (num3 * num28)) + (num2 * num27)) * num;
+    Tmp[13] = (((num5 * num29) - (num3 * num26)) + (num2 * num25)) * num;
+    Tmp[14] = -(((num5 * num28) - (num4 * num26)) + (num2 * num24)) * num;
+    Tmp[15] = (((num5 * num27) - (num4 * num25)) + (num3 * num24)) * num;
+    memcpy(Out, Tmp, sizeof(Tmp));
+}
+
+void MatrixSIMD::invertAffineScalar(const float* M, float* Out)
+{
+    // Zeilen der Inversen = Kreuzprodukte der Spalten / Determinante
+    const float a[3] = { M[0], M[1], M[2] };
+    const float b[3] = { M[4], M[5], M[6] };
+    const float c[3] = { M[8], M[9], M[10] };
+    const float t[3] = { M[12], M[13], M[14] };
+    float r0[3] = { b[1]*c[2] - b[2]*c[1], b[2]*c[0] - b[0]*c[2], b[0]*c[1] - b[1]*c[0] };
+    float r1[3] = { c[1]*a[2] - c[2]*a[1], c[2]*a[0] - c[0]*a[2], c[0]*a[1] - c[1]*a[0] };
+    float r2[3] = { a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0] };
+    const float InvDet = 1.0f / (a[0]*r0[0] + a[1]*r0[1] + a[2]*r0[2]);
+    for (int i = 0; i < 3; ++i) {
+        r0[i] *= InvDet;
+        r1[i] *= InvDet;
+        r2[i] *= InvDet;
+    }
+    Out[0] = r0[0]; Out[4] = r0[1]; Out[8] = r0[2];  Out[12] = -(r0[0]*t[0] + r0[1]*t[1] + r0[2]*t[2]);
+    Out[1] = r1[0]; Out[5] = r1[1]; Out[9] = r1[2];  Out[13] = -(r1[0]*t[0] + r1[1]*t[1] + r1[2]*t[2]);
+    Out[2] = r2[0]; Out[6] = r2[1]; Out[10] = r2[2]; Out[14] = -(r2[0]*t[0] + r2[1]*t[1] + r2[2]*t[2]);
+    Out[3] = 0;     Out[7] = 0;     Out[11] = 0;     Out[15] = 1;
+}
+
+void MatrixSIMD::invertRigidScalar(const float* M, float* Out)
+{
+    float Tmp[16];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c)
+            Tmp[c*4+r] = M[r*4+c];
+        Tmp[12+r] = -(M[r*4] * M[12] + M[r*4+1] * M[13] + M[r*4+2] * M[14]);
+        Tmp[r*4+3] = 0;
+    }
+    Tmp[15] = 1;
+    memcpy(Out, Tmp, sizeof(Tmp));
+}
+
+void MatrixSIMD::transformAoSScalar(const float* M, const float* In, float* Out, size_t n, float W)
+{
+    for (size_t i = 0; i < n; ++i, In += 3, Out += 3) {
+        const float x = In[0], y = In[1], z = In[2];
+        Out[0] = M[0] * x + M[4] * y + M[8] * z + M[12] * W;
+        Out[1] = M[1] * x + M[5] * y + M[9] * z + M[13] * W;
+        Out[2] = M[2] * x + M[6] * y + M[10] * z + M[14] * W;
+    }
+}
+
+void MatrixSIMD::transformSoAScalar(const float* M, const float* InX, const float* InY, const float* InZ,
+                                    float* OutX, float* OutY, float* OutZ, size_t n, float W)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const float x = InX[i], y = InY[i], z = InZ[i];
+        OutX[i] = M[0] * x + M[4] * y + M[8] * z + M[12] * W;
+        OutY[i] = M[1] * x + M[5] * y + M[9] * z + M[13] * W;
+        OutZ[i] = M[2] * x + M[6] * y + M[10] * z + M[14] * W;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 / AVX
+
+#ifdef MATRIX_SIMD_X86
+
+#define SHUF(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZ(a, x, y, z, w) SHUF(a, a, x, y, z, w)
+
+static void multiplySSE(const float* A, const float* B, float* Out)
+{
+    const __m128 a0 = _mm_loadu_ps(A);
+    const __m128 a1 = _mm_loadu_ps(A + 4);
+    const __m128 a2 = _mm_loadu_ps(A + 8);
+    const __m128 a3 = _mm_loadu_ps(A + 12);
+    __m128 r[4];
+    for (int c = 0; c < 4; ++c) {
+        const __m128 b = _mm_loadu_ps(B + c*4);
+        r[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, SWIZ(b, 0, 0, 0, 0)), _mm_mul_ps(a1, SWIZ(b, 1, 1, 1, 1))),
+                          _mm_add_ps(_mm_mul_ps(a2, SWIZ(b, 2, 2, 2, 2)), _mm_mul_ps(a3, SWIZ(b, 3, 3, 3, 3))));
+    }
+    for (int c = 0; c < 4; ++c)
+        _mm_storeu_ps(Out + c*4, r[c]);
+}
+
+// zwei Ergebnisspalten pro 256-Bit-Register
+MATRIX_SIMD_AVX_TARGET static void multiplyAVX(const float* A, const float* B, float* Out)
+{
+    const __m256 a0 = _mm256_broadcast_ps((const __m128*)A);
+    const __m256 a1 = _mm256_broadcast_ps((const __m128*)(A + 4));
+    const __m256 a2 = _mm256_broadcast_ps((const __m128*)(A + 8));
+    const __m256 a3 = _mm256_broadcast_ps((const __m128*)(A + 12));
+    __m256 r[2];
+    for (int p = 0; p < 2; ++p) {
+        const __m256 b = _mm256_loadu_ps(B + p*8);
+        r[p] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, 0x00)),
+                                           _mm256_mul_ps(a1, _mm256_shuffle_ps(b, b, 0x55))),
+                             _mm256_add_ps(_mm256_mul_ps(a2, _mm256_shuffle_ps(b, b, 0xAA)),
+                                           _mm256_mul_ps(a3, _mm256_shuffle_ps(b, b, 0xFF))));
+    }
+    _mm256_storeu_ps(Out, r[0]);
+    _mm256_storeu_ps(Out + 8, r[1]);
+}
+
+static void transformSSE(const float* M, const float* In, float* Out)
+{
+    const __m128 v = _mm_loadu_ps(In);
+    const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(M), SWIZ(v, 0, 0, 0, 0)),
+                                           _mm_mul_ps(_mm_loadu_ps(M + 4), SWIZ(v, 1, 1, 1, 1))),
+                                _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(M + 8), SWIZ(v, 2, 2, 2, 2)),
+                                           _mm_mul_ps(_mm_loadu_ps(M + 12), SWIZ(v, 3, 3, 3, 3))));
+    _mm_storeu_ps(Out, r);
+}
+
+// 2x2-Bloecke als (x00, x01, x10, x11): A*B, adj(A)*B, A*adj(B)
+static inline __m128 mat2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, SWIZ(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZ(a, 1, 0, 3, 2), SWIZ(b, 2, 1, 2, 1)));
+}
+static inline __m128 mat2AdjMul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SWIZ(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZ(a, 1, 1, 2, 2), SWIZ(b, 2, 3, 0, 1)));
+}
+static inline __m128 mat2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, SWIZ(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZ(a, 1, 0, 3, 2), SWIZ(b, 2, 1, 2, 1)));
+}
+
+// Blockinverse ueber 2x2-Adjunkte. Arbeitet zeilenweise; auf Spalten angewendet
+// invertiert sie die Transponierte und liefert damit wieder Spalten der Inversen.
+static void invertSSE(const float* M, float* Out)
+{
+    const __m128 v0 = _mm_loadu_ps(M);
+    const __m128 v1 = _mm_loadu_ps(M + 4);
+    const __m128 v2 = _mm_loadu_ps(M + 8);
+    const __m128 v3 = _mm_loadu_ps(M + 12);
+
+    const __m128 A = _mm_movelh_ps(v0, v1);
+    const __m128 B = _mm_movehl_ps(v1, v0);
+    const __m128 C = _mm_movelh_ps(v2, v3);
+    const __m128 D = _mm_movehl_ps(v3, v2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 DetSub = _mm_sub_ps(_mm_mul_ps(SHUF(v0, v2, 0, 2, 0, 2), SHUF(v1, v3, 1, 3, 1, 3)),
+                                     _mm_mul_ps(SHUF(v0, v2, 1, 3, 1, 3), SHUF(v1, v3, 0, 2, 0, 2)));
+    const __m128 DetA = SWIZ(DetSub, 0, 0, 0, 0);
+    const __m128 DetB = SWIZ(DetSub, 1, 1, 1, 1);
+    const __m128 DetC = SWIZ(DetSub, 2, 2, 2, 2);
+    const __m128 DetD = SWIZ(DetSub, 3, 3, 3, 3);
+
+    const __m128 D_C = mat2AdjMul(D, C);
+    const __m128 A_B = mat2AdjMul(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(DetD, A), mat2Mul(B, D_C));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(DetA, D), mat2Mul(C, A_B));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(DetB, C), mat2MulAdj(D, A_B));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(DetC, B), mat2MulAdj(A, D_C));
+
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    __m128 Tr = _mm_mul_ps(A_B, SWIZ(D_C, 0, 2, 1, 3));
+    Tr = _mm_add_ps(Tr, SWIZ(Tr, 2, 3, 0, 1));
+    Tr = _mm_add_ps(Tr, SWIZ(Tr, 1, 0, 3, 2));
+    const __m128 DetM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(DetA, DetD), _mm_mul_ps(DetB, DetC)), Tr);
+    const __m128 RDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), DetM);
+
+    X = _mm_mul_ps(X, RDetM);
+    Y = _mm_mul_ps(Y, RDetM);
+    Z = _mm_mul_ps(Z, RDetM);
+    W = _mm_mul_ps(W, RDetM);
+
+    _mm_storeu_ps(Out, SHUF(X, Y, 3, 1, 3, 1));
+    _mm_storeu_ps(Out + 4, SHUF(X, Y, 2, 0, 2, 0));
+    _mm_storeu_ps(Out + 8, SHUF(Z, W, 3, 1, 3, 1));
+    _mm_storeu_ps(Out + 12, SHUF(Z, W, 2, 0, 2, 0));
+}
+
+static inline __m128 cross(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SWIZ(a, 1, 2, 0, 3), SWIZ(b, 2, 0, 1, 3)),
+                      _mm_mul_ps(SWIZ(a, 2, 0, 1, 3), SWIZ(b, 1, 2, 0, 3)));
+}
+
+// Inverse aus den Zeilen r0..r2 (als Register) und der Translation t
+static inline void storeAffine(__m128 r0, __m128 r1, __m128 r2, __m128 t, float* Out)
+{
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    // jetzt Spalten; t' = -(c0*t.x + c1*t.y + c2*t.z), w = 1
+    __m128 tt = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, SWIZ(t, 0, 0, 0, 0)), _mm_mul_ps(r1, SWIZ(t, 1, 1, 1, 1))),
+                           _mm_mul_ps(r2, SWIZ(t, 2, 2, 2, 2)));
+    tt = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), tt);
+    _mm_storeu_ps(Out, r0);
+    _mm_storeu_ps(Out + 4, r1);
+    _mm_storeu_ps(Out + 8, r2);
+    _mm_storeu_ps(Out + 12, tt);
+}
+
+static void invertAffineSSE(const float* M, float* Out)
+{
+    // w-Komponente der Spalten 0..2 ist bei affinen Matrizen 0 und bleibt es im Kreuzprodukt
+    const __m128 a = _mm_loadu_ps(M);
+    const __m128 b = _mm_loadu_ps(M + 4);
+    const __m128 c = _mm_loadu_ps(M + 8);
+    const __m128 t = _mm_loadu_ps(M + 12);
+    __m128 r0 = cross(b, c);
+    __m128 r1 = cross(c, a);
+    __m128 r2 = cross(a, b);
+    __m128 Det = _mm_mul_ps(a, r0);
+    Det = _mm_add_ps(Det, SWIZ(Det, 1, 0, 3, 2));
+    Det = _mm_add_ps(Det, SWIZ(Det, 2, 3, 0, 1));
+    const __m128 InvDet = _mm_div_ps(_mm_set1_ps(1.0f), Det);
+    storeAffine(_mm_mul_ps(r0, InvDet), _mm_mul_ps(r1, InvDet), _mm_mul_ps(r2, InvDet), t, Out);
+}
+
+static void invertRigidSSE(const float* M, float* Out)
+{
+    // Zeilen der Inversen = Spalten der Eingabe
+    const __m128 Mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    storeAffine(_mm_and_ps(_mm_loadu_ps(M), Mask), _mm_and_ps(_mm_loadu_ps(M + 4), Mask),
+                _mm_and_ps(_mm_loadu_ps(M + 8), Mask), _mm_loadu_ps(M + 12), Out);
+}
+
+// vier Punkte xyz xyz xyz xyz in drei Registern <-> je ein Register pro Komponente
+static void transformAoSSSE(const float* M, const float* In, float* Out, size_t n, float W)
+{
+    const __m128 m0 = _mm_set1_ps(M[0]), m1 = _mm_set1_ps(M[1]), m2 = _mm_set1_ps(M[2]);
+    const __m128 m4 = _mm_set1_ps(M[4]), m5 = _mm_set1_ps(M[5]), m6 = _mm_set1_ps(M[6]);
+    const __m128 m8 = _mm_set1_ps(M[8]), m9 = _mm_set1_ps(M[9]), m10 = _mm_set1_ps(M[10]);
+    const __m128 tx = _mm_set1_ps(M[12] * W), ty = _mm_set1_ps(M[13] * W), tz = _mm_set1_ps(M[14] * W);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4, In += 12, Out += 12) {
+        const __m128 a = _mm_loadu_ps(In);     // x0 y0 z0 x1
+        const __m128 b = _mm_loadu_ps(In + 4); // y1 z1 x2 y2
+        const __m128 c = _mm_loadu_ps(In + 8); // z2 x3 y3 z3
+        const __m128 x = SHUF(a, SHUF(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        const __m128 y = SHUF(SHUF(a, b, 1, 1, 0, 0), SHUF(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        const __m128 z = SHUF(SHUF(a, b, 2, 2, 1, 1), SWIZ(c, 0, 0, 3, 3), 0, 2, 0, 2);
+
+        const __m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), tx));
+        const __m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), ty));
+        const __m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), tz));
+
+        _mm_storeu_ps(Out, SHUF(SHUF(X, Y, 0, 0, 0, 0), SHUF(Z, X, 0, 0, 1, 1), 0, 2, 0, 2));
+        _mm_storeu_ps(Out + 4, SHUF(SHUF(Y, Z, 1, 1, 1, 1), SHUF(X, Y, 2, 2, 2, 2), 0, 2, 0, 2));
+        _mm_storeu_ps(Out + 8, SHUF(SHUF(Z, X, 2, 2, 3, 3), SHUF(Y, Z, 3, 3, 3, 3), 0, 2, 0, 2));
+    }
+    MatrixSIMD::transformAoSScalar(M, In, Out, n - i, W);
+}
+
+static void transformSoASSE(const float* M, const float* InX, const float* InY, const float* InZ,
+                            float* OutX, float* OutY, float* OutZ, size_t n, float W)
+{
+    const __m128 m0 = _mm_set1_ps(M[0]), m1 = _mm_set1_ps(M[1]), m2 = _mm_set1_ps(M[2]);
+    const __m128 m4 = _mm_set1_ps(M[4]), m5 = _mm_set1_ps(M[5]), m6 = _mm_set1_ps(M[6]);
+    const __m128 m8 = _mm_set1_ps(M[8]), m9 = _mm_set1_ps(M[9]), m10 = _mm_set1_ps(M[10]);
+    const __m128 tx = _mm_set1_ps(M[12] * W), ty = _mm_set1_ps(M[13] * W), tz = _mm_set1_ps(M[14] * W);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_loadu_ps(InX + i), y = _mm_loadu_ps(InY + i), z = _mm_loadu_ps(InZ + i);
+        _mm_storeu_ps(OutX + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), tx)));
+        _mm_storeu_ps(OutY + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), ty)));
+        _mm_storeu_ps(OutZ + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), tz)));
+    }
+    MatrixSIMD::transformSoAScalar(M, InX + i, InY + i, InZ + i, OutX + i, OutY + i, OutZ + i, n - i, W);
+}
+
+MATRIX_SIMD_AVX_TARGET static void transformSoAAVX(const float* M, const float* InX, const float* InY, const float* InZ,
+                                                   float* OutX, float* OutY, float* OutZ, size_t n, float W)
+{
+    const __m256 m0 = _mm256_set1_ps(M[0]), m1 = _mm256_set1_ps(M[1]), m2 = _mm256_set1_ps(M[2]);
+    const __m256 m4 = _mm256_set1_ps(M[4]), m5 = _mm256_set1_ps(M[5]), m6 = _mm256_set1_ps(M[6]);
+    const __m256 m8 = _mm256_set1_ps(M[8]), m9 = _mm256_set1_ps(M[9]), m10 = _mm256_set1_ps(M[10]);
+    const __m256 tx = _mm256_set1_ps(M[12] * W), ty = _mm256_set1_ps(M[13] * W), tz = _mm256_set1_ps(M[14] * W);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x = _mm256_loadu_ps(InX + i), y = _mm256_loadu_ps(InY + i), z = _mm256_loadu_ps(InZ + i);
+        _mm256_storeu_ps(OutX + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m4, y)), _mm256_add_ps(_mm256_mul_ps(m8, z), tx)));
+        _mm256_storeu_ps(OutY + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, x), _mm256_mul_ps(m5, y)), _mm256_add_ps(_mm256_mul_ps(m9, z), ty)));
+        _mm256_storeu_ps(OutZ + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, x), _mm256_mul_ps(m6, y)), _mm256_add_ps(_mm256_mul_ps(m10, z), tz)));
+    }
+    MatrixSIMD::transformSoAScalar(M, InX + i, InY + i, InZ + i, OutX + i, OutY + i, OutZ + i, n - i, W);
+}
+
+static bool cpuHasAVX()
+{
+    unsigned int Regs[4] = { 0, 0, 0, 0 };
+#ifdef _MSC_VER
+    int Info[4];
+    __cpuid(Info, 1);
+    for (int i = 0; i < 4; ++i) Regs[i] = (unsigned int)Info[i];
+#else
+    if (!__get_cpuid(1, &Regs[0], &Regs[1], &Regs[2], &Regs[3]))
+        return false;
+#endif
+    const bool OSXSave = (Regs[2] & (1u << 27)) != 0;
+    const bool AVXBit = (Regs[2] & (1u << 28)) != 0;
+    if (!OSXSave || !AVXBit)
+        return false;
+    // Betriebssystem muss die YMM-Register sichern (XCR0 Bits 1 und 2)
+#ifdef _MSC_VER
+    const unsigned long long XCR0 = _xgetbv(0);
+#else
+    unsigned int Lo, Hi;
+    __asm__ volatile("xgetbv" : "=a"(Lo), "=d"(Hi) : "c"(0));
+    const unsigned long long XCR0 = ((unsigned long long)Hi << 32) | Lo;
+#endif
+    return (XCR0 & 6) == 6;
+}
+
+#endif // MATRIX_SIMD_X86
+
+// ---------------------------------------------------------------------------
+// Auswahl
+
+MatrixSIMD::ISA MatrixSIMD::detected()
+{
+#ifdef MATRIX_SIMD_X86
+    static const ISA Level = cpuHasAVX() ? AVX : SSE2;
+    return Level;
+#else
+    return SCALAR;
+#endif
+}
+
+MatrixSIMD::ISA MatrixSIMD::active()
+{
+    if (Active < 0)
+        select(detected());
+    return (ISA)Active;
+}
+
+void MatrixSIMD::force(ISA Level)
+{
+    select(Level < detected() ? Level : detected());
+}
+
+const char* MatrixSIMD::name(ISA Level)
+{
+    switch (Level) {
+        case SSE2: return "SSE2";
+        case AVX: return "AVX";
+        default: return "Skalar";
+    }
+}
+
+void MatrixSIMD::select(ISA Level)
+{
+    Multiply = multiplyScalar;
+    Transform = transformScalar;
+    Invert = invertScalar;
+    InvertAffine = invertAffineScalar;
+    InvertRigid = invertRigidScalar;
+    TransformAoS = transformAoSScalar;
+    TransformSoA = transformSoAScalar;
+#ifdef MATRIX_SIMD_X86
+    if (Level >= SSE2) {
+        Multiply = multiplySSE;
+        Transform = transformSSE;
+        Invert = invertSSE;
+        InvertAffine = invertAffineSSE;
+        InvertRigid = invertRigidSSE;
+        TransformAoS = transformAoSSSE;
+        TransformSoA = transformSoASSE;
+    }
+    // 4x4 passt in SSE-Register; AVX lohnt beim Produkt (zwei Spalten pro Befehl) und
+    // bei SoA (8 Vektoren pro Schritt). AoS bleibt bei 4: das Umsortieren kostet mehr.
+    if (Level >= AVX) {
+        Multiply = multiplyAVX;
+        TransformSoA = transformSoAAVX;
+    }
+#endif
+    Active = Level;
+}
+
+void MatrixSIMD::multiplyInit(const float* A, const float* B, float* Out)
+{
+    active();
+    Multiply(A, B, Out);
+}
+
+void MatrixSIMD::transformInit(const float* M, const float* In, float* Out)
+{
+    active();
+    Transform(M, In, Out);
+}
+
+void MatrixSIMD::invertInit(const float* M, float* Out)
+{
+    active();
+    Invert(M, Out);
+}
+
+void MatrixSIMD::invertAffineInit(const float* M, float* Out)
+{
+    active();
+    InvertAffine(M, Out);
+}
+
+void MatrixSIMD::invertRigidInit(const float* M, float* Out)
+{
+    active();
+    InvertRigid(M, Out);
+}
+
+void MatrixSIMD::transformAoSInit(const float* M, const float* In, float* Out, size_t n, float W)
+{
+    active();
+    TransformAoS(M, In, Out, n, W);
+}
+
+void MatrixSIMD::transformSoAInit(const float* M, const float* InX, const float* InY, const float* InZ,
+                                  float* OutX, float* OutY, float* OutZ, size_t n, float W)
+{
+    active();
+    TransformSoA(M, InX, InY, InZ, OutX, OutY, OutZ, n, W);
+}
@@ -0,0 +1,107 @@
+#ifndef MatrixSIMD_hpp
+#define MatrixSIMD_hpp
+
+#include <stddef.h>
+
+// x86-64: SSE2 immer vorhanden, AVX-Funktionen werden einzeln fuer AVX uebersetzt
+// und nur nach MatrixSIMD::active() >= AVX aufgerufen
+#if defined(__x86_64__) || defined(_M_X64)
+#define MATRIX_SIMD_X86 1
+#ifdef _MSC_VER
+#define MATRIX_SIMD_AVX_TARGET
+#else
+#define MATRIX_SIMD_AVX_TARGET __attribute__((target("avx")))
+#endif
+#endif
+
+// SIMD-Kerne fuer Matrix. Alle Funktionen arbeiten auf float[16] in der Speicherordnung
+// von Matrix::m (spaltenweise, m[12..14] = Translation). SSE2 gehoert zu x86-64 und
+// wird immer genutzt; AVX wird beim ersten Aufruf per CPUID erkannt. Auf anderen
+// Architekturen (z.B. ARM) laufen die Skalar-Versionen.
+// Ausgabe darf auf eine der Eingaben zeigen.
+class MatrixSIMD
+{
+public:
+    enum ISA
+    {
+        SCALAR = 0,
+        SSE2 = 1,
+        AVX = 2
+    };
+
+    // beste von CPU und Betriebssystem unterstuetzte Stufe
+    static ISA detected();
+    // aktuell benutzte Stufe; force() begrenzt sie (Vergleichsmessungen), hoeher als
+    // detected() geht nicht
+    static ISA active();
+    static void force(ISA Level);
+    static const char* name(ISA Level);
+
+    // Out = A * B
+    static void multiply(const float* A, const float* B, float* Out);
+    // Out = M * (x, y, z, w), ohne Division durch w
+    static void transform(const float* M, const float* In, float* Out);
+    // allgemeine Inverse; singulaere Matrizen liefern inf/nan wie bisher Matrix::invert
+    static void invert(const float* M, float* Out);
+    // letzte Zeile (0,0,0,1): 3x3-Inverse ueber Kreuzprodukte + Translation
+    static void invertAffine(const float* M, float* Out);
+    // zusaetzlich orthonormale 3x3 (nur Drehung + Translation): Transponieren reicht
+    static void invertRigid(const float* M, float* Out);
+
+    // n Vektoren mit w = W (1 = Punkte, 0 = Richtungen), ohne Division durch w.
+    // AoS: x,y,z hintereinander (3n floats, z.B. ein Vector-Array), 4 pro Schritt.
+    static void transformAoS(const float* M, const float* In, float* Out, size_t n, float W);
+    // SoA: ein Array pro Komponente, 4 (SSE2) bzw. 8 (AVX) pro Schritt
+    static void transformSoA(const float* M, const float* InX, const float* InY, const float* InZ,
+                             float* OutX, float* OutY, float* OutZ, size_t n, float W);
+
+    // Referenz-Implementierungen, z.B. fuer Tests der SIMD-Pfade
+    static void multiplyScalar(const float* A, const float* B, float* Out);
+    static void transformScalar(const float* M, const float* In, float* Out);
+    static void invertScalar(const float* M, float* Out);
+    static void invertAffineScalar(const float* M, float* Out);
+    static void invertRigidScalar(const float* M, float* Out);
+    static void transformAoSScalar(const float* M, const float* In, float* Out, size_t n, float W);
+    static void transformSoAScalar(const float* M, const float* InX, const float* InY, const float* InZ,
+                                   float* OutX, float* OutY, float* OutZ, size_t n, float W);
+
+protected:
+    typedef void (*BinaryFn)(const float*, const float*, float*);
+    typedef void (*UnaryFn)(const float*, float*);
+    typedef void (*AoSFn)(const float*, const float*, float*, size_t, float);
+    typedef void (*SoAFn)(const float*, const float*, const float*, const float*, float*, float*, float*, size_t, float);
+
+    static void select(ISA Level);
+    // erste Aufrufe landen hier: Stufe bestimmen, Zeiger setzen, weiterreichen
+    static void multiplyInit(const float* A, const float* B, float* Out);
+    static void transformInit(const float* M, const float* In, float* Out);
+    static void invertInit(const float* M, float* Out);
+    static void invertAffineInit(const float* M, float* Out);
+    static void invertRigidInit(const float* M, float* Out);
+    static void transformAoSInit(const float* M, const float* In, float* Out, size_t n, float W);
+    static void transformSoAInit(const float* M, const float* InX, const float* InY, const float* InZ,
+                                 float* OutX, float* OutY, float* OutZ, size_t n, float W);
+
+    static BinaryFn Multiply;
+    static BinaryFn Transform;
+    static UnaryFn Invert;
+    static UnaryFn InvertAffine;
+    static UnaryFn InvertRigid;
+    static AoSFn TransformAoS;
+    static SoAFn TransformSoA;
+    static int Active; // -1 = noch nicht bestimmt
+};
+
+inline void MatrixSIMD::multiply(const float* A, const float* B, float* Out) { Multiply(A, B, Out); }
+inline void MatrixSIMD::transform(const float* M, const float* In, float* Out) { Transform(M, In, Out); }
+inline void MatrixSIMD::invert(const float* M, float* Out) { Invert(M, Out); }
+inline void MatrixSIMD::invertAffine(const float* M, float* Out) { InvertAffine(M, Out); }
+inline void MatrixSIMD::invertRigid(const float* M, float* Out) { InvertRigid(M, Out); }
+inline void MatrixSIMD::transformAoS(const float* M, const float* In, float* Out, size_t n, float W) { TransformAoS(M, In, Out, n, W); }
+inline void MatrixSIMD::transformSoA(const float* M, const float* InX, const float* InY, const float* InZ,
+                                     float* OutX, float* OutY, float* OutZ, size_t n, float W)
+{
+    TransformSoA(M, InX, InY, InZ, OutX, OutY, OutZ, n, W);
+}
+
+#endif /* MatrixSIMD_hpp */
@@ -7,16 +7,19 @@
 //
 
 #include "Model.h"
+#include "GLDispatch.h"
 #include "phongshader.h"
+#include "DepthShader.h"
+#include "UniformBlocks.h"
 #include <list>
 #include <float.h>
 #include <sstream>
 
-Model::Model() : pMeshes(NULL), MeshCount(0), pMaterials(NULL), MaterialCount(0)
+Model::Model() : pMeshes(NULL), MeshCount(0), pMaterials(NULL), MaterialCount(0), pPhong(NULL)
 {
     
 }
-Model::Model(const char* ModelFile, bool FitSize) : pMeshes(NULL), MeshCount(0), pMaterials(NULL), MaterialCount(0)
+Model::Model(const char* ModelFile, bool FitSize) : pMeshes(NULL), MeshCount(0), pMaterials(NULL), MaterialCount(0), pPhong(NULL)
 {
     bool ret = load(ModelFile);
     if(!ret)
@@ -62,6 +65,7 @@ bool Model::load(const char* ModelFile, bool FitSize)
     loadMeshes(pScene, FitSize);
     loadMaterials(pScene);
     loadNodes(pScene);
+    calcCullBounds();
     
     return true;
 }
@@ -168,6 +172,7 @@ void Model::loadMaterials(const aiScene* pScene)
         aiColor3D tmpColor;
 
         this->pMaterials[pos].DiffTex = Texture::defaultTex();
+        bool HasTexture = false;
 
         for (int j = 0; j < tmpMat->GetTextureCount(aiTextureType_DIFFUSE); j++) {
             aiString path;
@@ -178,6 +183,7 @@ void Model::loadMaterials(const aiScene* pScene)
             ss << Path << path.data << std::ends;
             fileFullPathDiffTex = ss.str();
             this->pMaterials[pos].DiffTex = Texture::LoadShared(fileFullPathDiffTex.c_str());
+            HasTexture = this->pMaterials[pos].DiffTex != NULL;
         }
 
         tmpMat->Get(AI_MATKEY_COLOR_AMBIENT, tmpColor);
@@ -193,6 +199,17 @@ void Model::loadMaterials(const aiScene* pScene)
         tmpMat->Get(AI_MATKEY_SHININESS, shiny);
         pMaterials[pos].SpecExp = shiny;
 
+        // nur die Features einschalten, die das Material wirklich braucht;
+        // die Farben stehen einmalig in der Materialtabelle, pro Draw nur noch der Index
+        Material& m = pMaterials[pos];
+        m.BlockIndex = UniformBlocks::material(m.DiffColor, m.SpecColor, m.SpecExp, m.AmbColor);
+        m.Features = PhongShader::MATERIAL_BLOCK;
+        if(HasTexture)
+            m.Features |= PhongShader::TEXTURE;
+        if(HasTexture && m.DiffTex->hasAlpha())
+            m.Features |= PhongShader::ALPHA_TEST;
+        if(m.SpecExp > 0.0f && (m.SpecColor.R > 0.0f || m.SpecColor.G > 0.0f || m.SpecColor.B > 0.0f))
+            m.Features |= PhongShader::SPECULAR;
     }
 }
 
@@ -252,23 +269,35 @@ void Model::copyNodesRecursive(const aiNode* paiNode, Node* pNode)
 
 void Model::applyMaterial( unsigned int index)
 {
-    if(index>=MaterialCount)
+    if(index>=MaterialCount || !pPhong)
         return;
     
-    PhongShader* pPhong = dynamic_cast<PhongShader*>(shader());
-    if(!pPhong) {
-        std::cout << "Model::applyMaterial(): WARNING Invalid shader-type. Please apply PhongShader for rendering models.\n";
-        return;
+    const Material* pMat = &pMaterials[index];
+    if(pPhong->hasVariants())
+    {
+        pPhong->features(pMat->Features | (pPhong->features() & PhongShader::SHADER_FEATURES));
+        pPhong->materialIndex(pMat->BlockIndex);
+    }
+    else
+    {
+        // abgeleiteter Shader mit eigenem Programm: klassische Einzel-Uniforms
+        pPhong->ambientColor(pMat->AmbColor);
+        pPhong->diffuseColor(pMat->DiffColor);
+        pPhong->specularExp(pMat->SpecExp);
+        pPhong->specularColor(pMat->SpecColor);
     }
-    
-    Material* pMat = &pMaterials[index];
-    pPhong->ambientColor(pMat->AmbColor);
-    pPhong->diffuseColor(pMat->DiffColor);
-    pPhong->specularExp(pMat->SpecExp);
-    pPhong->specularColor(pMat->SpecColor);
     pPhong->diffuseTexture(pMat->DiffTex);
 }
 
+void Model::shader(BaseShader* shader, bool deleteOnDestruction)
+{
+    BaseModel::shader(shader, deleteOnDestruction);
+    // einmal hier statt pro Mesh und Frame
+    pPhong = dynamic_cast<PhongShader*>(shader);
+    if(shader && !pPhong)
+        std::cout << "Model::shader(): WARNING Invalid shader-type. Please apply PhongShader for rendering models.\n";
+}
+
 void Model::draw(const BaseCamera& Cam)
 {
     if(!pShader) {
@@ -299,7 +328,7 @@ void Model::draw(const BaseCamera& Cam)
             mesh.IB.activate();
             applyMaterial(mesh.MaterialIdx);
             pShader->activate(Cam);
-            glDrawElements(GL_TRIANGLES, mesh.IB.indexCount(), mesh.IB.indexFormat(), 0);
+            GLDispatch::drawElements(GL_TRIANGLES, mesh.IB.indexCount(), mesh.IB.indexFormat(), 0);
             mesh.IB.deactivate();
             mesh.VB.deactivate();
         }
@@ -310,6 +339,171 @@ void Model::draw(const BaseCamera& Cam)
     }
 }
 
+void Model::submit(RenderQueue& Queue, const BaseCamera& Cam)
+{
+    if(!pShader)
+        return;
+    
+    const bool Variants = pPhong && pPhong->hasVariants();
+    const Vector CamPos = Cam.position();
+    
+    std::list<Node*> DrawNodes;
+    DrawNodes.push_back(&RootNode);
+    
+    while(!DrawNodes.empty())
+    {
+        Node* pNode = DrawNodes.front();
+        
+        if(pNode->Parent != NULL)
+            pNode->GlobalTrans = pNode->Parent->GlobalTrans * pNode->Trans;
+        else
+            pNode->GlobalTrans = transform() * pNode->Trans;
+        
+        const float Depth = (pNode->GlobalTrans.translation() - CamPos).length();
+        for(unsigned int i = 0; i<pNode->MeshCount; ++i )
+        {
+            const unsigned int MeshIdx = pNode->Meshes[i];
+            const Mesh& mesh = pMeshes[MeshIdx];
+            GLuint Program = pShader->program();
+            GLuint TexId = 0;
+            RenderQueue::PASS Pass = RenderQueue::PASS_OPAQUE;
+            if(mesh.MaterialIdx >= 0 && (unsigned int)mesh.MaterialIdx < MaterialCount)
+            {
+                const Material& mat = pMaterials[mesh.MaterialIdx];
+                if(Variants)
+                    Program = pPhong->program(mat.Features | (pPhong->features() & PhongShader::SHADER_FEATURES));
+                if(mat.DiffTex)
+                    TexId = mat.DiffTex->id();
+                if(mat.Features & PhongShader::ALPHA_TEST)
+                    Pass = RenderQueue::PASS_CUTOUT;
+            }
+            if(Variants && (pPhong->features() & PhongShader::SKY))
+                Pass = RenderQueue::PASS_SKY;
+            Queue.submit(Pass, Program, TexId, Depth, this, MeshIdx, pNode->GlobalTrans);
+        }
+        for(unsigned int i = 0; i<pNode->ChildCount; ++i )
+            DrawNodes.push_back(&(pNode->Children[i]));
+        
+        DrawNodes.pop_front();
+    }
+}
+
+void Model::drawItem(const BaseCamera& Cam, const RenderQueue::Item& Item)
+{
+    Mesh& mesh = pMeshes[Item.Index];
+    pShader->modelTransform(Item.Transform);
+    mesh.VB.activate();
+    mesh.IB.activate();
+    applyMaterial(mesh.MaterialIdx);
+    pShader->activate(Cam);
+    GLDispatch::drawElements(GL_TRIANGLES, mesh.IB.indexCount(), mesh.IB.indexFormat(), 0);
+}
+
+void Model::drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader)
+{
+    Mesh& mesh = pMeshes[Item.Index];
+    pDepthShader->modelTransform(Item.Transform);
+    pDepthShader->activate(Cam);
+    mesh.VB.activate();
+    mesh.IB.activate();
+    GLDispatch::drawElements(GL_TRIANGLES, mesh.IB.indexCount(), mesh.IB.indexFormat(), 0);
+}
+
+void Model::calcCullBounds()
+{
+    bool Found = false;
+    AABB Box;
+    std::list<std::pair<Node*, Matrix> > Nodes;
+    Nodes.push_back(std::make_pair(&RootNode, RootNode.Trans));
+    
+    while(!Nodes.empty())
+    {
+        Node* pNode = Nodes.front().first;
+        const Matrix NodeTrans = Nodes.front().second;
+        Nodes.pop_front();
+        
+        for(unsigned int i = 0; i<pNode->MeshCount; ++i )
+        {
+            const std::vector<Vector>& Vertices = pMeshes[pNode->Meshes[i]].VB.vertices();
+            if(Vertices.empty())
+                continue;
+            AABB MeshBox(Vertices[0], Vertices[0]);
+            for(size_t v = 1; v < Vertices.size(); ++v)
+                MeshBox.merge(AABB(Vertices[v], Vertices[v]));
+            MeshBox.transform(NodeTrans);
+            if(Found)
+                Box.merge(MeshBox);
+            else
+                Box = MeshBox;
+            Found = true;
+        }
+        for(unsigned int i = 0; i<pNode->ChildCount; ++i )
+            Nodes.push_back(std::make_pair(&(pNode->Children[i]), NodeTrans * pNode->Children[i].Trans));
+    }
+    
+    if(Found)
+        bounds(Box);
+}
+
+void Model::buildPickTriangles(Mesh& mesh)
+{
+    const std::vector<Vector>& Vertices = mesh.VB.vertices();
+    const std::vector<unsigned int>& Indices = mesh.IB.indices();
+    mesh.PickTris.clear();
+    mesh.PickTris.reserve(Indices.size() / 3);
+    for(size_t i = 0; i + 2 < Indices.size(); i += 3)
+    {
+        if(Indices[i] >= Vertices.size() || Indices[i+1] >= Vertices.size() || Indices[i+2] >= Vertices.size())
+            continue;
+        mesh.PickTris.add(Vertices[Indices[i]], Vertices[Indices[i+1]], Vertices[Indices[i+2]]);
+    }
+}
+
+bool Model::pick(const Vector& Origin, const Vector& Dir, float& T)
+{
+    RayIntersect::Hit Best;
+    Best.T = FLT_MAX;
+    bool Found = false;
+    
+    std::list<Node*> Nodes;
+    Nodes.push_back(&RootNode);
+    
+    while(!Nodes.empty())
+    {
+        Node* pNode = Nodes.front();
+        
+        if(pNode->Parent != NULL)
+            pNode->GlobalTrans = pNode->Parent->GlobalTrans * pNode->Trans;
+        else
+            pNode->GlobalTrans = transform() * pNode->Trans;
+        
+        if(pNode->MeshCount > 0)
+        {
+            // Strahl in den Knotenraum; Dir ohne Normierung, damit T gleich bleibt
+            Matrix Inv = pNode->GlobalTrans;
+            Inv.invertAffine();
+            const Vector LocalOrigin = Inv * Origin;
+            const Vector LocalDir = Inv.transformVec3x3(Dir);
+            for(unsigned int i = 0; i<pNode->MeshCount; ++i )
+            {
+                Mesh& mesh = pMeshes[pNode->Meshes[i]];
+                if(mesh.PickTris.size() == 0)
+                    buildPickTriangles(mesh);
+                if(RayIntersect::closest(LocalOrigin, LocalDir, mesh.PickTris, Best))
+                    Found = true;
+            }
+        }
+        for(unsigned int i = 0; i<pNode->ChildCount; ++i )
+            Nodes.push_back(&(pNode->Children[i]));
+        
+        Nodes.pop_front();
+    }
+    
+    if(Found)
+        T = Best.T;
+    return Found;
+}
+
 Matrix Model::convert(const aiMatrix4x4& m)
 {
     return Matrix(m.a1, m.a2, m.a3, m.a4,
@@ -18,8 +18,11 @@
 #include "indexbuffer.h"
 #include "texture.h"
 #include "aabb.h"
+#include "RayIntersect.h"
 #include <string>
 
+class PhongShader;
+
 class Model : public BaseModel
 {
 public:
@@ -28,8 +31,18 @@ public:
     virtual ~Model();
     
     bool load(const char* ModelFile, bool FitSize=false);
+    // merkt sich den PhongShader (dynamic_cast einmalig statt pro Draw)
+    virtual void shader( BaseShader* shader, bool deleteOnDestruction=false );
+    using BaseModel::shader;
     virtual void draw(const BaseCamera& Cam);
+    // ein Item pro Mesh; Materialien mit Alpha-Textur laufen im Cutout-Pass (Alpha-Test, schreibt Tiefe)
+    virtual void submit(RenderQueue& Queue, const BaseCamera& Cam);
+    virtual void drawItem(const BaseCamera& Cam, const RenderQueue::Item& Item);
+    virtual void drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader);
     const AABB& boundingBox() const { return BoundingBox; }
+    // naechster Schnitt des Strahls (Welt) mit den Dreiecken; T in Einheiten von Dir.
+    // Die Dreiecke je Mesh werden beim ersten Aufruf aus VB/IB aufgebaut.
+    bool pick(const Vector& Origin, const Vector& Dir, float& T);
     
 protected: // protected types
     struct Mesh
@@ -38,15 +51,18 @@ protected: // protected types
         VertexBuffer VB;
         IndexBuffer IB;
         int MaterialIdx;
+        TriangleSoA PickTris; // Modellraum des Knotens, erst bei pick()
     };
     struct Material
     {
-        Material() : DiffTex(NULL), DiffColor(1,1,1),SpecColor(0.3f,0.3f,0.3f), AmbColor(0,0,0), SpecExp(10) {}
+        Material() : DiffColor(1,1,1),SpecColor(0.3f,0.3f,0.3f), AmbColor(0,0,0), SpecExp(10), DiffTex(NULL), Features(0), BlockIndex(0) {}
         Color DiffColor;
         Color SpecColor;
         Color AmbColor;
         float SpecExp;
         const Texture* DiffTex;
+        unsigned int Features; // guenstigste passende PhongShader-Variante
+        unsigned int BlockIndex; // Eintrag in der Materialtabelle (UniformBlocks)
     };
     struct Node
     {
@@ -72,12 +88,16 @@ protected: // protected methods
     Matrix convert(const aiMatrix4x4& m);
     void applyMaterial( unsigned int index);
     void deleteNodes(Node* pNode);
+    void buildPickTriangles(Mesh& mesh);
+    // Culling-Huelle (BaseModel::bounds) aus den Vertices aller Meshes inkl. Knotentransformationen
+    void calcCullBounds();
 
 protected: // protected member variables
     Mesh* pMeshes;
     unsigned int MeshCount;
     Material* pMaterials;
     unsigned int MaterialCount;
+    PhongShader* pPhong; // == pShader, falls es ein PhongShader ist
     AABB BoundingBox;
     
     std::string Filepath; // stores pathname and filename
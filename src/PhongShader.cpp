@@ -7,117 +7,233 @@
 //
 
 #include "PhongShader.h"
+#include "GLDispatch.h"
+#include "UniformBlocks.h"
+#include "ShadowMaps.h"
 
 
 
+// Varianten werden ueber die #defines TEXTURE, SPECULAR, ALPHA_TEST, INSTANCING, SKY und SHADOWS
+// gesteuert (siehe PhongShader::features), daher braucht jede Zeile ein '\n'.
 const char *VertexShaderCode =
 "#version 400\n"
-"layout(location=0) in vec4 VertexPos;"
-"layout(location=1) in vec4 VertexNormal;"
-"layout(location=2) in vec2 VertexTexcoord;"
-"out vec3 Position;"
-"out vec3 Normal;"
-"out vec2 Texcoord;"
-"uniform mat4 ModelMat;"
-"uniform mat4 ModelViewProjMat;"
-"void main()"
-"{"
-"    Position = (ModelMat * VertexPos).xyz;"
-"    Normal =  (ModelMat * VertexNormal).xyz;"
-"    Texcoord = VertexTexcoord;"
-"    gl_Position = ModelViewProjMat * VertexPos;"
-"}";
+"invariant gl_Position;\n"
+UB_FRAME_BLOCK_GLSL "\n"
+UB_OBJECT_BLOCK_GLSL "\n"
+"layout(location=0) in vec4 VertexPos;\n"
+"layout(location=1) in vec4 VertexNormal;\n"
+"layout(location=2) in vec2 VertexTexcoord;\n"
+"#if INSTANCING\n"
+"layout(location=3) in mat4 InstanceMat;\n"
+"#endif\n"
+"out vec3 Position;\n"
+"out vec3 Normal;\n"
+"out vec2 Texcoord;\n"
+"void main()\n"
+"{\n"
+"#if INSTANCING\n"
+"    mat4 M = ModelMat * InstanceMat;\n"
+"#else\n"
+"    mat4 M = ModelMat;\n"
+"#endif\n"
+"    vec4 WorldPos = M * VertexPos;\n"
+"    Position = WorldPos.xyz;\n"
+"    Normal =  (M * VertexNormal).xyz;\n"
+"    Texcoord = VertexTexcoord;\n"
+"    gl_Position = ViewProjMat * WorldPos;\n"
+"#if SKY\n"
+"    gl_Position.z = gl_Position.w; // nach der Division 1.0 = maximale Tiefe\n"
+"#endif\n"
+"}\n";
 
 
 const char *FragmentShaderCode =
 "#version 400\n"
-"uniform vec3 EyePos;"
-"uniform vec3 LightPos;"
-"uniform vec3 LightColor;"
-"uniform vec3 DiffuseColor;"
-"uniform vec3 SpecularColor;"
-"uniform vec3 AmbientColor;"
-"uniform float SpecularExp;"
-"uniform sampler2D DiffuseTexture;"
-"in vec3 Position;"
-"in vec3 Normal;"
-"in vec2 Texcoord;"
-"out vec4 FragColor;"
-"float sat( in float a)"
-"{"
-"    return clamp(a, 0.0, 1.0);"
-"}"
-"void main()"
-"{"
-"    vec4 DiffTex = texture( DiffuseTexture, Texcoord);"
-"    if(DiffTex.a <0.3f) discard;"
-"    vec3 N = normalize(Normal);"
-"    vec3 L = normalize(LightPos-Position);"
-"    vec3 E = normalize(EyePos-Position);"
-"    vec3 R = reflect(-L,N);"
-"    vec3 DiffuseComponent = LightColor * DiffuseColor * sat(dot(N,L));"
-"    vec3 SpecularComponent = LightColor * SpecularColor * pow( sat(dot(R,E)), SpecularExp);"
-"    FragColor = vec4((DiffuseComponent + AmbientColor)*DiffTex.rgb + SpecularComponent ,DiffTex.a);"
-"}";
+UB_FRAME_BLOCK_GLSL "\n"
+"#if MATERIAL_BLOCK\n"
+UB_MATERIAL_BLOCK_GLSL "\n"
+"uniform int MaterialIndex;\n"
+"#define DiffuseColor  Materials[MaterialIndex].Diffuse.rgb\n"
+"#define SpecularColor Materials[MaterialIndex].Specular.rgb\n"
+"#define SpecularExp   Materials[MaterialIndex].Specular.w\n"
+"#define AmbientColor  Materials[MaterialIndex].Ambient.rgb\n"
+"#else\n"
+"uniform vec3 DiffuseColor;\n"
+"uniform vec3 SpecularColor;\n"
+"uniform vec3 AmbientColor;\n"
+"uniform float SpecularExp;\n"
+"#endif\n"
+"#if TEXTURE\n"
+"uniform sampler2D DiffuseTexture;\n"
+"#endif\n"
+"#if SHADOWS\n"
+UB_SHADOW_BLOCK_GLSL "\n"
+SHADOW_LOOKUP_GLSL "\n"
+"#endif\n"
+"in vec3 Position;\n"
+"in vec3 Normal;\n"
+"in vec2 Texcoord;\n"
+"out vec4 FragColor;\n"
+"float sat( in float a)\n"
+"{\n"
+"    return clamp(a, 0.0, 1.0);\n"
+"}\n"
+"void main()\n"
+"{\n"
+"#if TEXTURE\n"
+"    vec4 DiffTex = texture( DiffuseTexture, Texcoord);\n"
+"#else\n"
+"    vec4 DiffTex = vec4(1.0);\n"
+"#endif\n"
+"#if ALPHA_TEST\n"
+"    if(DiffTex.a <0.3f) discard;\n"
+"#endif\n"
+"    vec3 N = normalize(Normal);\n"
+"    vec3 L = normalize(LightPos.xyz-Position);\n"
+"#if SHADOWS\n"
+"    float Shadow = shadowFactor(Position, N);\n"
+"#else\n"
+"    float Shadow = 1.0;\n"
+"#endif\n"
+"    vec3 DiffuseComponent = LightColor.rgb * DiffuseColor * sat(dot(N,L)) * Shadow;\n"
+"#if SPECULAR\n"
+"    vec3 E = normalize(EyePos.xyz-Position);\n"
+"    vec3 R = reflect(-L,N);\n"
+"    vec3 SpecularComponent = LightColor.rgb * SpecularColor * pow( sat(dot(R,E)), SpecularExp) * Shadow;\n"
+"#else\n"
+"    vec3 SpecularComponent = vec3(0.0);\n"
+"#endif\n"
+"    FragColor = vec4((DiffuseComponent + AmbientColor)*DiffTex.rgb + SpecularComponent ,DiffTex.a);\n"
+"}\n";
 
-PhongShader::PhongShader(bool LoadStaticShaderCode) :
+std::map<unsigned int, PhongShader::Variant> PhongShader::Variants;
+
+PhongShader::PhongShader(bool LoadStaticShaderCode, unsigned int InitialFeatures) :
  DiffuseColor(0.8f,0.8f,0.8f),
  SpecularColor(0.5f,0.5f,0.5f),
  AmbientColor(0.2f,0.2f,0.2f),
  SpecularExp(20.0f),
- LightPos(20.0f,20.0f,20.0f),
- LightColor(1,1,1),
  DiffuseTexture(Texture::defaultTex()),
+ MaterialIndex(0),
+ Features(InitialFeatures),
+ pVariant(NULL),
  UpdateState(0xFFFFFFFF)
 {
     if(!LoadStaticShaderCode)
         return;
-    ShaderProgram = createShaderProgram(VertexShaderCode, FragmentShaderCode);
-    assignLocations();
+    selectVariant(InitialFeatures);
+}
+void PhongShader::features(unsigned int f)
+{
+    if(!pVariant)
+    {
+        // Ableitung mit eigenem Shader-Programm (z.B. TerrainShader)
+        std::cout << "WARNING: PhongShader::features() ignored, shader uses its own program." << std::endl;
+        return;
+    }
+    if(f == Features)
+        return;
+    selectVariant(f);
+}
+GLuint PhongShader::program(unsigned int f)
+{
+    return pVariant ? variant(f).Program : ShaderProgram;
+}
+PhongShader::Variant& PhongShader::variant(unsigned int f)
+{
+    std::map<unsigned int, Variant>::iterator it = Variants.find(f);
+    if(it != Variants.end())
+        return it->second;
+    
+    std::string Defines;
+    Defines += (f&TEXTURE) ? "#define TEXTURE 1\n" : "#define TEXTURE 0\n";
+    Defines += (f&SPECULAR) ? "#define SPECULAR 1\n" : "#define SPECULAR 0\n";
+    Defines += (f&ALPHA_TEST) ? "#define ALPHA_TEST 1\n" : "#define ALPHA_TEST 0\n";
+    Defines += (f&INSTANCING) ? "#define INSTANCING 1\n" : "#define INSTANCING 0\n";
+    Defines += (f&SKY) ? "#define SKY 1\n" : "#define SKY 0\n";
+    Defines += (f&MATERIAL_BLOCK) ? "#define MATERIAL_BLOCK 1\n" : "#define MATERIAL_BLOCK 0\n";
+    Defines += (f&SHADOWS) ? "#define SHADOWS 1\n" : "#define SHADOWS 0\n";
+    
+    // createShaderProgram setzt die Modelmatrix zurueck, die aktuelle Variante bleibt unberuehrt
+    const Matrix SavedTransform = ModelTransform;
+    Variant v;
+    v.Program = createShaderProgram(injectDefines(VertexShaderCode, Defines.c_str()).c_str(),
+                                    injectDefines(FragmentShaderCode, Defines.c_str()).c_str());
+    ModelTransform = SavedTransform;
+    v.DiffuseColorLoc = GLDispatch::getUniformLocation(v.Program, "DiffuseColor");
+    v.AmbientColorLoc = GLDispatch::getUniformLocation(v.Program, "AmbientColor");
+    v.SpecularColorLoc = GLDispatch::getUniformLocation(v.Program, "SpecularColor");
+    v.SpecularExpLoc = GLDispatch::getUniformLocation(v.Program, "SpecularExp");
+    v.DiffuseTexLoc = GLDispatch::getUniformLocation(v.Program, "DiffuseTexture");
+    v.MaterialIndexLoc = GLDispatch::getUniformLocation(v.Program, "MaterialIndex");
+    v.LastUser = NULL;
+    return Variants.insert(std::make_pair(f, v)).first->second;
+}
+void PhongShader::selectVariant(unsigned int f)
+{
+    Features = f;
+    pVariant = &variant(f);
+    ShaderProgram = pVariant->Program;
+    DiffuseColorLoc = pVariant->DiffuseColorLoc;
+    SpecularColorLoc = pVariant->SpecularColorLoc;
+    AmbientColorLoc = pVariant->AmbientColorLoc;
+    SpecularExpLoc = pVariant->SpecularExpLoc;
+    DiffuseTexLoc = pVariant->DiffuseTexLoc;
+    MaterialIndexLoc = pVariant->MaterialIndexLoc;
+    
+    // anderes Programm: alle Uniforms neu setzen (glUseProgram entscheidet GLState)
+    UpdateState = 0xFFFFFFFF;
 }
 void PhongShader::assignLocations()
 {
-    DiffuseColorLoc = glGetUniformLocation(ShaderProgram, "DiffuseColor");
-    AmbientColorLoc = glGetUniformLocation(ShaderProgram, "AmbientColor");
-    SpecularColorLoc = glGetUniformLocation(ShaderProgram, "SpecularColor");
-    SpecularExpLoc = glGetUniformLocation(ShaderProgram, "SpecularExp");
-    DiffuseTexLoc = glGetUniformLocation(ShaderProgram, "DiffuseTexture");
-    LightPosLoc = glGetUniformLocation(ShaderProgram, "LightPos");
-    LightColorLoc = glGetUniformLocation(ShaderProgram, "LightColor");
-    EyePosLoc = glGetUniformLocation(ShaderProgram, "EyePos");
-    ModelMatLoc = glGetUniformLocation(ShaderProgram, "ModelMat");
-    ModelViewProjLoc  = glGetUniformLocation(ShaderProgram, "ModelViewProjMat");
+    DiffuseColorLoc = GLDispatch::getUniformLocation(ShaderProgram, "DiffuseColor");
+    AmbientColorLoc = GLDispatch::getUniformLocation(ShaderProgram, "AmbientColor");
+    SpecularColorLoc = GLDispatch::getUniformLocation(ShaderProgram, "SpecularColor");
+    SpecularExpLoc = GLDispatch::getUniformLocation(ShaderProgram, "SpecularExp");
+    DiffuseTexLoc = GLDispatch::getUniformLocation(ShaderProgram, "DiffuseTexture");
+    MaterialIndexLoc = GLDispatch::getUniformLocation(ShaderProgram, "MaterialIndex");
 }
 void PhongShader::activate(const BaseCamera& Cam) const
 {
     BaseShader::activate(Cam);
+    
+    // Varianten teilen sich Programme: hat eine andere Instanz zuletzt die Uniforms
+    // dieses Programms gesetzt, muss alles neu uebertragen werden
+    if(pVariant && pVariant->LastUser != this)
+    {
+        pVariant->LastUser = this;
+        UpdateState = 0xFFFFFFFF;
+    }
    
     // update uniforms if necessary
-    if(UpdateState&DIFF_COLOR_CHANGED)
-        glUniform3f(DiffuseColorLoc, DiffuseColor.R, DiffuseColor.G, DiffuseColor.B);
-    if(UpdateState&AMB_COLOR_CHANGED)
-        glUniform3f(AmbientColorLoc, AmbientColor.R, AmbientColor.G, AmbientColor.B);
-    if(UpdateState&SPEC_COLOR_CHANGED)
-        glUniform3f(SpecularColorLoc, SpecularColor.R, SpecularColor.G, SpecularColor.B);
-    if(UpdateState&SPEC_EXP_CHANGED)
-        glUniform1f(SpecularExpLoc, SpecularExp);
+    if(Features&MATERIAL_BLOCK)
+    {
+        // Farben liegen im MaterialBlock, pro Draw nur der Index
+        if(UpdateState&MATERIAL_CHANGED)
+            GLDispatch::uniform1i(MaterialIndexLoc, MaterialIndex);
+    }
+    else
+    {
+        if(UpdateState&DIFF_COLOR_CHANGED)
+            GLDispatch::uniform3f(DiffuseColorLoc, DiffuseColor.R, DiffuseColor.G, DiffuseColor.B);
+        if(UpdateState&AMB_COLOR_CHANGED)
+            GLDispatch::uniform3f(AmbientColorLoc, AmbientColor.R, AmbientColor.G, AmbientColor.B);
+        if(UpdateState&SPEC_COLOR_CHANGED)
+            GLDispatch::uniform3f(SpecularColorLoc, SpecularColor.R, SpecularColor.G, SpecularColor.B);
+        if(UpdateState&SPEC_EXP_CHANGED)
+            GLDispatch::uniform1f(SpecularExpLoc, SpecularExp);
+    }
     
-    DiffuseTexture->activate(0);
-    if(UpdateState&DIFF_TEX_CHANGED && DiffuseTexture)
-        glUniform1i(DiffuseTexLoc, 0);
+    if(Features&TEXTURE)
+    {
+        DiffuseTexture->activate(0);
+        if(UpdateState&DIFF_TEX_CHANGED && DiffuseTexture)
+            GLDispatch::uniform1i(DiffuseTexLoc, 0);
+    }
     
-    if(UpdateState&LIGHT_COLOR_CHANGED)
-        glUniform3f(LightColorLoc, LightColor.R, LightColor.G, LightColor.B);
-    if(UpdateState&LIGHT_POS_CHANGED)
-        glUniform3f(LightPosLoc, LightPos.X, LightPos.Y, LightPos.Z);
-
-    // always update matrices
-    Matrix ModelViewProj = Cam.getProjectionMatrix() * Cam.getViewMatrix() * modelTransform();
-    glUniformMatrix4fv(ModelMatLoc, 1, GL_FALSE, modelTransform().m);
-    glUniformMatrix4fv(ModelViewProjLoc, 1, GL_FALSE, ModelViewProj.m);
-    
-    Vector EyePos = Cam.position();
-    glUniform3f(EyePosLoc, EyePos.X, EyePos.Y, EyePos.Z );
+    // Kamera, Licht und View-Projection liegen im Frame-Block (einmal pro Frame),
+    // hier nur noch die Modelmatrix in den Objekt-Block
+    UniformBlocks::object(modelTransform());
     
     UpdateState = 0x0;
 }
@@ -141,15 +257,20 @@ void PhongShader::specularExp( float exp)
     SpecularExp = exp;
     UpdateState |= SPEC_EXP_CHANGED;
 }
+void PhongShader::materialIndex(unsigned int Index)
+{
+    if(MaterialIndex == Index)
+        return;
+    MaterialIndex = Index;
+    UpdateState |= MATERIAL_CHANGED;
+}
 void PhongShader::lightPos( const Vector& pos)
 {
-    LightPos = pos;
-    UpdateState |= LIGHT_POS_CHANGED;
+    UniformBlocks::lightPos(pos);
 }
 void PhongShader::lightColor(const Color& c)
 {
-    LightColor = c;
-    UpdateState |= LIGHT_COLOR_CHANGED;
+    UniformBlocks::lightColor(c);
 }
 
 void PhongShader::diffuseTexture(const Texture* pTex)
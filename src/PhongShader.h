@@ -26,51 +26,92 @@
 #include "camera.h"
 #include "baseshader.h"
 #include "texture.h"
+#include "UniformBlocks.h"
+#include <map>
 
 class PhongShader : public BaseShader
 {
 public:
-    PhongShader(bool LoadStaticShaderCode=true);
+    // Feature-Flags der Shader-Varianten. Jede Kombination wird einmal mit den
+    // passenden #defines uebersetzt; ausgeschaltete Features kosten im Shader nichts.
+    enum FEATURES
+    {
+        TEXTURE = 1<<0,     // DiffuseTexture sampeln
+        SPECULAR = 1<<1,    // Glanzlicht (pow)
+        ALPHA_TEST = 1<<2,  // discard bei Alpha < 0.3
+        INSTANCING = 1<<3,  // Modelmatrix pro Instanz aus Attribut 3-6
+        SKY = 1<<4,         // auf maximale Tiefe legen (Himmel zuletzt mit GL_LEQUAL)
+        MATERIAL_BLOCK = 1<<5, // Farben aus UniformBlocks-Materialtabelle statt Einzel-Uniforms
+        SHADOWS = 1<<6,     // Sonnenschatten aus ShadowMaps empfangen
+        ALL_FEATURES = TEXTURE|SPECULAR|ALPHA_TEST|SHADOWS,
+        SHADER_FEATURES = INSTANCING|SKY|SHADOWS // gibt der Shader vor, nicht das Material
+    };
+    
+    PhongShader(bool LoadStaticShaderCode=true, unsigned int InitialFeatures=ALL_FEATURES);
     // setter
     void diffuseColor( const Color& c);
     void ambientColor( const Color& c);
     void specularColor( const Color& c);
     void specularExp( float exp);
     void diffuseTexture(const Texture* pTex);
+    // Eintrag in der Materialtabelle (UniformBlocks::material), nur mit MATERIAL_BLOCK
+    void materialIndex(unsigned int Index);
     void lightPos( const Vector& pos);
     void lightColor(const Color& c);
+    // Variante wechseln (nur fuer Shader mit eingebettetem Code)
+    void features(unsigned int Features);
     //getter
+    unsigned int features() const { return Features; }
+    bool hasVariants() const { return pVariant != NULL; }
+    // GL-Programm einer Variante (wird bei Bedarf erzeugt), z.B. fuer Sortierschluessel
+    GLuint program(unsigned int Features);
     const Color& diffuseColor() const { return DiffuseColor; }
     const Color& ambientColor() const { return AmbientColor; }
     const Color& specularColor() const { return SpecularColor; }
     float specularExp() const { return SpecularExp; }
     const Texture* diffuseTexture() const { return DiffuseTexture; }
-    const Vector& lightPos() const { return LightPos; }
-    const Color& lightColor() const { return LightColor; }
+    unsigned int materialIndex() const { return MaterialIndex; }
+    // Licht ist global (Frame-Block), die Setter leiten an UniformBlocks weiter
+    const Vector& lightPos() const { return UniformBlocks::lightPos(); }
+    const Color& lightColor() const { return UniformBlocks::lightColor(); }
 
     virtual void activate(const BaseCamera& Cam) const;
+    
+    static unsigned int variantCount() { return (unsigned int)Variants.size(); }
 protected:
     void assignLocations();
 private:
+    struct Variant
+    {
+        GLuint Program;
+        GLint DiffuseColorLoc;
+        GLint SpecularColorLoc;
+        GLint AmbientColorLoc;
+        GLint SpecularExpLoc;
+        GLint DiffuseTexLoc;
+        GLint MaterialIndexLoc;
+        const PhongShader* LastUser; // wer die Uniforms zuletzt gesetzt hat
+    };
+    static std::map<unsigned int, Variant> Variants;
+    void selectVariant(unsigned int Features);
+    Variant& variant(unsigned int Features);
+    
     Color DiffuseColor;
     Color SpecularColor;
     Color AmbientColor;
     float SpecularExp;
-    Vector LightPos;
-    Color LightColor;
     const Texture* DiffuseTexture;
     
     GLint DiffuseColorLoc;
     GLint SpecularColorLoc;
     GLint AmbientColorLoc;
     GLint SpecularExpLoc;
-    GLint LightPosLoc;
-    GLint LightColorLoc;
-    GLint ModelMatLoc;
-    GLint ModelViewProjLoc;
-    GLint EyePosLoc;
     GLint DiffuseTexLoc;
+    GLint MaterialIndexLoc;
     
+    unsigned int MaterialIndex;
+    unsigned int Features;
+    Variant* pVariant; // NULL bei Ableitungen mit eigenem Programm
     mutable unsigned int UpdateState;
     
     enum UPDATESTATES
@@ -79,9 +120,8 @@ private:
         AMB_COLOR_CHANGED = 1<<1,
         SPEC_COLOR_CHANGED = 1<<2,
         SPEC_EXP_CHANGED = 1<<3,
-        LIGHT_POS_CHANGED = 1<<4,
-        LIGHT_COLOR_CHANGED = 1<<5,
-        DIFF_TEX_CHANGED = 1<<6
+        DIFF_TEX_CHANGED = 1<<4,
+        MATERIAL_CHANGED = 1<<5
     };
     
 };
@@ -0,0 +1,147 @@
+#include "Quaternion.h"
+#include "Matrix.h"
+#include <math.h>
+
+Quaternion& Quaternion::identity()
+{
+    X = Y = Z = 0.0f;
+    W = 1.0f;
+    return *this;
+}
+
+Quaternion& Quaternion::rotationX(float Angle)
+{
+    X = sinf(Angle * 0.5f); Y = 0.0f; Z = 0.0f; W = cosf(Angle * 0.5f);
+    return *this;
+}
+
+Quaternion& Quaternion::rotationY(float Angle)
+{
+    X = 0.0f; Y = sinf(Angle * 0.5f); Z = 0.0f; W = cosf(Angle * 0.5f);
+    return *this;
+}
+
+Quaternion& Quaternion::rotationZ(float Angle)
+{
+    X = 0.0f; Y = 0.0f; Z = sinf(Angle * 0.5f); W = cosf(Angle * 0.5f);
+    return *this;
+}
+
+Quaternion& Quaternion::rotationAxis(const Vector& Axis, float Angle)
+{
+    const float Len = Axis.length();
+    if(Len <= 0.0f)
+        return identity();
+    const float s = sinf(Angle * 0.5f) / Len;
+    X = Axis.X * s; Y = Axis.Y * s; Z = Axis.Z * s;
+    W = cosf(Angle * 0.5f);
+    return *this;
+}
+
+// Shepperd: groesste Komponente zuerst, damit nicht durch ~0 geteilt wird
+Quaternion& Quaternion::rotation(const Matrix& M)
+{
+    const float sx = sqrtf(M.m00 * M.m00 + M.m10 * M.m10 + M.m20 * M.m20);
+    const float sy = sqrtf(M.m01 * M.m01 + M.m11 * M.m11 + M.m21 * M.m21);
+    const float sz = sqrtf(M.m02 * M.m02 + M.m12 * M.m12 + M.m22 * M.m22);
+    if(sx <= 0.0f || sy <= 0.0f || sz <= 0.0f)
+        return identity();
+    const float r00 = M.m00 / sx, r01 = M.m01 / sy, r02 = M.m02 / sz;
+    const float r10 = M.m10 / sx, r11 = M.m11 / sy, r12 = M.m12 / sz;
+    const float r20 = M.m20 / sx, r21 = M.m21 / sy, r22 = M.m22 / sz;
+
+    const float Trace = r00 + r11 + r22;
+    if(Trace > 0.0f)
+    {
+        const float s = sqrtf(Trace + 1.0f) * 2.0f;
+        W = 0.25f * s;
+        X = (r21 - r12) / s;
+        Y = (r02 - r20) / s;
+        Z = (r10 - r01) / s;
+    }
+    else if(r00 > r11 && r00 > r22)
+    {
+        const float s = sqrtf(1.0f + r00 - r11 - r22) * 2.0f;
+        W = (r21 - r12) / s;
+        X = 0.25f * s;
+        Y = (r01 + r10) / s;
+        Z = (r02 + r20) / s;
+    }
+    else if(r11 > r22)
+    {
+        const float s = sqrtf(1.0f + r11 - r00 - r22) * 2.0f;
+        W = (r02 - r20) / s;
+        X = (r01 + r10) / s;
+        Y = 0.25f * s;
+        Z = (r12 + r21) / s;
+    }
+    else
+    {
+        const float s = sqrtf(1.0f + r22 - r00 - r11) * 2.0f;
+        W = (r10 - r01) / s;
+        X = (r02 + r20) / s;
+        Y = (r12 + r21) / s;
+        Z = 0.25f * s;
+    }
+    return normalize();
+}
+
+Quaternion& Quaternion::normalize()
+{
+    const float Len = sqrtf(X * X + Y * Y + Z * Z + W * W);
+    if(Len > 0.0f)
+    {
+        const float Inv = 1.0f / Len;
+        X *= Inv; Y *= Inv; Z *= Inv; W *= Inv;
+    }
+    return *this;
+}
+
+Quaternion Quaternion::nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    // q und -q sind dieselbe Drehung: auf die Seite von a holen
+    const float s = a.dot(b) < 0.0f ? -t : t;
+    Quaternion q(a.X + (b.X * s - a.X * t),
+                 a.Y + (b.Y * s - a.Y * t),
+                 a.Z + (b.Z * s - a.Z * t),
+                 a.W + (b.W * s - a.W * t));
+    return q.normalize();
+}
+
+Quaternion Quaternion::slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float d = a.dot(b);
+    const float Sign = d < 0.0f ? -1.0f : 1.0f;
+    d *= Sign;
+    if(d > 0.9995f)
+        return nlerp(a, b, t);
+
+    const float Theta = acosf(d);
+    const float InvSin = 1.0f / sinf(Theta);
+    const float wa = sinf((1.0f - t) * Theta) * InvSin;
+    const float wb = sinf(t * Theta) * InvSin * Sign;
+    return Quaternion(a.X * wa + b.X * wb, a.Y * wa + b.Y * wb,
+                      a.Z * wa + b.Z * wb, a.W * wa + b.W * wb);
+}
+
+void Quaternion::toMatrix3x3(Matrix& M, float Scale) const
+{
+    const float x2 = X + X, y2 = Y + Y, z2 = Z + Z;
+    const float xx = X * x2, yy = Y * y2, zz = Z * z2;
+    const float xy = X * y2, xz = X * z2, yz = Y * z2;
+    const float wx = W * x2, wy = W * y2, wz = W * z2;
+
+    M.m00 = (1.0f - (yy + zz)) * Scale; M.m01 = (xy - wz) * Scale;          M.m02 = (xz + wy) * Scale;
+    M.m10 = (xy + wz) * Scale;          M.m11 = (1.0f - (xx + zz)) * Scale; M.m12 = (yz - wx) * Scale;
+    M.m20 = (xz - wy) * Scale;          M.m21 = (yz + wx) * Scale;          M.m22 = (1.0f - (xx + yy)) * Scale;
+}
+
+Matrix Quaternion::toMatrix() const
+{
+    Matrix M;
+    toMatrix3x3(M);
+    M.m03 = M.m13 = M.m23 = 0.0f;
+    M.m30 = M.m31 = M.m32 = 0.0f;
+    M.m33 = 1.0f;
+    return M;
+}
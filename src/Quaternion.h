@@ -0,0 +1,96 @@
+#ifndef Quaternion_hpp
+#define Quaternion_hpp
+
+#include "vector.h"
+
+class Matrix;
+
+// Einheitsquaternion fuer Drehungen (X,Y,Z = Achse * sin(a/2), W = cos(a/2)).
+// Drehsinn wie Matrix::rotationX/Y/Z; q1 * q2 dreht erst mit q2, dann mit q1.
+// Die haeufig gebrauchten Operationen sind inline und ohne Vector-Temporaries.
+class Quaternion
+{
+public:
+    float X;
+    float Y;
+    float Z;
+    float W;
+
+    Quaternion(); // Identitaet
+    Quaternion(float x, float y, float z, float w);
+
+    Quaternion& identity();
+    Quaternion& rotationX(float Angle);
+    Quaternion& rotationY(float Angle);
+    Quaternion& rotationZ(float Angle);
+    Quaternion& rotationAxis(const Vector& Axis, float Angle);
+    // Drehanteil einer Matrix ohne Scherung; Skalierung wird herausgerechnet
+    Quaternion& rotation(const Matrix& M);
+
+    Quaternion operator*(const Quaternion& q) const;
+    Quaternion& operator*=(const Quaternion& q);
+    // v drehen
+    Vector operator*(const Vector& v) const;
+    void rotate(const float* In, float* Out) const;
+
+    float dot(const Quaternion& q) const;
+    Quaternion conjugate() const; // Inverse fuer Einheitsquaternionen
+    Quaternion& normalize();
+
+    // kuerzester Weg; nlerp ist billiger und fuer kleine Winkel (Interpolation
+    // zwischen zwei Simulationsschritten) praktisch gleich
+    static Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t);
+    static Quaternion slerp(const Quaternion& a, const Quaternion& b, float t);
+
+    // 3x3-Anteil von M, mit Scale multipliziert; Translation/letzte Zeile bleiben
+    void toMatrix3x3(Matrix& M, float Scale = 1.0f) const;
+    Matrix toMatrix() const;
+};
+
+inline Quaternion::Quaternion() : X(0), Y(0), Z(0), W(1) {}
+inline Quaternion::Quaternion(float x, float y, float z, float w) : X(x), Y(y), Z(z), W(w) {}
+
+inline Quaternion Quaternion::operator*(const Quaternion& q) const
+{
+    return Quaternion(W * q.X + X * q.W + Y * q.Z - Z * q.Y,
+                      W * q.Y - X * q.Z + Y * q.W + Z * q.X,
+                      W * q.Z + X * q.Y - Y * q.X + Z * q.W,
+                      W * q.W - X * q.X - Y * q.Y - Z * q.Z);
+}
+
+inline Quaternion& Quaternion::operator*=(const Quaternion& q)
+{
+    *this = *this * q;
+    return *this;
+}
+
+// v + 2w (q x v) + 2 q x (q x v)
+inline void Quaternion::rotate(const float* In, float* Out) const
+{
+    const float tx = 2.0f * (Y * In[2] - Z * In[1]);
+    const float ty = 2.0f * (Z * In[0] - X * In[2]);
+    const float tz = 2.0f * (X * In[1] - Y * In[0]);
+    const float x = In[0] + W * tx + (Y * tz - Z * ty);
+    const float y = In[1] + W * ty + (Z * tx - X * tz);
+    const float z = In[2] + W * tz + (X * ty - Y * tx);
+    Out[0] = x; Out[1] = y; Out[2] = z;
+}
+
+inline Vector Quaternion::operator*(const Vector& v) const
+{
+    Vector Out;
+    rotate(&v.X, &Out.X);
+    return Out;
+}
+
+inline float Quaternion::dot(const Quaternion& q) const
+{
+    return X * q.X + Y * q.Y + Z * q.Z + W * q.W;
+}
+
+inline Quaternion Quaternion::conjugate() const
+{
+    return Quaternion(-X, -Y, -Z, W);
+}
+
+#endif /* Quaternion_hpp */
@@ -0,0 +1,306 @@
+#include "RayIntersect.h"
+#include "MatrixSIMD.h"
+#include <math.h>
+#ifdef MATRIX_SIMD_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+const float RayIntersect::EPSILON = 1e-5f;
+
+// ------------------------------------------------------------------------------
+// TriangleSoA
+
+void TriangleSoA::clear()
+{
+    for(int c=0; c<3; ++c)
+    {
+        V0[c].clear();
+        E1[c].clear();
+        E2[c].clear();
+    }
+    Count = 0;
+}
+
+void TriangleSoA::reserve(size_t n)
+{
+    n = (n + PADDING - 1) / PADDING * PADDING;
+    for(int c=0; c<3; ++c)
+    {
+        V0[c].reserve(n);
+        E1[c].reserve(n);
+        E2[c].reserve(n);
+    }
+}
+
+void TriangleSoA::add(const Vector& A, const Vector& B, const Vector& C)
+{
+    // neuer Block: mit Nullen (Kanten 0 -> Determinante 0 -> kein Treffer) auffuellen
+    if(Count == V0[0].size())
+    {
+        for(int c=0; c<3; ++c)
+        {
+            V0[c].resize(Count + PADDING, 0.0f);
+            E1[c].resize(Count + PADDING, 0.0f);
+            E2[c].resize(Count + PADDING, 0.0f);
+        }
+    }
+    const Vector e1 = B - A;
+    const Vector e2 = C - A;
+    V0[0][Count] = A.X;  V0[1][Count] = A.Y;  V0[2][Count] = A.Z;
+    E1[0][Count] = e1.X; E1[1][Count] = e1.Y; E1[2][Count] = e1.Z;
+    E2[0][Count] = e2.X; E2[1][Count] = e2.Y; E2[2][Count] = e2.Z;
+    ++Count;
+}
+
+// ------------------------------------------------------------------------------
+// skalar
+
+// Moeller-Trumbore: P = D x E2, det = E1.P, u = S.P/det, Q = S x E1, v = D.Q/det, t = E2.Q/det
+static inline bool intersect(float ox, float oy, float oz, float dx, float dy, float dz,
+                             float ax, float ay, float az, float e1x, float e1y, float e1z,
+                             float e2x, float e2y, float e2z, float& t, float& u, float& v)
+{
+    const float px = dy * e2z - dz * e2y;
+    const float py = dz * e2x - dx * e2z;
+    const float pz = dx * e2y - dy * e2x;
+    const float det = e1x * px + e1y * py + e1z * pz;
+    if(det == 0.0f)
+        return false;
+    const float inv = 1.0f / det;
+    const float sx = ox - ax, sy = oy - ay, sz = oz - az;
+    u = (sx * px + sy * py + sz * pz) * inv;
+    const float qx = sy * e1z - sz * e1y;
+    const float qy = sz * e1x - sx * e1z;
+    const float qz = sx * e1y - sy * e1x;
+    v = (dx * qx + dy * qy + dz * qz) * inv;
+    t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+    return u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > RayIntersect::EPSILON;
+}
+
+bool RayIntersect::triangle(const Vector& O, const Vector& D, const Vector& A, const Vector& B, const Vector& C,
+                            float& T, float& U, float& V)
+{
+    return intersect(O.X, O.Y, O.Z, D.X, D.Y, D.Z, A.X, A.Y, A.Z,
+                     B.X - A.X, B.Y - A.Y, B.Z - A.Z, C.X - A.X, C.Y - A.Y, C.Z - A.Z, T, U, V);
+}
+
+unsigned int RayIntersect::trianglesScalar(const Vector& O, const Vector& D, const TriangleSoA& Tris,
+                                           size_t First, size_t Count, float* T, float* U, float* V)
+{
+    unsigned int Mask = 0;
+    for(size_t i=0; i<Count; ++i)
+    {
+        const size_t k = First + i;
+        if(intersect(O.X, O.Y, O.Z, D.X, D.Y, D.Z,
+                     Tris.V0[0][k], Tris.V0[1][k], Tris.V0[2][k],
+                     Tris.E1[0][k], Tris.E1[1][k], Tris.E1[2][k],
+                     Tris.E2[0][k], Tris.E2[1][k], Tris.E2[2][k], T[i], U[i], V[i]))
+            Mask |= 1u << i;
+    }
+    return Mask;
+}
+
+unsigned int RayIntersect::raysScalar(const float* const O[3], const float* const D[3], size_t Count,
+                                      const Vector& A, const Vector& B, const Vector& C,
+                                      float* T, float* U, float* V)
+{
+    const Vector e1 = B - A;
+    const Vector e2 = C - A;
+    unsigned int Mask = 0;
+    for(size_t i=0; i<Count; ++i)
+    {
+        if(intersect(O[0][i], O[1][i], O[2][i], D[0][i], D[1][i], D[2][i], A.X, A.Y, A.Z,
+                     e1.X, e1.Y, e1.Z, e2.X, e2.Y, e2.Z, T[i], U[i], V[i]))
+            Mask |= 1u << i;
+    }
+    return Mask;
+}
+
+#ifdef MATRIX_SIMD_X86
+
+// ------------------------------------------------------------------------------
+// SSE2: dieselbe Rechnung, 4 Lanes. Degenerierte Dreiecke (det = 0) liefern inf/nan,
+// daran scheitern die geordneten Vergleiche.
+
+static inline unsigned int intersectSSE(__m128 ox, __m128 oy, __m128 oz, __m128 dx, __m128 dy, __m128 dz,
+                                        __m128 ax, __m128 ay, __m128 az, __m128 e1x, __m128 e1y, __m128 e1z,
+                                        __m128 e2x, __m128 e2y, __m128 e2z, float* T, float* U, float* V)
+{
+    const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+    const __m128 sx = _mm_sub_ps(ox, ax), sy = _mm_sub_ps(oy, ay), sz = _mm_sub_ps(oz, az);
+    const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+    const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+    const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+    const __m128 zero = _mm_setzero_ps();
+    __m128 Hit = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+    Hit = _mm_and_ps(Hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    Hit = _mm_and_ps(Hit, _mm_cmpgt_ps(t, _mm_set1_ps(RayIntersect::EPSILON)));
+    _mm_storeu_ps(T, t);
+    _mm_storeu_ps(U, u);
+    _mm_storeu_ps(V, v);
+    return (unsigned int)_mm_movemask_ps(Hit);
+}
+
+static unsigned int trianglesSSE(const Vector& O, const Vector& D, const TriangleSoA& Tris, size_t k,
+                                 float* T, float* U, float* V)
+{
+    return intersectSSE(_mm_set1_ps(O.X), _mm_set1_ps(O.Y), _mm_set1_ps(O.Z),
+                        _mm_set1_ps(D.X), _mm_set1_ps(D.Y), _mm_set1_ps(D.Z),
+                        _mm_loadu_ps(&Tris.V0[0][k]), _mm_loadu_ps(&Tris.V0[1][k]), _mm_loadu_ps(&Tris.V0[2][k]),
+                        _mm_loadu_ps(&Tris.E1[0][k]), _mm_loadu_ps(&Tris.E1[1][k]), _mm_loadu_ps(&Tris.E1[2][k]),
+                        _mm_loadu_ps(&Tris.E2[0][k]), _mm_loadu_ps(&Tris.E2[1][k]), _mm_loadu_ps(&Tris.E2[2][k]),
+                        T, U, V);
+}
+
+static unsigned int raysSSE(const float* const O[3], const float* const D[3], size_t k,
+                            const Vector& A, const Vector& e1, const Vector& e2, float* T, float* U, float* V)
+{
+    return intersectSSE(_mm_loadu_ps(O[0] + k), _mm_loadu_ps(O[1] + k), _mm_loadu_ps(O[2] + k),
+                        _mm_loadu_ps(D[0] + k), _mm_loadu_ps(D[1] + k), _mm_loadu_ps(D[2] + k),
+                        _mm_set1_ps(A.X), _mm_set1_ps(A.Y), _mm_set1_ps(A.Z),
+                        _mm_set1_ps(e1.X), _mm_set1_ps(e1.Y), _mm_set1_ps(e1.Z),
+                        _mm_set1_ps(e2.X), _mm_set1_ps(e2.Y), _mm_set1_ps(e2.Z),
+                        T, U, V);
+}
+
+// ------------------------------------------------------------------------------
+// AVX: 8 Lanes
+
+MATRIX_SIMD_AVX_TARGET
+static inline unsigned int intersectAVX(__m256 ox, __m256 oy, __m256 oz, __m256 dx, __m256 dy, __m256 dz,
+                                        __m256 ax, __m256 ay, __m256 az, __m256 e1x, __m256 e1y, __m256 e1z,
+                                        __m256 e2x, __m256 e2y, __m256 e2z, float* T, float* U, float* V)
+{
+    const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+    const __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+    const __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+    const __m256 sx = _mm256_sub_ps(ox, ax), sy = _mm256_sub_ps(oy, ay), sz = _mm256_sub_ps(oz, az);
+    const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inv);
+    const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+    const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inv);
+    const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inv);
+
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 Hit = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+    Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+    Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(t, _mm256_set1_ps(RayIntersect::EPSILON), _CMP_GT_OQ));
+    _mm256_storeu_ps(T, t);
+    _mm256_storeu_ps(U, u);
+    _mm256_storeu_ps(V, v);
+    return (unsigned int)_mm256_movemask_ps(Hit);
+}
+
+MATRIX_SIMD_AVX_TARGET
+static unsigned int trianglesAVX(const Vector& O, const Vector& D, const TriangleSoA& Tris, size_t k,
+                                 float* T, float* U, float* V)
+{
+    return intersectAVX(_mm256_set1_ps(O.X), _mm256_set1_ps(O.Y), _mm256_set1_ps(O.Z),
+                        _mm256_set1_ps(D.X), _mm256_set1_ps(D.Y), _mm256_set1_ps(D.Z),
+                        _mm256_loadu_ps(&Tris.V0[0][k]), _mm256_loadu_ps(&Tris.V0[1][k]), _mm256_loadu_ps(&Tris.V0[2][k]),
+                        _mm256_loadu_ps(&Tris.E1[0][k]), _mm256_loadu_ps(&Tris.E1[1][k]), _mm256_loadu_ps(&Tris.E1[2][k]),
+                        _mm256_loadu_ps(&Tris.E2[0][k]), _mm256_loadu_ps(&Tris.E2[1][k]), _mm256_loadu_ps(&Tris.E2[2][k]),
+                        T, U, V);
+}
+
+MATRIX_SIMD_AVX_TARGET
+static unsigned int raysAVX(const float* const O[3], const float* const D[3],
+                            const Vector& A, const Vector& e1, const Vector& e2, float* T, float* U, float* V)
+{
+    return intersectAVX(_mm256_loadu_ps(O[0]), _mm256_loadu_ps(O[1]), _mm256_loadu_ps(O[2]),
+                        _mm256_loadu_ps(D[0]), _mm256_loadu_ps(D[1]), _mm256_loadu_ps(D[2]),
+                        _mm256_set1_ps(A.X), _mm256_set1_ps(A.Y), _mm256_set1_ps(A.Z),
+                        _mm256_set1_ps(e1.X), _mm256_set1_ps(e1.Y), _mm256_set1_ps(e1.Z),
+                        _mm256_set1_ps(e2.X), _mm256_set1_ps(e2.Y), _mm256_set1_ps(e2.Z),
+                        T, U, V);
+}
+
+#endif
+
+// ------------------------------------------------------------------------------
+// Verteiler
+
+unsigned int RayIntersect::triangles4(const Vector& O, const Vector& D, const TriangleSoA& Tris,
+                                      size_t First, float* T, float* U, float* V)
+{
+#ifdef MATRIX_SIMD_X86
+    if(MatrixSIMD::active() >= MatrixSIMD::SSE2)
+        return trianglesSSE(O, D, Tris, First, T, U, V);
+#endif
+    return trianglesScalar(O, D, Tris, First, 4, T, U, V);
+}
+
+unsigned int RayIntersect::triangles8(const Vector& O, const Vector& D, const TriangleSoA& Tris,
+                                      size_t First, float* T, float* U, float* V)
+{
+#ifdef MATRIX_SIMD_X86
+    const MatrixSIMD::ISA Level = MatrixSIMD::active();
+    if(Level >= MatrixSIMD::AVX)
+        return trianglesAVX(O, D, Tris, First, T, U, V);
+    if(Level >= MatrixSIMD::SSE2)
+        return trianglesSSE(O, D, Tris, First, T, U, V) |
+               (trianglesSSE(O, D, Tris, First + 4, T + 4, U + 4, V + 4) << 4);
+#endif
+    return trianglesScalar(O, D, Tris, First, 8, T, U, V);
+}
+
+unsigned int RayIntersect::rays4(const float* const O[3], const float* const D[3],
+                                 const Vector& A, const Vector& B, const Vector& C,
+                                 float* T, float* U, float* V)
+{
+#ifdef MATRIX_SIMD_X86
+    if(MatrixSIMD::active() >= MatrixSIMD::SSE2)
+        return raysSSE(O, D, 0, A, B - A, C - A, T, U, V);
+#endif
+    return raysScalar(O, D, 4, A, B, C, T, U, V);
+}
+
+unsigned int RayIntersect::rays8(const float* const O[3], const float* const D[3],
+                                 const Vector& A, const Vector& B, const Vector& C,
+                                 float* T, float* U, float* V)
+{
+#ifdef MATRIX_SIMD_X86
+    const MatrixSIMD::ISA Level = MatrixSIMD::active();
+    if(Level >= MatrixSIMD::AVX)
+        return raysAVX(O, D, A, B - A, C - A, T, U, V);
+    if(Level >= MatrixSIMD::SSE2)
+        return raysSSE(O, D, 0, A, B - A, C - A, T, U, V) |
+               (raysSSE(O, D, 4, A, B - A, C - A, T + 4, U + 4, V + 4) << 4);
+#endif
+    return raysScalar(O, D, 8, A, B, C, T, U, V);
+}
+
+bool RayIntersect::closest(const Vector& O, const Vector& D, const TriangleSoA& Tris, Hit& H)
+{
+    bool Found = false;
+    float T[8], U[8], V[8];
+    const size_t n = Tris.paddedSize();
+    for(size_t First=0; First<n; First+=8)
+    {
+        unsigned int Mask = triangles8(O, D, Tris, First, T, U, V);
+        for(unsigned int i=0; Mask; ++i, Mask >>= 1)
+        {
+            if((Mask & 1) && T[i] < H.T)
+            {
+                H.T = T[i];
+                H.U = U[i];
+                H.V = V[i];
+                H.Index = (unsigned int)(First + i);
+                Found = true;
+            }
+        }
+    }
+    return Found;
+}
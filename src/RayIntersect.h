@@ -0,0 +1,76 @@
+#ifndef RayIntersect_hpp
+#define RayIntersect_hpp
+
+#include <vector>
+#include <stddef.h>
+#include "vector.h"
+
+// Dreiecke als SoA fuer Strahltests: erster Eckpunkt A und die Kanten B-A, C-A, je ein
+// Array pro Komponente. Die Arrays sind mit degenerierten Dreiecken (treffen nie) auf
+// Vielfache von 8 aufgefuellt, damit die SIMD-Schleifen keinen Rest brauchen.
+class TriangleSoA
+{
+public:
+    enum { PADDING = 8 };
+
+    TriangleSoA() : Count(0) {}
+    void clear();
+    void reserve(size_t n);
+    void add(const Vector& A, const Vector& B, const Vector& C);
+    size_t size() const { return Count; }
+    size_t paddedSize() const { return V0[0].size(); }
+
+    std::vector<float> V0[3];
+    std::vector<float> E1[3];
+    std::vector<float> E2[3];
+protected:
+    size_t Count;
+};
+
+// Strahl-Dreieck-Schnitt nach Moeller-Trumbore, beidseitig. Treffer: Origin + T*Dir =
+// (1-U-V)*A + U*B + V*C mit T > EPSILON; Dir muss nicht normiert sein (T dann in
+// Einheiten von Dir). Die 4er-Varianten nutzen SSE2, die 8er AVX (sonst 2x SSE2 bzw.
+// skalar), Stufe wie MatrixSIMD::active(). Masken: Bit i = Dreieck/Strahl i getroffen;
+// T/U/V werden fuer alle Eintraege geschrieben, gelten aber nur bei gesetztem Bit.
+class RayIntersect
+{
+public:
+    static const float EPSILON;
+
+    struct Hit
+    {
+        Hit() : T(0), U(0), V(0), Index(0) {}
+        float T, U, V;
+        unsigned int Index; // Dreieck in TriangleSoA
+    };
+
+    static bool triangle(const Vector& Origin, const Vector& Dir,
+                         const Vector& A, const Vector& B, const Vector& C,
+                         float& T, float& U, float& V);
+
+    // ein Strahl gegen die Dreiecke First..First+3 bzw. First+7 (First + Breite <= paddedSize)
+    static unsigned int triangles4(const Vector& Origin, const Vector& Dir, const TriangleSoA& Tris,
+                                   size_t First, float* T, float* U, float* V);
+    static unsigned int triangles8(const Vector& Origin, const Vector& Dir, const TriangleSoA& Tris,
+                                   size_t First, float* T, float* U, float* V);
+
+    // 4 bzw. 8 Strahlen (SoA: Origin[0] = alle x, ...) gegen ein Dreieck
+    static unsigned int rays4(const float* const Origin[3], const float* const Dir[3],
+                              const Vector& A, const Vector& B, const Vector& C,
+                              float* T, float* U, float* V);
+    static unsigned int rays8(const float* const Origin[3], const float* const Dir[3],
+                              const Vector& A, const Vector& B, const Vector& C,
+                              float* T, float* U, float* V);
+
+    // naechster Treffer mit T < H.T; H.T vorher auf die maximale Distanz setzen
+    static bool closest(const Vector& Origin, const Vector& Dir, const TriangleSoA& Tris, Hit& H);
+
+    // Referenz-Implementierungen
+    static unsigned int trianglesScalar(const Vector& Origin, const Vector& Dir, const TriangleSoA& Tris,
+                                        size_t First, size_t Count, float* T, float* U, float* V);
+    static unsigned int raysScalar(const float* const Origin[3], const float* const Dir[3], size_t Count,
+                                   const Vector& A, const Vector& B, const Vector& C,
+                                   float* T, float* U, float* V);
+};
+
+#endif /* RayIntersect_hpp */
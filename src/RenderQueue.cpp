@@ -0,0 +1,159 @@
+#include "RenderQueue.h"
+#include "BaseModel.h"
+#include "GPUProfiler.h"
+#include "UniformBlocks.h"
+#include <cstring>
+
+RenderQueue::RenderQueue()
+{
+}
+
+void RenderQueue::clear()
+{
+    Items.clear();
+    Entries.clear();
+}
+
+uint64_t RenderQueue::makeKey(PASS Pass, unsigned int ShaderId, unsigned int MaterialId, float Depth)
+{
+    if (!(Depth > 0.0f))
+        Depth = 0.0f; // auch NaN
+    uint32_t DepthBits;
+    memcpy(&DepthBits, &Depth, sizeof(DepthBits));
+
+    const uint64_t p = (uint64_t)(Pass & 0x3) << 62;
+    const uint64_t s = (uint64_t)(ShaderId & 0x3FFF);
+    const uint64_t m = (uint64_t)(MaterialId & 0xFFFF);
+    if (Pass == PASS_BLENDED)
+        return p | ((uint64_t)(~DepthBits) << 30) | (s << 16) | m;
+    return p | (s << 48) | (m << 32) | DepthBits;
+}
+
+void RenderQueue::submit(PASS Pass, unsigned int ShaderId, unsigned int MaterialId, float Depth,
+                         BaseModel* pModel, unsigned int Index, const Matrix& Transform)
+{
+    Item it;
+    it.pModel = pModel;
+    it.Index = Index;
+    it.Transform = Transform;
+    Entry e;
+    e.Key = makeKey(Pass, ShaderId, MaterialId, Depth);
+    e.Item = (unsigned int)Items.size();
+    Items.push_back(it);
+    Entries.push_back(e);
+}
+
+void RenderQueue::radixSort(std::vector<Entry>& Data, std::vector<Entry>& Temp)
+{
+    const size_t n = Data.size();
+    if (n < 2)
+        return;
+    Temp.resize(n);
+
+    // alle acht Histogramme in einem Durchlauf
+    unsigned int Count[8][256];
+    memset(Count, 0, sizeof(Count));
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t k = Data[i].Key;
+        for (unsigned int d = 0; d < 8; ++d)
+            Count[d][(k >> (d * 8)) & 0xFF]++;
+    }
+
+    Entry* pSrc = &Data[0];
+    Entry* pDst = &Temp[0];
+    for (unsigned int d = 0; d < 8; ++d) {
+        const unsigned int shift = d * 8;
+        // Ziffer bei allen gleich -> Durchlauf aendert nichts
+        if (Count[d][(pSrc[0].Key >> shift) & 0xFF] == n)
+            continue;
+
+        unsigned int Offset[256];
+        unsigned int sum = 0;
+        for (unsigned int b = 0; b < 256; ++b) {
+            Offset[b] = sum;
+            sum += Count[d][b];
+        }
+        for (size_t i = 0; i < n; ++i)
+            pDst[Offset[(pSrc[i].Key >> shift) & 0xFF]++] = pSrc[i];
+        Entry* t = pSrc; pSrc = pDst; pDst = t;
+    }
+    if (pSrc != &Data[0])
+        Data.swap(Temp);
+}
+
+void RenderQueue::sort()
+{
+    radixSort(Entries, Temp);
+}
+
+void RenderQueue::range(PASS Pass, size_t& Begin, size_t& End) const
+{
+    // Pass steht in den obersten Bits -> nach sort() zusammenhaengend
+    Begin = 0;
+    while (Begin < Entries.size() && (Entries[Begin].Key >> 62) < (uint64_t)Pass)
+        ++Begin;
+    End = Begin;
+    while (End < Entries.size() && (Entries[End].Key >> 62) == (uint64_t)Pass)
+        ++End;
+}
+
+unsigned int RenderQueue::uploadTransforms(size_t Begin, size_t End)
+{
+    Transforms.clear();
+    for (size_t i = Begin; i < End; ++i)
+        Transforms.push_back(Items[Entries[i].Item].Transform);
+    return Transforms.empty() ? 0 : UniformBlocks::objects(&Transforms[0], (unsigned int)Transforms.size());
+}
+
+unsigned int RenderQueue::count(PASS Pass) const
+{
+    size_t b, e;
+    range(Pass, b, e);
+    return (unsigned int)(e - b);
+}
+
+void RenderQueue::execute(const BaseCamera& Cam, PASS Pass, GPUProfiler* pProfiler)
+{
+    size_t b, e;
+    range(Pass, b, e);
+    const unsigned int first = uploadTransforms(b, e);
+    const BaseModel* pOpen = NULL;
+    for (size_t i = b; i < e; ++i) {
+        const Item& it = Items[Entries[i].Item];
+        if (pProfiler && it.pModel != pOpen) {
+            if (pOpen)
+                pProfiler->end();
+            pProfiler->begin(it.pModel->name());
+            pOpen = it.pModel;
+        }
+        UniformBlocks::nextObject(first + (unsigned int)(i - b));
+        it.pModel->drawItem(Cam, it);
+    }
+    if (pProfiler && pOpen)
+        pProfiler->end();
+}
+
+void RenderQueue::executeDepth(const BaseCamera& Cam, DepthShader* pShader, bool Shadow)
+{
+    size_t b, e;
+    range(PASS_OPAQUE, b, e);
+    const unsigned int first = uploadTransforms(b, e);
+    for (size_t i = b; i < e; ++i) {
+        const Item& it = Items[Entries[i].Item];
+        UniformBlocks::nextObject(first + (unsigned int)(i - b));
+        if (Shadow)
+            it.pModel->drawShadow(Cam, it, pShader);
+        else
+            it.pModel->drawDepth(Cam, it, pShader);
+    }
+}
+
+void RenderQueue::execute(const BaseCamera& Cam)
+{
+    const unsigned int first = uploadTransforms(0, Entries.size());
+    for (size_t i = 0; i < Entries.size(); ++i) {
+        const Item& it = Items[Entries[i].Item];
+        UniformBlocks::nextObject(first + (unsigned int)i);
+        it.pModel->drawItem(Cam, it);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef RenderQueue_hpp
+#define RenderQueue_hpp
+
+#include <vector>
+#include <stdint.h>
+#include "matrix.h"
+#include "camera.h"
+
+class BaseModel;
+class DepthShader;
+class GPUProfiler;
+
+// Sammelt die Draws eines Frames, sortiert sie nach einem 64-Bit-Schluessel und
+// fuehrt sie danach aus. Modelle reichen ihre Teile per BaseModel::submit() ein
+// und zeichnen sie in BaseModel::drawItem().
+//
+// Schluessel (hoechstwertige Bits zuerst):
+//   opak/Alpha-Test/Himmel: Pass(2) | Shader(14) | Material(16) | Tiefe(32)  -> Zustand, dann vorn nach hinten
+//   geblendet:   Pass(2) | ~Tiefe(32) | Shader(14) | Material(16) -> hinten nach vorn
+// Die Tiefe ist die Entfernung zur Kamera als float-Bitmuster (fuer positive Werte
+// ordnungserhaltend). Sortiert wird mit einem LSD-Radix-Sort ueber 8-Bit-Ziffern;
+// Ziffern, die bei allen Schluesseln gleich sind, werden uebersprungen.
+// Vor jedem Pass gehen die Modelmatrizen aller Items mit einer Uebertragung in den
+// Objekt-Block (UniformBlocks::objects), die Draws binden dann nur ihren Ausschnitt.
+class RenderQueue
+{
+public:
+    enum PASS
+    {
+        PASS_OPAQUE = 0,
+        PASS_CUTOUT = 1,  // Alpha-Test (discard), schreibt Tiefe; nicht im Depth-Pre-Pass
+        PASS_SKY = 2,     // nach den opaken Draws auf maximaler Tiefe
+        PASS_BLENDED = 3
+    };
+
+    struct Item
+    {
+        BaseModel* pModel;
+        unsigned int Index; // Teil des Modells (z.B. Mesh)
+        Matrix Transform;   // Welttransformation des Teils
+    };
+
+    RenderQueue();
+
+    void clear();
+    void submit(PASS Pass, unsigned int ShaderId, unsigned int MaterialId, float Depth,
+                BaseModel* pModel, unsigned int Index, const Matrix& Transform);
+    void sort();
+    void execute(const BaseCamera& Cam);
+    // nur die Items eines Passes (Zustand wie Tiefentest setzt der Aufrufer);
+    // mit Profiler wird jede zusammenhaengende Folge eines Modells ein eigener Bereich
+    void execute(const BaseCamera& Cam, PASS Pass, GPUProfiler* pProfiler = NULL);
+    // opake Items nur in den Tiefenpuffer (Depth-Pre-Pass bzw. mit Shadow die Schattenkarte)
+    void executeDepth(const BaseCamera& Cam, DepthShader* pShader, bool Shadow = false);
+    unsigned int count(PASS Pass) const;
+
+    static uint64_t makeKey(PASS Pass, unsigned int ShaderId, unsigned int MaterialId, float Depth);
+
+    unsigned int size() const { return (unsigned int)Items.size(); }
+    const Item& item(unsigned int i) const { return Items[Entries[i].Item]; }
+
+protected:
+    struct Entry
+    {
+        uint64_t Key;
+        unsigned int Item;
+    };
+    void range(PASS Pass, size_t& Begin, size_t& End) const;
+    // Matrizen der Eintraege [Begin, End) hochladen, liefert die erste Draw-ID
+    unsigned int uploadTransforms(size_t Begin, size_t End);
+    static void radixSort(std::vector<Entry>& Data, std::vector<Entry>& Temp);
+
+    std::vector<Item> Items;
+    std::vector<Entry> Entries;
+    std::vector<Entry> Temp;
+    std::vector<Matrix> Transforms;
+};
+
+#endif /* RenderQueue_hpp */
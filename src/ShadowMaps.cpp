@@ -0,0 +1,274 @@
+#include "ShadowMaps.h"
+#include "BaseModel.h"
+#include "DepthShader.h"
+#include "GPUProfiler.h"
+#include "UniformBlocks.h"
+#include "GLState.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+static const char* CascadeScopes[ShadowMaps::MAX_CASCADES] = { "shadow 0", "shadow 1", "shadow 2", "shadow 3" };
+
+ShadowMaps::ShadowMaps() : Tex(0), Size(0), CascadeCount(0), Distance(300.0f), CasterDistance(200.0f),
+    SnapTexels(16), Sun(0, 1, 0), Frame(0), LastUpdated(0)
+{
+    Fbo[0] = Fbo[1] = 0;
+    for (unsigned int c = 0; c < MAX_CASCADES; ++c) {
+        Cascade& cs = Cascades[c];
+        cs.Split = 0;
+        cs.Texel = 0;
+        cs.View.identity();
+        cs.Proj.identity();
+        memset(cs.Key, 0, sizeof(cs.Key));
+        cs.Valid = false;
+        cs.LastUpdate = 0;
+        cs.Interval = 1;
+        cs.Updates = 0;
+    }
+}
+
+ShadowMaps::~ShadowMaps()
+{
+    // GL-Objekte gibt release() frei, solange der Kontext noch existiert
+}
+
+bool ShadowMaps::init(unsigned int size, unsigned int cascades, float distance)
+{
+    release();
+    if (cascades < 1) cascades = 1;
+    if (cascades > MAX_CASCADES) cascades = MAX_CASCADES;
+    Size = size;
+    CascadeCount = cascades;
+    Distance = distance;
+
+    // eine Ebene pro Kaskade + statischer Anteil von Kaskade 0
+    glGenTextures(1, &Tex);
+    GLState::bindForUpload(Tex, GL_TEXTURE_2D_ARRAY);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, Size, Size, CascadeCount + 1, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float Border[4] = { 1, 1, 1, 1 }; // ausserhalb = beleuchtet
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, Border);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glGenFramebuffers(2, Fbo);
+    bool ok = true;
+    for (unsigned int i = 0; i < 2; ++i) {
+        bindLayer(Fbo[i], 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        ok = ok && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!ok) {
+        std::cout << "ShadowMaps::init(): WARNING incomplete shadow framebuffer, shadows disabled." << std::endl;
+        release();
+        return false;
+    }
+    invalidate();
+    return true;
+}
+
+void ShadowMaps::release()
+{
+    if (Fbo[0])
+        glDeleteFramebuffers(2, Fbo);
+    if (Tex) {
+        GLState::textureDeleted(Tex);
+        glDeleteTextures(1, &Tex);
+
+        // Kaskadenanzahl 0 -> Shader rechnen ohne Schatten
+        UniformBlocks::ShadowData NoShadows;
+        memset(&NoShadows, 0, sizeof(NoShadows));
+        UniformBlocks::shadows(NoShadows);
+    }
+    Tex = 0;
+    Fbo[0] = Fbo[1] = 0;
+    CascadeCount = 0;
+}
+
+void ShadowMaps::updateInterval(unsigned int Cascade, unsigned int Frames)
+{
+    if (Cascade < MAX_CASCADES)
+        Cascades[Cascade].Interval = Frames ? Frames : 1;
+}
+
+void ShadowMaps::invalidate()
+{
+    for (unsigned int c = 0; c < MAX_CASCADES; ++c)
+        Cascades[c].Valid = false;
+}
+
+void ShadowMaps::computeSplits(const Matrix& Proj)
+{
+    // Near-Plane aus der Projektion, Aufteilung halb logarithmisch, halb linear
+    const float Near = Proj.m23 / (Proj.m22 - 1.0f);
+    const float Lambda = 0.75f;
+    for (unsigned int c = 0; c < CascadeCount; ++c) {
+        const float t = float(c + 1) / float(CascadeCount);
+        const float Log = Near * powf(Distance / Near, t);
+        const float Lin = Near + (Distance - Near) * t;
+        Cascades[c].Split = Lambda * Log + (1.0f - Lambda) * Lin;
+    }
+    Cascades[CascadeCount - 1].Split = Distance;
+}
+
+void ShadowMaps::bindLayer(GLuint fbo, unsigned int Layer) const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, Tex, 0, Layer);
+}
+
+void ShadowMaps::drawCasters(const std::vector<BaseModel*>& Models, const Matrix& View, const Matrix& Proj,
+                             DepthShader* pDepthShader)
+{
+    SimpleCamera LightCam;
+    LightCam.setViewMatrix(View);
+    LightCam.setProjectionMatrix(Proj);
+    UniformBlocks::camera(LightCam);
+
+    Queue.clear();
+    for (size_t i = 0; i < Models.size(); ++i)
+        Models[i]->submit(Queue, LightCam);
+    Queue.sort();
+    Queue.executeDepth(LightCam, pDepthShader, true);
+}
+
+void ShadowMaps::update(const BaseCamera& Cam, const Vector& SunDir, int ViewportWidth, int ViewportHeight,
+                        DepthShader* pDepthShader, GPUProfiler* pProfiler)
+{
+    if (!Tex || !pDepthShader)
+        return;
+    Frame++;
+    LastUpdated = 0;
+
+    Vector L = SunDir;
+    L.normalize();
+    if (L.dot(Sun) < 0.99999f) {
+        Sun = L;
+        invalidate();
+    }
+
+    const Matrix& View = Cam.getViewMatrix();
+    const Matrix& Proj = Cam.getProjectionMatrix();
+    computeSplits(Proj);
+    Matrix InvView = View;
+    InvView.invertAffine();
+    const float k2 = 1.0f / (Proj.m00 * Proj.m00) + 1.0f / (Proj.m11 * Proj.m11); // tan^2 x + tan^2 y
+    const float Near = Proj.m23 / (Proj.m22 - 1.0f);
+
+    // Lichtraum: Blick entgegen der Sonnenrichtung
+    Matrix LightRot;
+    LightRot.lookAt(Vector(0, 0, 0) - Sun, fabsf(Sun.Y) > 0.99f ? Vector(0, 0, 1) : Vector(0, 1, 0), Vector(0, 0, 0));
+
+    bool StateSet = false;
+    for (unsigned int c = 0; c < CascadeCount; ++c) {
+        Cascade& cs = Cascades[c];
+
+        // kleinste Kugel um den Frustum-Abschnitt [a,b], Zentrum auf der Blickachse;
+        // haengt nur von a, b und dem Oeffnungswinkel ab -> dreht die Kamera, bleibt sie gleich
+        const float a = c ? Cascades[c - 1].Split : Near;
+        const float b = cs.Split;
+        float z = 0.5f * (a + b) * (1.0f + k2);
+        float r;
+        if (z >= b) {
+            z = b;
+            r = b * sqrtf(k2);
+        } else
+            r = sqrtf((z - a) * (z - a) + a * a * k2);
+        r = ceilf(r);
+
+        // Rand von SnapTexels Texeln, um den die Kaskade springt
+        const float g = 2.0f * SnapTexels * r / float(Size - 2 * SnapTexels);
+        const float Extent = 2.0f * (r + g);
+        const Vector Center = LightRot * (InvView * Vector(0, 0, -z));
+        const float Key[4] = { floorf(Center.X / g + 0.5f) * g, floorf(Center.Y / g + 0.5f) * g,
+                               floorf(Center.Z / g + 0.5f) * g, r };
+
+        const bool Stale = !cs.Valid || memcmp(Key, cs.Key, sizeof(Key)) != 0;
+        const bool Due = cs.Updates == 0 || Frame - cs.LastUpdate >= cs.Interval;
+        const bool Dynamic = c == 0 && !DynamicModels.empty();
+        if (!(Stale && Due) && !Dynamic)
+            continue;
+
+        if (pProfiler) pProfiler->begin(CascadeScopes[c]);
+        if (!StateSet) {
+            StateSet = true;
+            glViewport(0, 0, Size, Size);
+            GLState::depthMask(true);
+            GLState::depthFunc(GL_LESS);
+            GLState::disable(GL_CULL_FACE); // Terrain ist einseitig
+            GLState::enable(GL_POLYGON_OFFSET_FILL);
+            glPolygonOffset(1.5f, 2.0f);
+        }
+
+        // Kaskade 0: statischer Anteil in der Zusatzebene, dynamische Werfer jedes Frame darauf
+        const unsigned int StaticLayer = (c == 0) ? CascadeCount : c;
+        if (Stale && Due) {
+            const float Depth = 2.0f * (r + g) + CasterDistance;
+            Matrix T;
+            T.translation(-Key[0], -Key[1], -(Key[2] + r + g + CasterDistance));
+            cs.View = T * LightRot;
+            cs.Proj.orthographic(Extent, Extent, 0.0f, Depth);
+            cs.Texel = Extent / float(Size);
+            memcpy(cs.Key, Key, sizeof(Key));
+            cs.Valid = true;
+            cs.LastUpdate = Frame;
+            cs.Updates++;
+            LastUpdated |= 1u << c;
+
+            bindLayer(Fbo[0], StaticLayer);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawCasters(StaticModels, cs.View, cs.Proj, pDepthShader);
+        }
+        if (c == 0 && (Dynamic || (LastUpdated & 1u))) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, Fbo[1]);
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, Tex, 0, StaticLayer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, Fbo[0]);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, Tex, 0, 0);
+            glBlitFramebuffer(0, 0, Size, Size, 0, 0, Size, Size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, Fbo[0]);
+            if (Dynamic)
+                drawCasters(DynamicModels, cs.View, cs.Proj, pDepthShader);
+        }
+        if (pProfiler) pProfiler->end();
+    }
+
+    if (StateSet) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, ViewportWidth, ViewportHeight);
+        GLState::disable(GL_POLYGON_OFFSET_FILL);
+        GLState::enable(GL_CULL_FACE);
+        UniformBlocks::camera(Cam);
+    }
+
+    // Nachschlagen immer mit den Matrizen, mit denen die Ebene gezeichnet wurde
+    UniformBlocks::ShadowData Data;
+    memset(&Data, 0, sizeof(Data));
+    Matrix Bias;
+    Bias.translation(0.5f, 0.5f, 0.5f);
+    Matrix Scale;
+    Scale.scale(0.5f);
+    Bias = Bias * Scale;
+    for (unsigned int c = 0; c < CascadeCount; ++c) {
+        const Matrix m = Bias * Cascades[c].Proj * Cascades[c].View;
+        memcpy(Data.ShadowMat[c], m.m, sizeof(Data.ShadowMat[c]));
+        Data.CascadeSplits[c] = Cascades[c].Split;
+        Data.CascadeTexel[c] = Cascades[c].Texel;
+    }
+    Data.ShadowParams[0] = (float)CascadeCount;
+    Data.ShadowParams[1] = 0.0005f; // Tiefen-Bias
+    Data.ShadowParams[2] = 1.5f;    // Normal-Offset in Texeln
+    UniformBlocks::shadows(Data);
+}
+
+void ShadowMaps::activate() const
+{
+    if (Tex)
+        GLState::bindTexture(UniformBlocks::SHADOW_TEXTURE_UNIT, Tex, GL_TEXTURE_2D_ARRAY);
+}
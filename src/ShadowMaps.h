@@ -0,0 +1,127 @@
+#ifndef ShadowMaps_hpp
+#define ShadowMaps_hpp
+
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include <vector>
+#include "vector.h"
+#include "matrix.h"
+#include "camera.h"
+#include "RenderQueue.h"
+
+class BaseModel;
+class DepthShader;
+class GPUProfiler;
+
+// GLSL: Schattenfaktor (0 = verschattet, 1 = beleuchtet) fuer Weltposition P und
+// Normale N. Setzt UB_SHADOW_BLOCK_GLSL und UB_FRAME_BLOCK_GLSL voraus; einzeilig, damit
+// TerrainShader sie als Makro SHADOW_LOOKUP in fsterrain.glsl einsetzen kann.
+#define SHADOW_LOOKUP_GLSL \
+"float shadowFactor(vec3 P, vec3 N)" \
+"{" \
+"    int Count = int(ShadowParams.x);" \
+"    float Depth = -(ViewMat * vec4(P, 1.0)).z;" \
+"    if(Count == 0 || Depth > CascadeSplits[Count-1])" \
+"        return 1.0;" \
+"    int c = 0;" \
+"    while(c < Count-1 && Depth > CascadeSplits[c])" \
+"        c++;" \
+"    vec4 S = ShadowMat[c] * vec4(P + N * (ShadowParams.z * CascadeTexel[c]), 1.0);" \
+"    vec2 Texel = 1.0 / vec2(textureSize(ShadowMap, 0).xy);" \
+"    float Sum = 0.0;" \
+"    for(int y=-1; y<=1; y+=2)" \
+"        for(int x=-1; x<=1; x+=2)" \
+"            Sum += texture(ShadowMap, vec4(S.xy + vec2(x, y) * 0.5 * Texel, float(c), S.z - ShadowParams.y));" \
+"    return Sum * 0.25;" \
+"}"
+
+// Kaskadierte Schattenkarten fuer die Sonne (Richtung = normalize(LightPos)).
+// Alle Kaskaden liegen in einem Depth-Textur-Array. Jede Kaskade umschliesst ihren
+// Abschnitt des Kamerafrustums mit einer Kugel (drehungsinvariant) und verschiebt
+// sich im Lichtraum nur in Schritten von SnapTexels Texeln; der Rand deckt die
+// Bewegung dazwischen ab. Statische Werfer (Terrain) werden deshalb nur neu
+// gezeichnet, wenn die Sonne sich dreht oder eine Kaskade einen Schritt springt.
+// Dynamische Werfer (Drohne) landen nur in Kaskade 0: deren statischer Anteil liegt
+// in einer zusaetzlichen Ebene und wird pro Frame hineinkopiert, dann kommen die
+// dynamischen Objekte dazu.
+class ShadowMaps
+{
+public:
+    enum { MAX_CASCADES = 4 };
+
+    ShadowMaps();
+    ~ShadowMaps();
+
+    // braucht aktiven GL-Kontext; Distance = Ende der letzten Kaskade (View-Tiefe)
+    bool init(unsigned int Size = 1024, unsigned int Cascades = 4, float Distance = 300.0f);
+    void release();
+    bool isValid() const { return Tex != 0; }
+
+    void staticModel(BaseModel* pModel) { StaticModels.push_back(pModel); invalidate(); }
+    void dynamicModel(BaseModel* pModel) { DynamicModels.push_back(pModel); }
+
+    // statischer Anteil von Kaskade c hoechstens alle Frames Frames neu (1 = sobald noetig)
+    void updateInterval(unsigned int Cascade, unsigned int Frames);
+    unsigned int updateInterval(unsigned int Cascade) const { return Cascades[Cascade].Interval; }
+    // Schrittweite der Kaskaden im Lichtraum; groesser = seltener neu, etwas groebere Texel
+    void snapTexels(unsigned int Texels) { SnapTexels = Texels ? Texels : 1; invalidate(); }
+    // Werfer ausserhalb des Kamerafrustums Richtung Sonne (Welt-Einheiten)
+    void casterDistance(float d) { CasterDistance = d; invalidate(); }
+    // Geometrie der statischen Werfer hat sich geaendert
+    void invalidate();
+
+    // Kaskaden bestimmen, veraltete neu zeichnen, ShadowBlock hochladen. Nach
+    // UniformBlocks::beginFrame aufrufen; stellt Kamera, FBO 0 und Viewport wieder her.
+    void update(const BaseCamera& Cam, const Vector& SunDir, int ViewportWidth, int ViewportHeight,
+                DepthShader* pDepthShader, GPUProfiler* pProfiler = NULL);
+    // Textur-Array an UniformBlocks::SHADOW_TEXTURE_UNIT binden
+    void activate() const;
+
+    unsigned int cascades() const { return CascadeCount; }
+    float split(unsigned int Cascade) const { return Cascades[Cascade].Split; }
+    // Anzahl Neuzeichnungen des statischen Anteils seit init()
+    unsigned int updates(unsigned int Cascade) const { return Cascades[Cascade].Updates; }
+    // Bit c gesetzt: statischer Anteil von Kaskade c wurde im letzten update() gezeichnet
+    unsigned int updatedLastFrame() const { return LastUpdated; }
+
+protected:
+    struct Cascade
+    {
+        float Split;       // Ende der Kaskade (View-Tiefe)
+        float Texel;       // Texelgroesse in Welt-Einheiten
+        Matrix View, Proj; // zuletzt gezeichnet, gilt fuer das Nachschlagen
+        float Key[4];      // eingerastetes Zentrum im Lichtraum + Radius
+        bool Valid;
+        unsigned int LastUpdate;
+        unsigned int Interval;
+        unsigned int Updates;
+    };
+
+    void computeSplits(const Matrix& Proj);
+    void bindLayer(GLuint Fbo, unsigned int Layer) const;
+    void drawCasters(const std::vector<BaseModel*>& Models, const Matrix& View, const Matrix& Proj,
+                     DepthShader* pDepthShader);
+
+    GLuint Tex;
+    GLuint Fbo[2]; // [0] zeichnen, [1] lesen (Kopie des statischen Anteils von Kaskade 0)
+    unsigned int Size;
+    unsigned int CascadeCount;
+    float Distance;
+    float CasterDistance;
+    unsigned int SnapTexels;
+    Cascade Cascades[MAX_CASCADES];
+    Vector Sun;
+    unsigned int Frame;
+    unsigned int LastUpdated;
+    std::vector<BaseModel*> StaticModels;
+    std::vector<BaseModel*> DynamicModels;
+    RenderQueue Queue;
+};
+
+#endif /* ShadowMaps_hpp */
@@ -0,0 +1,66 @@
+#include "TRSTransform.h"
+#include "Matrix.h"
+#include <math.h>
+
+TRSTransform TRSTransform::inverse() const
+{
+    TRSTransform Out;
+    Out.Rotation = Rotation.conjugate();
+    Out.Scale = Scale != 0.0f ? 1.0f / Scale : 0.0f;
+    const float t[3] = { -Translation.X * Out.Scale, -Translation.Y * Out.Scale, -Translation.Z * Out.Scale };
+    Out.Rotation.rotate(t, &Out.Translation.X);
+    return Out;
+}
+
+TRSTransform TRSTransform::interpolate(const TRSTransform& a, const TRSTransform& b, float t)
+{
+    TRSTransform Out;
+    Out.Translation.X = a.Translation.X + (b.Translation.X - a.Translation.X) * t;
+    Out.Translation.Y = a.Translation.Y + (b.Translation.Y - a.Translation.Y) * t;
+    Out.Translation.Z = a.Translation.Z + (b.Translation.Z - a.Translation.Z) * t;
+    Out.Rotation = Quaternion::nlerp(a.Rotation, b.Rotation, t);
+    Out.Scale = a.Scale + (b.Scale - a.Scale) * t;
+    return Out;
+}
+
+void TRSTransform::toMatrix(Matrix& M) const
+{
+    Rotation.toMatrix3x3(M, Scale);
+    M.m03 = Translation.X;
+    M.m13 = Translation.Y;
+    M.m23 = Translation.Z;
+    M.m30 = M.m31 = M.m32 = 0.0f;
+    M.m33 = 1.0f;
+}
+
+Matrix TRSTransform::toMatrix() const
+{
+    Matrix M;
+    toMatrix(M);
+    return M;
+}
+
+bool TRSTransform::fromMatrix(const Matrix& M, float Tolerance)
+{
+    const float sx = sqrtf(M.m00 * M.m00 + M.m10 * M.m10 + M.m20 * M.m20);
+    const float sy = sqrtf(M.m01 * M.m01 + M.m11 * M.m11 + M.m21 * M.m21);
+    const float sz = sqrtf(M.m02 * M.m02 + M.m12 * M.m12 + M.m22 * M.m22);
+
+    Translation = Vector(M.m03, M.m13, M.m23);
+    Rotation.rotation(M);
+    Scale = (sx + sy + sz) * (1.0f / 3.0f);
+
+    // Scherung: Spalten nicht senkrecht; Spiegelung: Determinante < 0
+    const float dxy = M.m00 * M.m01 + M.m10 * M.m11 + M.m20 * M.m21;
+    const float dxz = M.m00 * M.m02 + M.m10 * M.m12 + M.m20 * M.m22;
+    const float dyz = M.m01 * M.m02 + M.m11 * M.m12 + M.m21 * M.m22;
+    const float Det = M.m00 * (M.m11 * M.m22 - M.m21 * M.m12) -
+                      M.m01 * (M.m10 * M.m22 - M.m20 * M.m12) +
+                      M.m02 * (M.m10 * M.m21 - M.m20 * M.m11);
+    const float Limit = Tolerance * (Scale > 1.0f ? Scale : 1.0f);
+    const float OrthoLimit = Tolerance * Scale * Scale;
+    return Det > 0.0f && fabsf(dxy) <= OrthoLimit && fabsf(dxz) <= OrthoLimit && fabsf(dyz) <= OrthoLimit &&
+           fabsf(sx - Scale) <= Limit && fabsf(sy - Scale) <= Limit && fabsf(sz - Scale) <= Limit &&
+           fabsf(M.m30) <= Tolerance && fabsf(M.m31) <= Tolerance && fabsf(M.m32) <= Tolerance &&
+           fabsf(M.m33 - 1.0f) <= Tolerance;
+}
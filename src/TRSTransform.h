@@ -0,0 +1,74 @@
+#ifndef TRSTransform_hpp
+#define TRSTransform_hpp
+
+#include "vector.h"
+#include "Quaternion.h"
+
+class Matrix;
+
+// Kompakte Transformation: erst gleichmaessig skalieren, dann drehen, dann verschieben
+// (entspricht T * R * S als Matrix). Verkettung kostet eine Quaternion-Multiplikation und
+// eine Drehung statt einer 4x4-Multiplikation, und zwei Posen lassen sich sauber
+// interpolieren. Als Matrix wird sie erst zum Hochladen gebraucht (toMatrix).
+// Nur gleichmaessige Skalierung: damit bleibt die Verkettung wieder eine TRS ohne Scherung.
+class TRSTransform
+{
+public:
+    Vector Translation;
+    Quaternion Rotation;
+    float Scale;
+
+    TRSTransform(); // Identitaet
+    TRSTransform(const Vector& T, const Quaternion& R, float S = 1.0f);
+
+    // this * Child: erst Child, dann this (wie Matrix-Multiplikation)
+    TRSTransform operator*(const TRSTransform& Child) const;
+    TRSTransform& operator*=(const TRSTransform& Child);
+    // Punkt transformieren
+    Vector operator*(const Vector& p) const;
+    TRSTransform inverse() const;
+
+    // Translation/Skalierung linear, Drehung per nlerp; t = 0 -> a, t = 1 -> b
+    static TRSTransform interpolate(const TRSTransform& a, const TRSTransform& b, float t);
+
+    void toMatrix(Matrix& M) const;
+    Matrix toMatrix() const;
+    // false bei ungleichmaessiger Skalierung (Abweichung > Tolerance) oder nicht
+    // affiner Matrix; die Transformation ist dann nur angenaehert
+    bool fromMatrix(const Matrix& M, float Tolerance = 1e-3f);
+};
+
+inline TRSTransform::TRSTransform() : Translation(0, 0, 0), Rotation(), Scale(1.0f) {}
+inline TRSTransform::TRSTransform(const Vector& T, const Quaternion& R, float S) : Translation(T), Rotation(R), Scale(S) {}
+
+inline TRSTransform TRSTransform::operator*(const TRSTransform& Child) const
+{
+    TRSTransform Out;
+    const float t[3] = { Child.Translation.X * Scale, Child.Translation.Y * Scale, Child.Translation.Z * Scale };
+    Rotation.rotate(t, &Out.Translation.X);
+    Out.Translation.X += Translation.X;
+    Out.Translation.Y += Translation.Y;
+    Out.Translation.Z += Translation.Z;
+    Out.Rotation = Rotation * Child.Rotation;
+    Out.Scale = Scale * Child.Scale;
+    return Out;
+}
+
+inline TRSTransform& TRSTransform::operator*=(const TRSTransform& Child)
+{
+    *this = *this * Child;
+    return *this;
+}
+
+inline Vector TRSTransform::operator*(const Vector& p) const
+{
+    const float s[3] = { p.X * Scale, p.Y * Scale, p.Z * Scale };
+    Vector Out;
+    Rotation.rotate(s, &Out.X);
+    Out.X += Translation.X;
+    Out.Y += Translation.Y;
+    Out.Z += Translation.Z;
+    return Out;
+}
+
+#endif /* TRSTransform_hpp */
@@ -1,6 +1,12 @@
 #include "Terrain.h"
+#include "GLDispatch.h"
 #include "TerrainShader.h"
 #include "rgbimage.h"
+#include "ImageKernels.h"
+#include "VirtualTexture.h"
+#include "DepthShader.h"
+#include "GLState.h"
+#include "color.h"
 #include <cstdlib>
 
 template <typename T>
@@ -197,6 +203,15 @@ void Terrain::buildMeshFromHeights(const std::vector<float>& heights, int width,
     HeightScale = heightScale;
     Heights = heights;
 
+    // Culling-Huelle im Modellraum (vor transform())
+    float minH = heights.empty() ? 0.0f : heights[0], maxH = minH;
+    for (size_t i = 1; i < heights.size(); ++i) {
+        if (heights[i] < minH) minH = heights[i];
+        if (heights[i] > maxH) maxH = heights[i];
+    }
+    bounds(AABB(0.0f, minH * heightScale, 0.0f,
+                (width - 1) * worldScale, maxH * heightScale, (height - 1) * worldScale));
+
     std::vector<Vector> flatVertices(width * height);
     for (int z = 0; z < height; ++z) {
         for (int x = 0; x < width; ++x) {
@@ -280,6 +295,231 @@ void Terrain::buildMeshFromHeights(const std::vector<float>& heights, int width,
         }
     }
     IB.end();
+
+    buildPatches();
+}
+
+void Terrain::buildPatches()
+{
+    // Rand-Patches dürfen kleiner sein, wenn (Grid-1) kein Vielfaches von PATCH_CELLS ist
+    const int px = (GridW - 2) / PATCH_CELLS + 1;
+    const int pz = (GridH - 2) / PATCH_CELLS + 1;
+    auto cornerX = [&](int i) { return clampv(i * (int)PATCH_CELLS, 0, GridW - 1); };
+    auto cornerZ = [&](int j) { return clampv(j * (int)PATCH_CELLS, 0, GridH - 1); };
+
+    PatchVB.begin();
+    for (int j = 0; j <= pz; ++j) {
+        for (int i = 0; i <= px; ++i) {
+            const int x = cornerX(i), z = cornerZ(j);
+            PatchVB.addNormal(0, 1, 0);
+            PatchVB.addTexcoord0(static_cast<float>(x) / (GridW - 1),
+                                 static_cast<float>(z) / (GridH - 1));
+            PatchVB.addVertex(x * WorldScale, Heights[idx(x, z, GridW)] * HeightScale, z * WorldScale);
+        }
+    }
+    PatchVB.end();
+
+    PatchIB.begin();
+    for (int j = 0; j < pz; ++j) {
+        for (int i = 0; i < px; ++i) {
+            const int c = idx(i, j, px + 1);
+            PatchIB.addIndex(c);
+            PatchIB.addIndex(c + 1);
+            PatchIB.addIndex(c + px + 2);
+            PatchIB.addIndex(c + px + 1);
+        }
+    }
+    PatchIB.end();
+
+    // Varianz der Abweichung von der bilinearen Patch-Fläche: eine schräge, aber
+    // ebene Fläche braucht keine Unterteilung, eine unruhige schon
+    std::vector<float> variance((size_t)px * pz);
+    for (int j = 0; j < pz; ++j) {
+        for (int i = 0; i < px; ++i) {
+            const int x0 = cornerX(i), x1 = cornerX(i + 1);
+            const int z0 = cornerZ(j), z1 = cornerZ(j + 1);
+            const float h00 = Heights[idx(x0, z0, GridW)], h10 = Heights[idx(x1, z0, GridW)];
+            const float h01 = Heights[idx(x0, z1, GridW)], h11 = Heights[idx(x1, z1, GridW)];
+            double sum = 0.0;
+            for (int z = z0; z <= z1; ++z) {
+                const float tz = float(z - z0) / float(z1 - z0);
+                for (int x = x0; x <= x1; ++x) {
+                    const float tx = float(x - x0) / float(x1 - x0);
+                    const float plane = (h00 * (1 - tx) + h10 * tx) * (1 - tz) + (h01 * (1 - tx) + h11 * tx) * tz;
+                    const float d = (Heights[idx(x, z, GridW)] - plane) * HeightScale;
+                    sum += d * d;
+                }
+            }
+            variance[idx(i, j, px)] = float(sum / double((x1 - x0 + 1) * (z1 - z0 + 1)));
+        }
+    }
+
+    HeightFieldTex.createFloat((unsigned int)GridW, (unsigned int)GridH, &Heights[0]);
+    VarianceTex.createFloat((unsigned int)px, (unsigned int)pz, &variance[0], false);
+}
+
+// ------------------- Normal-Map -------------------
+
+static inline float catmullRom(float p0, float p1, float p2, float p3, float t)
+{
+    return p1 + 0.5f * t * (p2 - p0 + t * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3 + t * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+float Terrain::sampleHeightCubic(float gx, float gz) const
+{
+    const int x1 = int(std::floor(gx));
+    const int z1 = int(std::floor(gz));
+    const float tx = gx - float(x1);
+    const float tz = gz - float(z1);
+
+    float rows[4];
+    for (int j = 0; j < 4; ++j) {
+        const int z = clampv(z1 - 1 + j, 0, GridH - 1);
+        float p[4];
+        for (int i = 0; i < 4; ++i)
+            p[i] = Heights[idx(clampv(x1 - 1 + i, 0, GridW - 1), z, GridW)];
+        rows[j] = catmullRom(p[0], p[1], p[2], p[3], tx);
+    }
+    return catmullRom(rows[0], rows[1], rows[2], rows[3], tz);
+}
+
+float Terrain::valueNoise(float x, float z, float period, unsigned int seed) const
+{
+    const float fx = x / period, fz = z / period;
+    const int ix = int(std::floor(fx)), iz = int(std::floor(fz));
+    float tx = fx - float(ix), tz = fz - float(iz);
+    tx = tx * tx * (3.0f - 2.0f * tx);
+    tz = tz * tz * (3.0f - 2.0f * tz);
+
+    const float n00 = hashNoise(ix,     iz,     seed);
+    const float n10 = hashNoise(ix + 1, iz,     seed);
+    const float n01 = hashNoise(ix,     iz + 1, seed);
+    const float n11 = hashNoise(ix + 1, iz + 1, seed);
+    const float n0 = n00 + (n10 - n00) * tx;
+    const float n1 = n01 + (n11 - n01) * tx;
+    return (n0 + (n1 - n0) * tz) * 2.0f - 1.0f;
+}
+
+bool Terrain::generateNormalMap(unsigned int upsample, float detailAmplitude, unsigned int seed)
+{
+    if (GridW <= 1 || GridH <= 1 || Heights.empty())
+        return false;
+    if (upsample < 1) upsample = 1;
+
+    const int w = (GridW - 1) * (int)upsample + 1;
+    const int h = (GridH - 1) * (int)upsample + 1;
+    const float invUp = 1.0f / float(upsample);
+
+    // 1. Höhenfeld in Zielauflösung (Welt-Y), optional mit Detailrauschen
+    std::vector<float> hf((size_t)w * h);
+    ImageKernels::parallelRows((unsigned int)h, [&](unsigned int first, unsigned int end) {
+        for (int z = (int)first; z < (int)end; ++z) {
+            for (int x = 0; x < w; ++x) {
+                float y = (upsample > 1 ? sampleHeightCubic(x * invUp, z * invUp)
+                                        : Heights[idx(x, z, GridW)]) * HeightScale;
+                if (detailAmplitude > 0.0f)
+                    y += detailAmplitude * (0.65f * valueNoise((float)x, (float)z, 4.0f, seed) +
+                                            0.35f * valueNoise((float)x, (float)z, 1.5f, seed + 1));
+                hf[idx(x, z, w)] = y;
+            }
+        }
+    });
+
+    // 2. Ableitungen per zentraler Differenz -> Normale, als RGBA8 kodiert
+    std::vector<unsigned char> data((size_t)w * h * 4);
+    const float step = WorldScale * invUp; // Texelabstand in Objektkoordinaten
+    ImageKernels::parallelRows((unsigned int)h, [&](unsigned int first, unsigned int end) {
+        for (int z = (int)first; z < (int)end; ++z) {
+            const int zm = (z > 0) ? z - 1 : z;
+            const int zp = (z < h - 1) ? z + 1 : z;
+            for (int x = 0; x < w; ++x) {
+                const int xm = (x > 0) ? x - 1 : x;
+                const int xp = (x < w - 1) ? x + 1 : x;
+                const float dhdx = (hf[idx(xp, z, w)] - hf[idx(xm, z, w)]) / (float(xp - xm) * step);
+                const float dhdz = (hf[idx(x, zp, w)] - hf[idx(x, zm, w)]) / (float(zp - zm) * step);
+
+                Vector n(-dhdx, 1.0f, -dhdz);
+                n.normalize();
+
+                unsigned char* p = &data[(size_t)idx(x, z, w) * 4];
+                p[0] = RGBImage::convertColorChannel(n.X * 0.5f + 0.5f);
+                p[1] = RGBImage::convertColorChannel(n.Y * 0.5f + 0.5f);
+                p[2] = RGBImage::convertColorChannel(n.Z * 0.5f + 0.5f);
+                p[3] = 255;
+            }
+        }
+    });
+
+    return NormalTex.create((unsigned int)w, (unsigned int)h, &data[0]);
+}
+
+// ------------------- Virtuelle Textur -------------------
+
+// bilinear, mit Wiederholung (u/v beliebig)
+static Color sampleWrapped(const RGBImage& img, float u, float v)
+{
+    const int w = (int)img.width(), h = (int)img.height();
+    const float fx = (u - std::floor(u)) * w - 0.5f;
+    const float fy = (v - std::floor(v)) * h - 0.5f;
+    const int x0 = (int)std::floor(fx), y0 = (int)std::floor(fy);
+    const float tx = fx - x0, ty = fy - y0;
+    const int xa = (x0 % w + w) % w, xb = (xa + 1) % w;
+    const int ya = (y0 % h + h) % h, yb = (ya + 1) % h;
+    return (img.getPixelColor(xa, ya) * (1 - tx) + img.getPixelColor(xb, ya) * tx) * (1 - ty) +
+           (img.getPixelColor(xa, yb) * (1 - tx) + img.getPixelColor(xb, yb) * tx) * ty;
+}
+
+bool Terrain::bakeVirtualTexture(const char* Filename, unsigned int size, unsigned int detailRepeat,
+                                 unsigned int tileSize) const
+{
+    const RGBImage* pRegolith = DetailTex[0].getRGBImage();
+    const RGBImage* pRock     = DetailTex[1].getRGBImage();
+    if (GridW <= 1 || GridH <= 1 || Heights.empty() || !pRegolith || !pRock)
+        return false;
+
+    // Steigung einmal pro Gridpunkt, beim Backen nur noch bilinear nachschlagen
+    std::vector<float> slope((size_t)GridW * GridH);
+    for (int z = 0; z < GridH; ++z)
+        for (int x = 0; x < GridW; ++x) {
+            const int xm = clampv(x - 1, 0, GridW - 1), xp = clampv(x + 1, 0, GridW - 1);
+            const int zm = clampv(z - 1, 0, GridH - 1), zp = clampv(z + 1, 0, GridH - 1);
+            const float dx = (Heights[idx(xp, z, GridW)] - Heights[idx(xm, z, GridW)]) * HeightScale / (float(xp - xm) * WorldScale);
+            const float dz = (Heights[idx(x, zp, GridW)] - Heights[idx(x, zm, GridW)]) * HeightScale / (float(zp - zm) * WorldScale);
+            slope[idx(x, z, GridW)] = std::sqrt(dx * dx + dz * dz);
+        }
+
+    std::cout << "Terrain: backe virtuelle Textur " << Filename << " (" << size << "^2)" << std::endl;
+    const float invSize = 1.0f / float(size);
+    return VirtualTexture::build(Filename, size, [&](unsigned int y, unsigned char* rgba) {
+        const float v  = (y + 0.5f) * invSize;
+        const float gz = v * (GridH - 1);
+        const int   z0 = clampv((int)gz, 0, GridH - 2);
+        const float tz = gz - float(z0);
+        for (unsigned int x = 0; x < size; ++x) {
+            const float u  = (x + 0.5f) * invSize;
+            const float gx = u * (GridW - 1);
+            const int   x0 = clampv((int)gx, 0, GridW - 2);
+            const float tx = gx - float(x0);
+            const int i00 = idx(x0, z0, GridW), i10 = i00 + 1, i01 = i00 + GridW, i11 = i01 + 1;
+            const float s = (slope[i00] * (1 - tx) + slope[i10] * tx) * (1 - tz) + (slope[i01] * (1 - tx) + slope[i11] * tx) * tz;
+            const float h = (Heights[i00] * (1 - tx) + Heights[i10] * tx) * (1 - tz) + (Heights[i01] * (1 - tx) + Heights[i11] * tx) * tz;
+
+            // Fels an steilen Stellen, Übergang leicht verrauscht
+            const float rock = clampv((s - 0.35f) * 2.5f + 0.25f * valueNoise(gx, gz, 6.0f, 11u), 0.0f, 1.0f);
+            Color c = sampleWrapped(*pRegolith, u * detailRepeat, v * detailRepeat) * (1.0f - rock) +
+                      sampleWrapped(*pRock,     u * detailRepeat, v * detailRepeat) * rock;
+
+            // großflächige Albedo-Variation, Senken etwas dunkler
+            const float shade = 0.85f + 0.18f * valueNoise(gx, gz, 48.0f, 21u) +
+                                0.08f * valueNoise(gx * 4.0f, gz * 4.0f, 7.0f, 22u) + 0.15f * (h - 0.5f);
+            c = c * shade;
+
+            rgba[x * 4 + 0] = RGBImage::convertColorChannel(c.R);
+            rgba[x * 4 + 1] = RGBImage::convertColorChannel(c.G);
+            rgba[x * 4 + 2] = RGBImage::convertColorChannel(c.B);
+            rgba[x * 4 + 3] = 255;
+        }
+    }, tileSize);
 }
 
 // ------------------- Render/Shader -------------------
@@ -287,6 +527,7 @@ void Terrain::buildMeshFromHeights(const std::vector<float>& heights, int width,
 void Terrain::shader(BaseShader* shader, bool deleteOnDestruction)
 {
     BaseModel::shader(shader, deleteOnDestruction);
+    pTerrainShader = dynamic_cast<TerrainShader*>(shader);
 }
 
 void Terrain::draw(const BaseCamera& Cam)
@@ -294,22 +535,81 @@ void Terrain::draw(const BaseCamera& Cam)
     applyShaderParameter();
     BaseModel::draw(Cam);
 
+    if (pTerrainShader && pTerrainShader->tessellated()) {
+        // kein Eintrag im Depth-Pre-Pass (andere Geometrie als dort) -> Tiefe hier selbst
+        // schreiben; Verdeckung durch die übrigen Objekte wirkt trotzdem per Early-Z
+        const bool Equal = GLState::depthFunc() == GL_EQUAL;
+        if (Equal) {
+            GLState::depthFunc(GL_LEQUAL);
+            GLState::depthMask(true);
+        }
+        PatchVB.activate();
+        PatchIB.activate();
+        GLDispatch::patchParameteri(GL_PATCH_VERTICES, 4);
+        GLDispatch::drawElements(GL_PATCHES, PatchIB.indexCount(), PatchIB.indexFormat(), 0);
+        if (Equal) {
+            GLState::depthFunc(GL_EQUAL);
+            GLState::depthMask(false);
+        }
+        return;
+    }
+
     VB.activate();
     IB.activate();
-    glDrawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
+    GLDispatch::drawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
     IB.deactivate();
     VB.deactivate();
 }
 
+void Terrain::drawFeedback(const BaseCamera& Cam, VTFeedbackShader* pShader)
+{
+    if(!pShader) return;
+    pShader->scaling(Size);
+    pShader->modelTransform(transform());
+    pShader->activate(Cam);
+
+    VB.activate();
+    IB.activate();
+    GLDispatch::drawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
+    IB.deactivate();
+    VB.deactivate();
+}
+
+void Terrain::drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader)
+{
+    if(pTerrainShader && pTerrainShader->tessellated()) return; // siehe draw()
+    drawShadow(Cam, Item, pDepthShader);
+}
+
+void Terrain::drawShadow(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader)
+{
+    if(!pDepthShader) return;
+    pDepthShader->scaling(Size);
+    pDepthShader->modelTransform(transform());
+    pDepthShader->activate(Cam);
+
+    VB.activate();
+    IB.activate();
+    GLDispatch::drawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
+    pDepthShader->resetScaling();
+}
+
 void Terrain::applyShaderParameter()
 {
-    TerrainShader* Shader = dynamic_cast<TerrainShader*>(BaseModel::shader());
+    TerrainShader* Shader = pTerrainShader;
     if(!Shader) return;
 
     Shader->mixTex(&MixTex);
     for(int i=0; i<2; i++)
         Shader->detailTex(i,&DetailTex[i]);
+    Shader->normalTex(NormalTex.isValid() ? &NormalTex : NULL);
     Shader->scaling(Size);
+    if(Shader->tessellated())
+    {
+        Shader->heightTex(&HeightFieldTex);
+        Shader->varianceTex(&VarianceTex);
+        Shader->heightParams(HeightScale, WorldScale);
+    }
 }
 
 // ------------------- Height Sampling -------------------
@@ -350,7 +650,7 @@ float Terrain::heightAtWorld(float xw, float zw) const
 {
     // Welt -> Objektraum (inverse Model-Transform)
     Matrix inv = transform();
-    inv.invert();
+    inv.invertAffine();
     Vector local = inv * Vector(xw, 0.0f, zw);
     return sampleHeightLocal(local.X, local.Z);
 }
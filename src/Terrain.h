@@ -8,6 +8,9 @@
 #include "vertexbuffer.h"
 #include "indexbuffer.h"
 
+class VTFeedbackShader;
+class TerrainShader;
+
 class Terrain : public BaseModel
 {
     struct TerrainVertex {
@@ -32,9 +35,28 @@ public:
                                float worldScale = 1.0f, float heightScale = 50.0f,
                                bool wrapEdges = false);
 
-    // Render
+    // Normal-Map aus den Höhen erzeugen (Objektraum-Normalen, RGBA8), entkoppelt
+    // die Beleuchtung von der Mesh-Auflösung. upsample > 1 erhöht die Auflösung
+    // (Catmull-Rom), detailAmplitude > 0 addiert feines Rauschen (Welt-Einheiten).
+    bool generateNormalMap(unsigned int upsample = 2, float detailAmplitude = 0.0f,
+                           unsigned int seed = 777u);
+    const Texture& normalMap() const { return NormalTex; }
+
+    // Terrainweite Albedo als virtuelle Textur (.vtex) backen: Detail-Texturen nach
+    // Steigung gemischt und großflächig variiert. size = tileSize * 2^n.
+    bool bakeVirtualTexture(const char* Filename, unsigned int size, unsigned int detailRepeat = 12,
+                            unsigned int tileSize = 128) const;
+
+    // Render; mit tessellierendem TerrainShader werden nur grobe Patches gezeichnet
     virtual void shader(BaseShader* shader, bool deleteOnDestruction = false) override;
+    using BaseModel::shader;
     virtual void draw(const BaseCamera& Cam) override;
+    // Feedback-Pass der virtuellen Textur (gleiche Geometrie, anderer Shader)
+    void drawFeedback(const BaseCamera& Cam, VTFeedbackShader* pShader);
+    // Depth-Pre-Pass: Vertices wie vsterrain.glsl mit Size skaliert
+    virtual void drawDepth(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader) override;
+    // Schattenwerfer immer als Dreiecksnetz, auch im Tessellation-Modus
+    virtual void drawShadow(const BaseCamera& Cam, const RenderQueue::Item& Item, DepthShader* pDepthShader) override;
 
     // Weltkoordinaten -> Terrainhöhe (Y in Weltkoords)
     float heightAtWorld(float xw, float zw) const;
@@ -66,6 +88,9 @@ private:
     void buildMeshFromHeights(const std::vector<float>& h, int width, int height,
                               float worldScale, float heightScale);
 
+    // Patches für die Tessellation: Ecken + Höhenfeld/Varianz als Texturen
+    void buildPatches();
+
     // Diamond–Square (interner Schritt)
     inline int idx(int x, int z, int width) const { return x + z * width; }
     void dsDiamondStep(std::vector<float>& h, int size, int x, int z, int reach,
@@ -74,14 +99,27 @@ private:
     // kleine deterministische Zufallsfunktion (kein <random>)
     inline float hashNoise(int x, int z, unsigned int seed) const;
 
+    // Höhe im Grid (normalisiert) per Catmull-Rom, gx/gz in Grid-Einheiten
+    float sampleHeightCubic(float gx, float gz) const;
+    // glattes Wertrauschen [-1..1], Periode in Texeln
+    float valueNoise(float x, float z, float period, unsigned int seed) const;
+
     // OpenGL Ressourcen
     VertexBuffer VB;
     IndexBuffer  IB;
+    // Tessellation: PATCH_CELLS x PATCH_CELLS Gridzellen pro Patch, 4 Ecken (GL_PATCHES)
+    enum { PATCH_CELLS = 16 };
+    VertexBuffer PatchVB;
+    IndexBuffer  PatchIB;
+    TerrainShader* pTerrainShader = NULL; // == pShader, falls es ein TerrainShader ist
 
     // Texturen
     Texture DetailTex[2];
     Texture MixTex;    // optional; wenn nicht gesetzt, TerrainShader sollte damit umgehen
     Texture HeightTex; // nur für Heightmap-Pfad
+    Texture NormalTex; // aus Heights generiert (generateNormalMap)
+    Texture HeightFieldTex; // Heights als R32F, Verschiebung im Tessellation-Pfad
+    Texture VarianceTex;    // Höhenvarianz pro Patch (R32F, Welt-Einheiten^2)
 
     // Terrain Dimensionen (frei nutzbar für Shader-Scaling)
     Vector Size = Vector(1,1,1);
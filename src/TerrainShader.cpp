@@ -1,11 +1,27 @@
 #include "TerrainShader.h"
+#include "ShadowMaps.h"
 #include <string>
 
-TerrainShader::TerrainShader(const std::string& AssetDirectory) : PhongShader(false), Scaling(1,1,1), MixTex(NULL)
+TerrainShader::TerrainShader(const std::string& AssetDirectory, bool Tessellation) : PhongShader(false), Scaling(1,1,1), MixTex(NULL), NormalTex(NULL), VirtualTex(NULL),
+    HeightTex(NULL), VarianceTex(NULL), HeightParams(1,1,0), TessParams(8,0.5f,32), Tessellated(Tessellation)
 {
     std::string VSFile = AssetDirectory + "vsterrain.glsl";
     std::string FSFile = AssetDirectory + "fsterrain.glsl";
-    if( !load(VSFile.c_str(), FSFile.c_str()))
+    // Terrain hat kein Glanzlicht -> Variante ohne pow(). Der Schatten-Lookup kommt als
+    // einzeiliges Makro dazu (dieselbe Funktion wie im PhongShader), die anderen Stufen
+    // verwenden es nicht.
+    const char* Defines = "#define SPECULAR 0\n#define SHADOW_LOOKUP " SHADOW_LOOKUP_GLSL "\n";
+    bool ok;
+    if(Tessellation)
+    {
+        std::string TCSFile = AssetDirectory + "tcsterrain.glsl";
+        std::string TESFile = AssetDirectory + "testerrain.glsl";
+        ok = load(VSFile.c_str(), TCSFile.c_str(), TESFile.c_str(), FSFile.c_str(),
+                  (std::string(Defines) + "#define TESSELLATION 1\n").c_str());
+    }
+    else
+        ok = load(VSFile.c_str(), FSFile.c_str(), Defines);
+    if( !ok)
         throw std::exception();
     PhongShader::assignLocations();
     specularColor(Color(0,0,0));
@@ -13,6 +29,17 @@ TerrainShader::TerrainShader(const std::string& AssetDirectory) : PhongShader(fa
     MixTexLoc = getParameterID( "MixTex");
     ScalingLoc = getParameterID( "Scaling");
     kLoc = getParameterID("k");
+    HeightTexLoc = getParameterID("HeightTex");
+    VarianceTexLoc = getParameterID("VarianceTex");
+    HeightParamsLoc = getParameterID("HeightParams");
+    TessParamsLoc = getParameterID("TessParams");
+    NormalTexLoc = getParameterID("NormalTex");
+    UseNormalMapLoc = getParameterID("UseNormalMap");
+    UseVirtualTexLoc = getParameterID("UseVirtualTex");
+    VTAtlasLoc = getParameterID("VTAtlas");
+    VTPageTableLoc = getParameterID("VTPageTable");
+    VTParamsLoc = getParameterID("VTParams");
+    VTAtlasParamsLoc = getParameterID("VTAtlasParams");
     
     for(int i=0; i<DETAILTEX_COUNT; i++)
     {
@@ -33,6 +60,28 @@ void TerrainShader::activate(const BaseCamera& Cam) const
 
     for(int i=0; i<DETAILTEX_COUNT; i++)
         activateTex(DetailTex[i], DetailTexLoc[i], slot++);
+
+    activateTex(NormalTex, NormalTexLoc, slot++);
+    setParameter(UseNormalMapLoc, (NormalTex && NormalTexLoc>=0) ? 1 : 0);
+
+    const bool useVT = VirtualTex && VirtualTex->isValid() && VTAtlasLoc>=0;
+    if(useVT)
+    {
+        VirtualTex->activate(slot);
+        setParameter(VTAtlasLoc, slot++);
+        setParameter(VTPageTableLoc, slot++);
+        setParameter(VTParamsLoc, Vector((float)VirtualTex->tiles(), (float)(VirtualTex->levels()-1), (float)VirtualTex->tileSize()));
+        setParameter(VTAtlasParamsLoc, Vector((float)VirtualTex->atlasPages(), (float)VirtualTex->pageSize(), (float)VirtualTex->border()));
+    }
+    setParameter(UseVirtualTexLoc, useVT ? 1 : 0);
+
+    if(Tessellated)
+    {
+        activateTex(HeightTex, HeightTexLoc, slot++);
+        activateTex(VarianceTex, VarianceTexLoc, slot++);
+        setParameter(HeightParamsLoc, HeightParams);
+        setParameter(TessParamsLoc, TessParams);
+    }
     
     setParameter(ScalingLoc, Scaling);
     setParameter(kLoc, k);
@@ -41,6 +90,8 @@ void TerrainShader::activate(const BaseCamera& Cam) const
 void TerrainShader::deactivate() const
 {
     PhongShader::deactivate();
+    if(VirtualTex && VirtualTex->isValid() && VTAtlasLoc>=0) VirtualTex->deactivate();
+    if(NormalTex&&NormalTexLoc>=0) NormalTex->deactivate();
     for(int i=DETAILTEX_COUNT-1; i>=0; i--)
         if(DetailTex[i]&&DetailTexLoc[i]>=0) DetailTex[i]->deactivate();
     if(MixTex) MixTex->deactivate();
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include "PhongShader.h"
+#include "VirtualTexture.h"
 
 
 class TerrainShader : public PhongShader
@@ -15,33 +16,64 @@ public:
         DETAILTEX_COUNT
     };
     
-    TerrainShader(const std::string& AssetDirectory);
+    // Tessellation: Terrain wird als grobe Patches gezeichnet (Terrain::draw waehlt den Pfad)
+    TerrainShader(const std::string& AssetDirectory, bool Tessellation=false);
     virtual ~TerrainShader() {}
     virtual void activate(const BaseCamera& Cam) const;
     virtual void deactivate() const;
     
     const Texture* detailTex(unsigned int idx) const { assert(idx<DETAILTEX_COUNT); return DetailTex[idx]; }
     const Texture* mixTex() const { return MixTex; }
+    const Texture* normalTex() const { return NormalTex; }
+    const VirtualTexture* virtualTex() const { return VirtualTex; }
 
     void detailTex(unsigned int idx, const Texture* pTex) { assert(idx<DETAILTEX_COUNT); DetailTex[idx] = pTex; }
     void mixTex(const Texture* pTex) { MixTex = pTex; }
+    void normalTex(const Texture* pTex) { NormalTex = pTex; } // NULL = Vertex-Normalen
+    void virtualTex(const VirtualTexture* pVT) { VirtualTex = pVT; } // ersetzt Mix-/Detail-Texturen
 
     void scaling(const Vector& s) { Scaling = s; }
     const Vector& scaling() const { return Scaling; }
     void setK(int kValue) { k = kValue; }
 
+    bool tessellated() const { return Tessellated; }
+    void heightTex(const Texture* pTex) { HeightTex = pTex; }
+    void varianceTex(const Texture* pTex) { VarianceTex = pTex; }
+    void heightParams(float HeightScale, float WorldScale) { HeightParams = Vector(HeightScale, WorldScale, 0); }
+    // Ziel-Kantenlaenge der Dreiecke in Pixeln, Standardabweichung der Patch-Hoehe fuer volle Dichte
+    void tessParams(float EdgePixels, float VarianceRef, float MaxLevel) { TessParams = Vector(EdgePixels, VarianceRef, MaxLevel); }
+    const Vector& tessParams() const { return TessParams; }
+
 
 private:
     void activateTex(const Texture* pTex, GLint Loc, int slot) const;
 
     const Texture* MixTex;
     const Texture* DetailTex[DETAILTEX_COUNT];
+    const Texture* NormalTex;
+    const VirtualTexture* VirtualTex;
+    const Texture* HeightTex;
+    const Texture* VarianceTex;
     Vector Scaling;
+    Vector HeightParams;
+    Vector TessParams;
+    bool Tessellated;
     // shader locations
     GLint MixTexLoc;
     GLint DetailTexLoc[DETAILTEX_COUNT];
+    GLint NormalTexLoc;
+    GLint UseNormalMapLoc;
+    GLint UseVirtualTexLoc;
+    GLint VTAtlasLoc;
+    GLint VTPageTableLoc;
+    GLint VTParamsLoc;
+    GLint VTAtlasParamsLoc;
     GLint ScalingLoc;
     GLint kLoc;
+    GLint HeightTexLoc;
+    GLint VarianceTexLoc;
+    GLint HeightParamsLoc;
+    GLint TessParamsLoc;
 
     int k;
 };
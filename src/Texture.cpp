@@ -7,6 +7,7 @@
 //
 
 #include "Texture.h"
+#include "GLDispatch.h"
 #include "rgbimage.h"
 #include "color.h"
 #include <assert.h>
@@ -14,9 +15,10 @@
 #include <exception>
 #include <algorithm>
 #include "FreeImage.h"
+#include "TextureCache.h"
+#include "GLState.h"
 
 Texture* Texture::pDefaultTex = NULL;
-Texture::SharedTexMap Texture::SharedTextures;
 
 Texture* Texture::defaultTex()
 {
@@ -34,75 +36,38 @@ Texture* Texture::defaultTex()
 
 const Texture* Texture::LoadShared(const char* Filename)
 {
-    std::string path = Filename;
-    
-    std::transform(path.begin(), path.end(), path.begin(), ::tolower);
-    
-    SharedTexMap::iterator it = SharedTextures.find( path);
-    
-    if(it != SharedTextures.end())
-    {
-        it->second.RefCount++;
-        return it->second.pTex;
-    }
-    
-    Texture* pTex = new Texture();
-    if(!pTex->load(Filename) )
-    {
-        delete pTex;
-        std::cout << "WARNING: Texture " << Filename << " not loaded (not found).\n";
-        return NULL;
-    }
-    
-    TexEntry TE;
-    TE.pTex = pTex;
-    TE.RefCount = 1;
-    SharedTextures[path] = TE;
-    
-    return pTex;
+    return TextureCache::instance().acquire(Filename);
 }
 
 void Texture::ReleaseShared( const Texture* pTex )
 {
-    for( SharedTexMap::iterator it=SharedTextures.begin(); it!=SharedTextures.end(); ++it)
-    {
-        if(it->second.pTex == pTex)
-        {
-            it->second.RefCount--;
-            if(it->second.RefCount<=0)
-            {
-                delete it->second.pTex;
-                SharedTextures.erase(it);
-            }
-            return;
-        }
-    }
+    TextureCache::instance().release(pTex);
 }
 
 
 
-Texture::Texture() : m_TextureID(0), m_pImage(NULL), CurrentTextureUnit(0)
+Texture::Texture() : m_TextureID(0), m_HasAlpha(false), m_pImage(NULL), CurrentTextureUnit(0), CacheSlot(-1)
 {
     
 }
 
 
 
-Texture::Texture(unsigned int width, unsigned int height, unsigned char* data): m_TextureID(0), m_pImage(NULL), CurrentTextureUnit(0)
+Texture::Texture(unsigned int width, unsigned int height, unsigned char* data): m_TextureID(0), m_HasAlpha(false), m_pImage(NULL), CurrentTextureUnit(0), CacheSlot(-1)
 {
     bool Result = create(width, height, data);
     if(!Result)
         throw std::exception();
     
 }
-Texture::Texture(const char* Filename ): m_TextureID(0), m_pImage(NULL), CurrentTextureUnit(0)
+Texture::Texture(const char* Filename ): m_TextureID(0), m_HasAlpha(false), m_pImage(NULL), CurrentTextureUnit(0), CacheSlot(-1)
 {
     bool Result = load(Filename);
     if(!Result)
         throw std::exception();
 }
 
-Texture::Texture(const RGBImage& img) : m_TextureID(0), m_pImage(NULL), CurrentTextureUnit(0)
+Texture::Texture(const RGBImage& img) : m_TextureID(0), m_HasAlpha(false), m_pImage(NULL), CurrentTextureUnit(0), CacheSlot(-1)
 {
     bool Result = create(img);
     if(!Result)
@@ -118,7 +83,8 @@ void Texture::release()
 {
     if(isValid())
     {
-        glDeleteTextures(1, &m_TextureID);
+        GLState::textureDeleted(m_TextureID);
+        GLDispatch::deleteTextures(1, &m_TextureID);
         m_TextureID = -1;
     }
     if(m_pImage)
@@ -134,6 +100,7 @@ bool Texture::isValid() const
 bool Texture::load( const char* Filename)
 {
     release();
+    m_HasAlpha = false;
     FREE_IMAGE_FORMAT ImageFormat = FreeImage_GetFileType(Filename, 0);
     if(ImageFormat == FIF_UNKNOWN)
         ImageFormat = FreeImage_GetFIFFromFilename(Filename);
@@ -179,7 +146,10 @@ bool Texture::load( const char* Filename)
             *(++dataPtr) = c.rgbGreen;
             *(++dataPtr) = c.rgbBlue;
             if(bpp==32)
+            {
                 *(++dataPtr) = c.rgbReserved;
+                m_HasAlpha |= c.rgbReserved < 255;
+            }
             else
                 *(++dataPtr) = 255;
         }
@@ -191,16 +161,15 @@ bool Texture::load( const char* Filename)
     
     m_pImage = createImage(data, Width, Height);
     
-    glGenTextures(1, &m_TextureID);
+    GLDispatch::genTextures(1, &m_TextureID);
     
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindForUpload(m_TextureID);
+    GLDispatch::texImage2D(GL_TEXTURE_2D, 0,GL_RGBA, Width, Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    GLDispatch::generateMipmap(GL_TEXTURE_2D);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
     
     delete [] data;
     return true;
@@ -210,18 +179,39 @@ bool Texture::create( unsigned int width, unsigned int height, unsigned char* da
 {
     release();
     
+    m_HasAlpha = false;
+    for( unsigned int i=3; i<width*height*4 && !m_HasAlpha; i+=4)
+        m_HasAlpha = data[i] < 255;
+    
     m_pImage = createImage(data, width, height);
     
-    glGenTextures(1, &m_TextureID);
+    GLDispatch::genTextures(1, &m_TextureID);
+    
+    GLState::bindForUpload(m_TextureID);
+    GLDispatch::texImage2D(GL_TEXTURE_2D, 0,GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    GLDispatch::generateMipmap(GL_TEXTURE_2D);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    
+    return true;
+}
+
+bool Texture::createFloat( unsigned int width, unsigned int height, const float* data, bool linear)
+{
+    release();
+    
+    m_HasAlpha = false;
+    GLDispatch::genTextures(1, &m_TextureID);
     
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0,GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::bindForUpload(m_TextureID);
+    GLDispatch::pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLDispatch::texImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, data);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+    GLDispatch::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+    GLDispatch::texParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
     
     return true;
 }
@@ -277,15 +267,12 @@ void Texture::activate(int slot) const
     
     CurrentTextureUnit = slot;
 
-    glActiveTexture(GL_TEXTURE0 + CurrentTextureUnit);
-    glBindTexture(GL_TEXTURE_2D, m_TextureID);
+    GLState::bindTexture(CurrentTextureUnit, m_TextureID);
 }
 
 void Texture::deactivate() const
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
-    if(CurrentTextureUnit>0)
-        glActiveTexture(GL_TEXTURE0 + CurrentTextureUnit-1);
+    // Textur bleibt an der Unit gebunden; GLState ueberspringt das erneute Binden
     CurrentTextureUnit=0;
     
 }
@@ -10,7 +10,6 @@
 #define __RealtimeRending__Texture__
 
 #include <iostream>
-#include <map>
 
 #ifdef WIN32
 #include <GL/glew.h>
@@ -34,9 +33,14 @@ public:
     bool load(const char* Filename);
     bool create(unsigned int width, unsigned int height, unsigned char* data);
     bool create(const RGBImage& img);
+    // einkanalig R32F ohne Mipmaps (z.B. Hoehenfeld), Rand geklemmt
+    bool createFloat(unsigned int width, unsigned int height, const float* data, bool linear=true);
     void activate(int slot=0) const;
     void deactivate() const;
     bool isValid() const;
+    GLuint id() const { return m_TextureID; }
+    // true, wenn mindestens ein Texel nicht voll deckend ist (Alpha < 255)
+    bool hasAlpha() const { return m_HasAlpha; }
     const RGBImage* getRGBImage() const;
     static Texture* defaultTex();
     static const Texture* LoadShared(const char* Filename);
@@ -47,17 +51,14 @@ protected:
     unsigned char* LoadBMP( const char* Filename, unsigned int& width, unsigned int& height );
     RGBImage* createImage( unsigned char* Data, unsigned int width, unsigned int height );
     GLuint m_TextureID;
+    bool m_HasAlpha;
     RGBImage* m_pImage;
     mutable int CurrentTextureUnit;
     static Texture* pDefaultTex;
     
-    struct TexEntry
-    {
-        int RefCount;
-        const Texture* pTex;
-    };
-    typedef std::map<std::string, TexEntry> SharedTexMap;
-    static SharedTexMap SharedTextures;
+    // Slot im TextureCache (-1 = nicht geteilt), erlaubt ReleaseShared in O(1)
+    int CacheSlot;
+    friend class TextureCache;
     
 };
 
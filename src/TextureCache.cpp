@@ -0,0 +1,202 @@
+#include "TextureCache.h"
+#include "Texture.h"
+#include "rgbimage.h"
+#include <iostream>
+#include <cctype>
+
+TextureCache& TextureCache::instance()
+{
+    static TextureCache Cache;
+    return Cache;
+}
+
+TextureCache::TextureCache() : LruHead(-1), LruTail(-1), Budget(256u * 1024u * 1024u)
+{
+    CacheStats.Hits = CacheStats.Misses = CacheStats.Reloads = CacheStats.Evictions = 0;
+    CacheStats.BytesResident = 0;
+    CacheStats.Resident = CacheStats.Referenced = 0;
+    Buckets.assign(64, -1);
+}
+
+TextureCache::~TextureCache()
+{
+    // Texturen werden nicht mehr geloescht: der GL-Kontext existiert bei statischer
+    // Zerstoerung nicht mehr, der Treiber raeumt beim Beenden auf.
+}
+
+uint64_t TextureCache::hashPath(const char* Filename, std::string* pNormalized)
+{
+    uint64_t h = 14695981039346656037ull;
+    if (pNormalized) pNormalized->clear();
+    for (const char* p = Filename; *p; ++p) {
+        char c = (char)::tolower((unsigned char)*p);
+        if (c == '\\') c = '/';
+        h ^= (unsigned char)c;
+        h *= 1099511628211ull;
+        if (pNormalized) pNormalized->push_back(c);
+    }
+    return h;
+}
+
+int TextureCache::find(uint64_t hash, const std::string& path) const
+{
+    for (int i = Buckets[hash & (Buckets.size() - 1)]; i >= 0; i = Entries[i].HashNext)
+        if (Entries[i].Hash == hash && Entries[i].Path == path)
+            return i;
+    return -1;
+}
+
+int TextureCache::insert(uint64_t hash, const std::string& path, const char* File)
+{
+    if (Entries.size() + 1 > Buckets.size() * 3 / 4)
+        rehash(Buckets.size() * 2);
+
+    Entry e;
+    e.Path = path;
+    e.File = File;
+    e.Hash = hash;
+    e.pTex = NULL;
+    e.RefCount = 0;
+    e.Bytes = 0;
+    e.LruPrev = e.LruNext = -1;
+    const size_t b = hash & (Buckets.size() - 1);
+    e.HashNext = Buckets[b];
+    Entries.push_back(e);
+    Buckets[b] = (int)Entries.size() - 1;
+    return Buckets[b];
+}
+
+void TextureCache::rehash(size_t bucketCount)
+{
+    Buckets.assign(bucketCount, -1);
+    for (size_t i = 0; i < Entries.size(); ++i) {
+        const size_t b = Entries[i].Hash & (bucketCount - 1);
+        Entries[i].HashNext = Buckets[b];
+        Buckets[b] = (int)i;
+    }
+}
+
+bool TextureCache::loadEntry(int slot)
+{
+    Entry& e = Entries[slot];
+    Texture* pTex = new Texture();
+    if (!pTex->load(e.File.c_str())) {
+        delete pTex;
+        std::cout << "WARNING: Texture " << e.File << " not loaded (not found).\n";
+        return false;
+    }
+    pTex->CacheSlot = slot;
+
+    const RGBImage* pImg = pTex->getRGBImage();
+    e.Bytes = pImg ? (size_t)pImg->width() * pImg->height() * 4 * 4 / 3 : 0;
+    e.pTex = pTex;
+    CacheStats.BytesResident += e.Bytes;
+    CacheStats.Resident++;
+    return true;
+}
+
+void TextureCache::evict(int slot)
+{
+    Entry& e = Entries[slot];
+    lruRemove(slot);
+    delete e.pTex;
+    e.pTex = NULL;
+    CacheStats.BytesResident -= e.Bytes;
+    CacheStats.Resident--;
+    CacheStats.Evictions++;
+}
+
+void TextureCache::lruPush(int slot)
+{
+    Entry& e = Entries[slot];
+    e.LruPrev = LruTail;
+    e.LruNext = -1;
+    if (LruTail >= 0) Entries[LruTail].LruNext = slot;
+    else LruHead = slot;
+    LruTail = slot;
+}
+
+void TextureCache::lruRemove(int slot)
+{
+    Entry& e = Entries[slot];
+    if (e.LruPrev >= 0) Entries[e.LruPrev].LruNext = e.LruNext;
+    else if (LruHead == slot) LruHead = e.LruNext;
+    else return; // nicht in der Liste
+    if (e.LruNext >= 0) Entries[e.LruNext].LruPrev = e.LruPrev;
+    else LruTail = e.LruPrev;
+    e.LruPrev = e.LruNext = -1;
+}
+
+void TextureCache::enforceBudget()
+{
+    while (CacheStats.BytesResident > Budget && LruHead >= 0)
+        evict(LruHead);
+}
+
+const Texture* TextureCache::acquire(const char* Filename)
+{
+    std::string path;
+    const uint64_t hash = hashPath(Filename, &path);
+
+    int slot = find(hash, path);
+    if (slot >= 0 && Entries[slot].pTex) {
+        Entry& e = Entries[slot];
+        if (e.RefCount == 0) {
+            lruRemove(slot);
+            CacheStats.Referenced++;
+        }
+        e.RefCount++;
+        CacheStats.Hits++;
+        return e.pTex;
+    }
+
+    CacheStats.Misses++;
+    if (slot >= 0)
+        CacheStats.Reloads++;
+    else
+        slot = insert(hash, path, Filename);
+
+    if (!loadEntry(slot))
+        return NULL;
+
+    Entries[slot].RefCount = 1;
+    CacheStats.Referenced++;
+    enforceBudget();
+    return Entries[slot].pTex;
+}
+
+void TextureCache::release(const Texture* pTex)
+{
+    if (!pTex || pTex->CacheSlot < 0 || pTex->CacheSlot >= (int)Entries.size())
+        return;
+    const int slot = pTex->CacheSlot;
+    Entry& e = Entries[slot];
+    if (e.pTex != pTex || e.RefCount <= 0)
+        return;
+
+    if (--e.RefCount == 0) {
+        CacheStats.Referenced--;
+        lruPush(slot);
+        enforceBudget();
+    }
+}
+
+void TextureCache::budget(size_t bytes)
+{
+    Budget = bytes;
+    enforceBudget();
+}
+
+void TextureCache::trim()
+{
+    while (LruHead >= 0)
+        evict(LruHead);
+}
+
+void TextureCache::printStats() const
+{
+    std::cout << "TextureCache: " << CacheStats.Resident << " geladen (" << CacheStats.Referenced
+              << " referenziert), " << (CacheStats.BytesResident / 1024) << " KB / " << (Budget / 1024)
+              << " KB, Hits " << CacheStats.Hits << ", Misses " << CacheStats.Misses
+              << " (Reloads " << CacheStats.Reloads << "), Evictions " << CacheStats.Evictions << std::endl;
+}
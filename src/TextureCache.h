@@ -0,0 +1,81 @@
+#ifndef TextureCache_hpp
+#define TextureCache_hpp
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+class Texture;
+
+// Gemeinsamer Textur-Cache hinter Texture::LoadShared/ReleaseShared.
+// - Schluessel: FNV-1a-Hash des normalisierten Pfads (Kleinbuchstaben, '/'), Hash-Tabelle mit Ketten
+// - jede Textur kennt ihren Slot (Texture::CacheSlot) -> release() in O(1)
+// - nicht mehr referenzierte Texturen bleiben geladen und stehen in einer LRU-Liste;
+//   uebersteigt der Speicher das Budget, wird die am laengsten ungenutzte freigegeben
+// - verdraengte Eintraege behalten Pfad und Hash und werden bei Bedarf neu geladen
+class TextureCache
+{
+public:
+    struct Stats
+    {
+        unsigned int Hits;
+        unsigned int Misses;
+        unsigned int Reloads;   // Misses auf zuvor verdraengte Eintraege
+        unsigned int Evictions;
+        size_t BytesResident;   // geschaetzt: w*h*4 inkl. Mipmaps
+        unsigned int Resident;
+        unsigned int Referenced;
+    };
+
+    static TextureCache& instance();
+
+    const Texture* acquire(const char* Filename);
+    void release(const Texture* pTex);
+
+    // Speicherbudget fuer geladene Texturen (Standard 256 MB). Referenzierte Texturen
+    // werden nie verdraengt, das Budget kann also kurzzeitig ueberschritten werden.
+    void budget(size_t bytes);
+    size_t budget() const { return Budget; }
+
+    // alle unreferenzierten Texturen freigeben
+    void trim();
+
+    const Stats& stats() const { return CacheStats; }
+    void printStats() const;
+
+    static uint64_t hashPath(const char* Filename, std::string* pNormalized = NULL);
+
+protected:
+    TextureCache();
+    ~TextureCache();
+
+    struct Entry
+    {
+        std::string Path;   // normalisiert
+        std::string File;   // wie uebergeben (fuer Reload)
+        uint64_t Hash;
+        Texture* pTex;      // NULL = verdraengt
+        int RefCount;
+        size_t Bytes;
+        int HashNext;       // Kette im Bucket
+        int LruPrev, LruNext; // nur unreferenzierte, geladene Eintraege
+    };
+
+    int find(uint64_t hash, const std::string& path) const;
+    int insert(uint64_t hash, const std::string& path, const char* File);
+    void rehash(size_t bucketCount);
+    bool loadEntry(int slot);
+    void evict(int slot);
+    void lruPush(int slot);
+    void lruRemove(int slot);
+    void enforceBudget();
+
+    std::vector<Entry> Entries;
+    std::vector<int> Buckets;
+    int LruHead, LruTail;   // Head = am laengsten ungenutzt
+    size_t Budget;
+    Stats CacheStats;
+};
+
+#endif /* TextureCache_hpp */
@@ -7,6 +7,7 @@
 //
 
 #include "TrianglePlaneModel.h"
+#include "GLDispatch.h"
 
 
 TrianglePlaneModel::TrianglePlaneModel( float DimX, float DimZ, int NumSegX, int NumSegZ )
@@ -66,7 +67,7 @@ void TrianglePlaneModel::draw( const BaseCamera& Cam )
     VB.activate();
     IB.activate();
     
-    glDrawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
+    GLDispatch::drawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
     
     IB.deactivate();
     VB.deactivate();
@@ -7,6 +7,7 @@
 //
 
 #include "TriangleSphereModel.h"
+#include "GLDispatch.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -49,7 +50,7 @@ void TriangleSphereModel::draw(const BaseCamera& Cam)
     
     VB.activate();
     IB.activate();
-    glDrawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
+    GLDispatch::drawElements(GL_TRIANGLES, IB.indexCount(), IB.indexFormat(), 0);
     IB.deactivate();
     VB.deactivate();
 }
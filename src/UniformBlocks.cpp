@@ -0,0 +1,256 @@
+#include "UniformBlocks.h"
+#include "GLDispatch.h"
+#include <cstring>
+#include <iostream>
+#include "GLState.h"
+
+UniformBlocks::FrameData UniformBlocks::Frame;
+Vector UniformBlocks::EyePos(0, 0, 0);
+Vector UniformBlocks::LightPos(20.0f, 20.0f, 20.0f);
+Color UniformBlocks::LightColor(1, 1, 1);
+GLuint UniformBlocks::FrameUBO = 0;
+GLuint UniformBlocks::ObjectUBO = 0;
+GLuint UniformBlocks::MaterialUBO = 0;
+GLuint UniformBlocks::ShadowUBO = 0;
+std::vector<float> UniformBlocks::MaterialTable;
+unsigned int UniformBlocks::ObjectStride = 64;
+unsigned int UniformBlocks::MaxObjects = 0;
+unsigned int UniformBlocks::ObjectCount = 0;
+unsigned int UniformBlocks::BatchNext = 0;
+unsigned int UniformBlocks::BatchEnd = 0;
+std::vector<unsigned char> UniformBlocks::Staging;
+
+void UniformBlocks::init(unsigned int maxObjectsPerFrame)
+{
+    if (FrameUBO)
+        return;
+
+    GLint align = 0;
+    GLDispatch::getIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    if (align < 1) align = 256;
+    ObjectStride = ((64 + align - 1) / align) * align;
+    MaxObjects = maxObjectsPerFrame ? maxObjectsPerFrame : 1;
+    ObjectCount = 0;
+    BatchNext = BatchEnd = 0;
+    Staging.assign((size_t)MaxObjects * ObjectStride, 0);
+
+    memset(&Frame, 0, sizeof(Frame));
+    GLDispatch::genBuffers(1, &FrameUBO);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, FrameUBO);
+    GLDispatch::bufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+
+    GLDispatch::genBuffers(1, &ObjectUBO);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ObjectUBO);
+    GLDispatch::bufferData(GL_UNIFORM_BUFFER, Staging.size(), NULL, GL_STREAM_DRAW);
+
+    // Materialien, die vor init() geladen wurden, gleich mit hochladen
+    GLDispatch::genBuffers(1, &MaterialUBO);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, MaterialUBO);
+    GLDispatch::bufferData(GL_UNIFORM_BUFFER, MAX_MATERIALS * 12 * sizeof(float), NULL, GL_STATIC_DRAW);
+    if (!MaterialTable.empty())
+        GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, 0, MaterialTable.size() * sizeof(float), &MaterialTable[0]);
+
+    // leerer ShadowBlock: Anzahl Kaskaden 0 -> Shader rechnen unverschattet
+    ShadowData NoShadows;
+    memset(&NoShadows, 0, sizeof(NoShadows));
+    GLDispatch::genBuffers(1, &ShadowUBO);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ShadowUBO);
+    GLDispatch::bufferData(GL_UNIFORM_BUFFER, sizeof(ShadowData), &NoShadows, GL_DYNAMIC_DRAW);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    GLDispatch::bindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, FrameUBO);
+    GLDispatch::bindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, MaterialUBO);
+    GLDispatch::bindBufferBase(GL_UNIFORM_BUFFER, SHADOW_BINDING, ShadowUBO);
+    GLDispatch::bindBufferRange(GL_UNIFORM_BUFFER, OBJECT_BINDING, ObjectUBO, 0, 64);
+}
+
+void UniformBlocks::release()
+{
+    if (FrameUBO) GLDispatch::deleteBuffers(1, &FrameUBO);
+    if (ObjectUBO) GLDispatch::deleteBuffers(1, &ObjectUBO);
+    if (MaterialUBO) GLDispatch::deleteBuffers(1, &MaterialUBO);
+    if (ShadowUBO) GLDispatch::deleteBuffers(1, &ShadowUBO);
+    FrameUBO = ObjectUBO = MaterialUBO = ShadowUBO = 0;
+    Staging.clear();
+}
+
+void UniformBlocks::bindProgram(GLuint program)
+{
+    GLuint index = GLDispatch::getUniformBlockIndex(program, "FrameBlock");
+    if (index != GL_INVALID_INDEX)
+        GLDispatch::uniformBlockBinding(program, index, FRAME_BINDING);
+    index = GLDispatch::getUniformBlockIndex(program, "ObjectBlock");
+    if (index != GL_INVALID_INDEX)
+        GLDispatch::uniformBlockBinding(program, index, OBJECT_BINDING);
+    index = GLDispatch::getUniformBlockIndex(program, "MaterialBlock");
+    if (index != GL_INVALID_INDEX)
+        GLDispatch::uniformBlockBinding(program, index, MATERIAL_BINDING);
+    index = GLDispatch::getUniformBlockIndex(program, "ShadowBlock");
+    if (index != GL_INVALID_INDEX)
+        GLDispatch::uniformBlockBinding(program, index, SHADOW_BINDING);
+
+    // Sampler-Unit ist wie die Bindungspunkte fest
+    const GLint shadowMap = GLDispatch::getUniformLocation(program, "ShadowMap");
+    if (shadowMap >= 0) {
+        GLState::useProgram(program);
+        GLDispatch::uniform1i(shadowMap, SHADOW_TEXTURE_UNIT);
+    }
+}
+
+void UniformBlocks::shadows(const ShadowData& Data)
+{
+    init();
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ShadowUBO);
+    GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowData), &Data);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBlocks::beginFrame(const BaseCamera& Cam, int viewportWidth, int viewportHeight)
+{
+    init();
+
+    Frame.Viewport[0] = 0;
+    Frame.Viewport[1] = 0;
+    Frame.Viewport[2] = (float)viewportWidth;
+    Frame.Viewport[3] = (float)viewportHeight;
+
+    // Objekt-Ring verwerfen (Orphaning), damit der Treiber nicht auf den Vorframe wartet
+    ObjectCount = 0;
+    BatchNext = BatchEnd = 0;
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ObjectUBO);
+    GLDispatch::bufferData(GL_UNIFORM_BUFFER, Staging.size(), NULL, GL_STREAM_DRAW);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    camera(Cam);
+}
+
+void UniformBlocks::camera(const BaseCamera& Cam)
+{
+    const Matrix& View = Cam.getViewMatrix();
+    const Matrix& Proj = Cam.getProjectionMatrix();
+    Matrix ViewProj = Proj * View;
+    memcpy(Frame.View, View.m, sizeof(Frame.View));
+    memcpy(Frame.Proj, Proj.m, sizeof(Frame.Proj));
+    memcpy(Frame.ViewProj, ViewProj.m, sizeof(Frame.ViewProj));
+
+    EyePos = Cam.position();
+    Frame.EyePos[0] = EyePos.X;
+    Frame.EyePos[1] = EyePos.Y;
+    Frame.EyePos[2] = EyePos.Z;
+    Frame.EyePos[3] = 1.0f;
+    uploadFrame();
+}
+
+void UniformBlocks::lightPos(const Vector& pos)
+{
+    LightPos = pos;
+    uploadFrame();
+}
+
+void UniformBlocks::lightColor(const Color& c)
+{
+    LightColor = c;
+    uploadFrame();
+}
+
+void UniformBlocks::uploadFrame()
+{
+    Frame.LightPos[0] = LightPos.X;
+    Frame.LightPos[1] = LightPos.Y;
+    Frame.LightPos[2] = LightPos.Z;
+    Frame.LightPos[3] = 1.0f;
+    Frame.LightColor[0] = LightColor.R;
+    Frame.LightColor[1] = LightColor.G;
+    Frame.LightColor[2] = LightColor.B;
+    Frame.LightColor[3] = 1.0f;
+
+    if (!FrameUBO)
+        return; // vor init(): wird mit dem ersten beginFrame hochgeladen
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, FrameUBO);
+    GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &Frame);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+unsigned int UniformBlocks::reserve(unsigned int count)
+{
+    init();
+    if (count > MaxObjects)
+        count = MaxObjects;
+    if (ObjectCount + count > MaxObjects) {
+        // Ring voll: neuen Speicher anfordern und von vorn beginnen
+        GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ObjectUBO);
+        GLDispatch::bufferData(GL_UNIFORM_BUFFER, Staging.size(), NULL, GL_STREAM_DRAW);
+        GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+        ObjectCount = 0;
+        BatchNext = BatchEnd = 0; // vorab geladene Matrizen liegen im verworfenen Speicher
+    }
+    const unsigned int first = ObjectCount;
+    ObjectCount += count;
+    return first;
+}
+
+unsigned int UniformBlocks::object(const Matrix& ModelMat)
+{
+    // Draws aus der RenderQueue: Matrix liegt schon im Buffer
+    if (BatchNext < BatchEnd && memcmp(&Staging[(size_t)BatchNext * ObjectStride], ModelMat.m, 64) == 0) {
+        bindObject(BatchNext);
+        return BatchNext++;
+    }
+
+    const unsigned int id = reserve(1);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ObjectUBO);
+    GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, (GLintptr)id * ObjectStride, 64, ModelMat.m);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+    bindObject(id);
+    return id;
+}
+
+unsigned int UniformBlocks::objects(const Matrix* pModelMats, unsigned int count)
+{
+    if (count == 0)
+        return ObjectCount;
+    const unsigned int first = reserve(count);
+    count = ObjectCount - first;
+    for (unsigned int i = 0; i < count; ++i)
+        memcpy(&Staging[(size_t)(first + i) * ObjectStride], pModelMats[i].m, 64);
+
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, ObjectUBO);
+    GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, (GLintptr)first * ObjectStride, (GLsizeiptr)count * ObjectStride,
+                    &Staging[(size_t)first * ObjectStride]);
+    GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+    BatchNext = first;
+    BatchEnd = first + count;
+    return first;
+}
+
+unsigned int UniformBlocks::material(const Color& Diffuse, const Color& Specular, float SpecularExp,
+                                     const Color& Ambient)
+{
+    const float m[12] = {
+        Diffuse.R, Diffuse.G, Diffuse.B, 1.0f,
+        Specular.R, Specular.G, Specular.B, SpecularExp,
+        Ambient.R, Ambient.G, Ambient.B, 1.0f
+    };
+    const unsigned int count = materialCount();
+    for (unsigned int i = 0; i < count; ++i)
+        if (memcmp(&MaterialTable[i * 12], m, sizeof(m)) == 0)
+            return i;
+    if (count >= MAX_MATERIALS) {
+        std::cout << "WARNING: UniformBlocks::material(): more than " << MAX_MATERIALS
+                  << " materials, using material 0." << std::endl;
+        return 0;
+    }
+
+    MaterialTable.insert(MaterialTable.end(), m, m + 12);
+    if (MaterialUBO) {
+        GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, MaterialUBO);
+        GLDispatch::bufferSubData(GL_UNIFORM_BUFFER, count * sizeof(m), sizeof(m), m);
+        GLDispatch::bindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    return count;
+}
+
+void UniformBlocks::bindObject(unsigned int drawId)
+{
+    GLDispatch::bindBufferRange(GL_UNIFORM_BUFFER, OBJECT_BINDING, ObjectUBO, (GLintptr)drawId * ObjectStride, 64);
+}
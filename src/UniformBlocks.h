@@ -0,0 +1,160 @@
+#ifndef UniformBlocks_hpp
+#define UniformBlocks_hpp
+
+#include <vector>
+#ifdef WIN32
+#include <GL/glew.h>
+#include <glfw/glfw3.h>
+#else
+#define GLFW_INCLUDE_GLCOREARB
+#define GLFW_INCLUDE_GLEXT
+#include <glfw/glfw3.h>
+#endif
+#include "vector.h"
+#include "color.h"
+#include "matrix.h"
+#include "camera.h"
+
+// GLSL-Deklarationen der Blöcke (std140) für eingebettete Shader.
+// Shader-Dateien (assets/*.glsl) deklarieren die Blöcke identisch.
+#define UB_FRAME_BLOCK_GLSL \
+"layout(std140) uniform FrameBlock" \
+"{" \
+"    mat4 ViewMat;" \
+"    mat4 ProjMat;" \
+"    mat4 ViewProjMat;" \
+"    vec4 EyePos;" \
+"    vec4 LightPos;" \
+"    vec4 LightColor;" \
+"    vec4 Viewport;" \
+"};"
+
+// Materialtabelle: Diffuse.rgb, Specular.rgb + Exponent in .w, Ambient.rgb
+#define UB_MATERIAL_BLOCK_GLSL \
+"struct MaterialData" \
+"{" \
+"    vec4 Diffuse;" \
+"    vec4 Specular;" \
+"    vec4 Ambient;" \
+"};" \
+"layout(std140) uniform MaterialBlock" \
+"{" \
+"    MaterialData Materials[256];" \
+"};"
+
+// Sonnenschatten (ShadowMaps): Kaskaden-Matrizen nach [0,1], Kaskadenenden als View-Tiefe.
+// ShadowParams.x = Anzahl Kaskaden (0 = keine Schatten), .y = Tiefen-Bias, .z = Normal-Offset in Texeln
+#define UB_SHADOW_BLOCK_GLSL \
+"layout(std140) uniform ShadowBlock" \
+"{" \
+"    mat4 ShadowMat[4];" \
+"    vec4 CascadeSplits;" \
+"    vec4 CascadeTexel;" \
+"    vec4 ShadowParams;" \
+"};" \
+"uniform sampler2DArrayShadow ShadowMap;"
+
+#define UB_OBJECT_BLOCK_GLSL \
+"layout(std140) uniform ObjectBlock" \
+"{" \
+"    mat4 ModelMat;" \
+"};"
+
+// Uniform-Buffer für Kamera/Licht (einmal pro Frame), Objektdaten (pro Draw),
+// die Materialtabelle (beim Laden gefüllt, pro Draw nur noch ein Index) und die
+// Schattenkaskaden (von ShadowMaps pro Frame geschrieben).
+// Objektmatrizen landen in einem Ring-Buffer, jeder Draw bekommt eine Draw-ID und
+// bindet per glBindBufferRange nur seinen Ausschnitt. Die RenderQueue lädt die Matrizen
+// eines Passes vorab mit objects() in einer Übertragung; object() bindet dann nur noch
+// den vorab geladenen Ausschnitt. Die Bindungspunkte werden nach dem Linken über
+// bindProgram() gesetzt (GLSL 400 kennt kein layout(binding=...)).
+class UniformBlocks
+{
+public:
+    enum BINDINGS
+    {
+        FRAME_BINDING = 0,
+        OBJECT_BINDING = 1,
+        MATERIAL_BINDING = 2,
+        SHADOW_BINDING = 3
+    };
+    enum { SHADOW_TEXTURE_UNIT = 8 }; // ShadowMap-Sampler, oberhalb der Material-/Terrain-Units
+    enum { MAX_MATERIALS = 256 }; // 256 * 48 Byte, passt in die minimalen 16 KB eines UBO
+
+    static void init(unsigned int maxObjectsPerFrame = 4096);
+    static void release();
+
+    // nach glLinkProgram: FrameBlock/ObjectBlock an die festen Bindungspunkte hängen
+    static void bindProgram(GLuint program);
+
+    // einmal pro Frame vor dem ersten Draw: Kamera übernehmen, Objekt-Ring zurücksetzen
+    static void beginFrame(const BaseCamera& Cam, int viewportWidth, int viewportHeight);
+    // Kamera innerhalb eines Frames wechseln (lädt nur den Frame-Block neu)
+    static void camera(const BaseCamera& Cam);
+
+    static void lightPos(const Vector& pos);
+    static void lightColor(const Color& c);
+    static const Vector& lightPos() { return LightPos; }
+    static const Color& lightColor() { return LightColor; }
+    static const Vector& eyePos() { return EyePos; }
+
+    // ein Objekt: Bereich binden, Draw-ID zurückgeben. Ist ModelMat die nächste Matrix
+    // aus objects(), wird nichts übertragen, sonst wird sie einzeln hochgeladen.
+    static unsigned int object(const Matrix& ModelMat);
+    // viele Objekte mit einer Übertragung (pro Pass), liefert die erste Draw-ID;
+    // vor jedem Draw setzt nextObject(firstId + i) die Matrix, die object() erwartet
+    static unsigned int objects(const Matrix* pModelMats, unsigned int count);
+    static void nextObject(unsigned int drawId) { BatchNext = drawId; }
+
+    static unsigned int objectCount() { return ObjectCount; }
+
+    // Material eintragen (gleiche Werte teilen sich einen Eintrag), liefert den Index
+    // für MaterialBlock; ist die Tabelle voll, wird Eintrag 0 zurückgegeben
+    static unsigned int material(const Color& Diffuse, const Color& Specular, float SpecularExp,
+                                 const Color& Ambient);
+    static unsigned int materialCount() { return (unsigned int)(MaterialTable.size() / 12); }
+
+    struct ShadowData
+    {
+        float ShadowMat[4][16];
+        float CascadeSplits[4];
+        float CascadeTexel[4];
+        float ShadowParams[4];
+    };
+    // ShadowBlock ersetzen (ShadowMaps::update); nach init() gilt: keine Schatten
+    static void shadows(const ShadowData& Data);
+
+protected:
+    struct FrameData
+    {
+        float View[16];
+        float Proj[16];
+        float ViewProj[16];
+        float EyePos[4];
+        float LightPos[4];
+        float LightColor[4];
+        float Viewport[4];
+    };
+
+    static void uploadFrame();
+    static unsigned int reserve(unsigned int count);
+    static void bindObject(unsigned int drawId);
+
+    static FrameData Frame;
+    static Vector EyePos;
+    static Vector LightPos;
+    static Color LightColor;
+    static GLuint FrameUBO;
+    static GLuint ObjectUBO;
+    static GLuint MaterialUBO;
+    static GLuint ShadowUBO;
+    static std::vector<float> MaterialTable; // 12 floats (3 x vec4) pro Material
+    static unsigned int ObjectStride; // sizeof(mat4), auf GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT gerundet
+    static unsigned int MaxObjects;
+    static unsigned int ObjectCount;
+    static unsigned int BatchNext; // nächste noch nicht gebundene Draw-ID aus objects()
+    static unsigned int BatchEnd;
+    static std::vector<unsigned char> Staging;
+};
+
+#endif /* UniformBlocks_hpp */
@@ -7,6 +7,8 @@
 //
 
 #include "VertexBuffer.h"
+#include "GLDispatch.h"
+#include "GLState.h"
 #include <assert.h>
 
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
@@ -20,8 +22,9 @@ VertexBuffer::~VertexBuffer()
 {
     if(BuffersInitialized)
     {
-        glDeleteVertexArrays(1,&VAO);
-        glDeleteBuffers(1, &VBO);
+        GLState::vertexArrayDeleted(VAO);
+        GLDispatch::deleteVertexArrays(1,&VAO);
+        GLDispatch::deleteBuffers(1, &VBO);
     }
 }
 
@@ -29,8 +32,9 @@ void VertexBuffer::begin()
 {
     if(BuffersInitialized)
     {
-        glDeleteVertexArrays(1,&VAO);
-        glDeleteBuffers(1, &VBO);
+        GLState::vertexArrayDeleted(VAO);
+        GLDispatch::deleteVertexArrays(1,&VAO);
+        GLDispatch::deleteBuffers(1, &VBO);
     }
     BuffersInitialized = false;
     VertexCount = 0;
@@ -212,61 +216,61 @@ void VertexBuffer::end()
     }
     assert(  ((long)++Buffer-(long)ByteBuf)== BufferSize );
     
-    glGenBuffers (1, &VBO);
-    glBindBuffer (GL_ARRAY_BUFFER, VBO);
-    glBufferData (GL_ARRAY_BUFFER, BufferSize, ByteBuf, GL_STATIC_DRAW);
+    GLDispatch::genBuffers(1, &VBO);
+    GLDispatch::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLDispatch::bufferData(GL_ARRAY_BUFFER, BufferSize, ByteBuf, GL_STATIC_DRAW);
     
     delete [] ByteBuf;
     
     GLuint Offset = 0;
     GLuint Index = 0;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray (VAO);
-    glEnableVertexAttribArray (Index);
-    glVertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+    GLDispatch::genVertexArrays(1, &VAO);
+    GLState::bindVertexArray(VAO);
+    GLDispatch::enableVertexAttribArray(Index);
+    GLDispatch::vertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
     Offset += 4*sizeof(float);
     
     if(ActiveAttributes&NORMAL)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 4*sizeof(float);
     }
     if(ActiveAttributes&COLOR)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 4, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 4*sizeof(float);
     }
     if(ActiveAttributes&TEXCOORD0)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 3*sizeof(float);
     }
     if(ActiveAttributes&TEXCOORD1)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 3*sizeof(float);
     }
     if(ActiveAttributes&TEXCOORD2)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 3*sizeof(float);
     }
     if(ActiveAttributes&TEXCOORD3)
     {
-        glEnableVertexAttribArray (Index);
-        glVertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
+        GLDispatch::enableVertexAttribArray(Index);
+        GLDispatch::vertexAttribPointer(Index++, 3, GL_FLOAT, GL_FALSE, ElementSize, BUFFER_OFFSET(Offset));
         Offset += 3*sizeof(float);
     }
     
     BuffersInitialized = true;
     
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER,0);
+    GLState::bindVertexArray(0);
+    GLDispatch::bindBuffer(GL_ARRAY_BUFFER,0);
 }
 
 void VertexBuffer::activate()
@@ -277,13 +281,13 @@ void VertexBuffer::activate()
         return;
     }
     
-    //glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindVertexArray(VAO);
+    //GLDispatch::bindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::bindVertexArray(VAO);
     
 }
 
 void VertexBuffer::deactivate()
 {
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER,0);    
+    // VAO bleibt gebunden: der naechste Draw bindet ohnehin sein eigenes,
+    // ein Rueckbinden auf 0 waere pro Draw ein redundanter Aufruf
 }
@@ -0,0 +1,664 @@
+#include "VirtualTexture.h"
+#include "rgbimage.h"
+#include "color.h"
+#include "UniformBlocks.h"
+#include "GLState.h"
+#include "ImageKernels.h"
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+
+// .vtex: Header aus 8 uint32, danach alle Seiten (RGBA8, pageSize^2 Texel inkl. Rand)
+// von Level 0 (fein) bis zum groebsten Level, innerhalb eines Levels zeilenweise.
+static const uint32_t VTEX_MAGIC = 0x58455456; // "VTEX"
+static const uint32_t VTEX_VERSION = 1;
+static const unsigned int VTEX_HEADER_SIZE = 8 * sizeof(uint32_t);
+static const unsigned int VTEX_MAX_TILES = 256; // Feedback kodiert Tile x/y in 8 Bit
+
+static bool seekTo(FILE* pFile, uint64_t offset)
+{
+#ifdef WIN32
+    return _fseeki64(pFile, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(pFile, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// ------------------- Feedback-Shader -------------------
+
+VTFeedbackShader::VTFeedbackShader(const std::string& AssetDirectory) : Scaling(1,1,1), Bias(0)
+{
+    std::string VSFile = AssetDirectory + "vsterrain.glsl";
+    std::string FSFile = AssetDirectory + "fsvtfeedback.glsl";
+    if( !load(VSFile.c_str(), FSFile.c_str()))
+        throw std::exception();
+    ScalingLoc = getParameterID("Scaling");
+    ParamsLoc = getParameterID("VTParams");
+    BiasLoc = getParameterID("FeedbackBias");
+}
+
+void VTFeedbackShader::activate(const BaseCamera& Cam) const
+{
+    BaseShader::activate(Cam);
+    UniformBlocks::object(modelTransform());
+    setParameter(ScalingLoc, Scaling);
+    setParameter(ParamsLoc, Params);
+    setParameter(BiasLoc, Bias);
+}
+
+// ------------------- Builder -------------------
+
+namespace
+{
+    // Streamt die Zeilen eines Levels, schreibt jede fertige Tile-Zeile als Seiten
+    // und reicht 2x2-gemittelte Zeilen an das naechstgroebere Level weiter.
+    struct LevelWriter
+    {
+        unsigned int Size, Tiles;
+        uint64_t FirstPage;
+        unsigned int RowsReceived;
+        unsigned int FirstRow;  // Zeilenindex von Rows.front()
+        unsigned int NextTileRow;
+        std::deque<std::vector<unsigned char> > Rows;
+        std::vector<unsigned char> Pending;
+        bool HasPending;
+    };
+}
+
+static bool pushRow(std::vector<LevelWriter>& levels, unsigned int l, std::vector<unsigned char>& row,
+                    FILE* pFile, unsigned int tileSize, unsigned int border, std::vector<unsigned char>& page)
+{
+    LevelWriter& L = levels[l];
+    const unsigned int ps = tileSize + 2 * border;
+    const uint64_t pageBytes = (uint64_t)ps * ps * 4;
+
+    // an naechstes Level weiterreichen (vor dem Verschieben der Zeile)
+    if (l + 1 < levels.size()) {
+        if (!L.HasPending) {
+            L.Pending = row;
+            L.HasPending = true;
+        } else {
+            const unsigned int half = L.Size / 2;
+            std::vector<unsigned char> down(half * 4);
+            for (unsigned int x = 0; x < half; ++x)
+                for (unsigned int c = 0; c < 4; ++c) {
+                    unsigned int s = L.Pending[(2 * x) * 4 + c] + L.Pending[(2 * x + 1) * 4 + c] +
+                                     row[(2 * x) * 4 + c] + row[(2 * x + 1) * 4 + c];
+                    down[x * 4 + c] = (unsigned char)((s + 2) / 4);
+                }
+            L.HasPending = false;
+            if (!pushRow(levels, l + 1, down, pFile, tileSize, border, page))
+                return false;
+        }
+    }
+
+    L.Rows.push_back(std::vector<unsigned char>());
+    L.Rows.back().swap(row);
+    L.RowsReceived++;
+
+    // alle Tile-Zeilen schreiben, deren Rand-Zeilen vollstaendig vorliegen
+    while (L.NextTileRow < L.Tiles) {
+        const unsigned int lastNeeded = std::min((L.NextTileRow + 1) * tileSize + border, L.Size) - 1;
+        if (lastNeeded >= L.RowsReceived)
+            break;
+
+        const int y0 = (int)(L.NextTileRow * tileSize) - (int)border;
+        for (unsigned int tx = 0; tx < L.Tiles; ++tx) {
+            const int x0 = (int)(tx * tileSize) - (int)border;
+            for (unsigned int py = 0; py < ps; ++py) {
+                const int sy = std::min(std::max(y0 + (int)py, 0), (int)L.Size - 1);
+                const unsigned char* src = &L.Rows[sy - L.FirstRow][0];
+                unsigned char* dst = &page[(size_t)py * ps * 4];
+                for (unsigned int px = 0; px < ps; ++px) {
+                    const int sx = std::min(std::max(x0 + (int)px, 0), (int)L.Size - 1);
+                    memcpy(dst + px * 4, src + sx * 4, 4);
+                }
+            }
+            const uint64_t index = L.FirstPage + (uint64_t)L.NextTileRow * L.Tiles + tx;
+            if (!seekTo(pFile, VTEX_HEADER_SIZE + index * pageBytes) ||
+                fwrite(&page[0], 1, (size_t)pageBytes, pFile) != pageBytes)
+                return false;
+        }
+        L.NextTileRow++;
+
+        // Zeilen verwerfen, die keine folgende Tile-Zeile mehr braucht
+        const int keepFrom = (int)(L.NextTileRow * tileSize) - (int)border;
+        while (!L.Rows.empty() && (int)L.FirstRow < keepFrom) {
+            L.Rows.pop_front();
+            L.FirstRow++;
+        }
+    }
+    return true;
+}
+
+bool VirtualTexture::build(const char* Filename, unsigned int size, const RowSource& source,
+                           unsigned int tileSize, unsigned int border)
+{
+    if (tileSize == 0 || size < tileSize || size % tileSize != 0) {
+        std::cout << "VirtualTexture: size muss ein Vielfaches von tileSize sein" << std::endl;
+        return false;
+    }
+    const unsigned int tiles = size / tileSize;
+    if ((tiles & (tiles - 1)) != 0 || tiles > VTEX_MAX_TILES) {
+        std::cout << "VirtualTexture: Tiles pro Achse muessen 2^n und <= " << VTEX_MAX_TILES << " sein" << std::endl;
+        return false;
+    }
+
+    unsigned int levels = 1;
+    while ((tiles >> (levels - 1)) > 1) levels++;
+
+    FILE* pFile = fopen(Filename, "wb");
+    if (!pFile)
+        return false;
+
+    uint32_t header[8] = { VTEX_MAGIC, VTEX_VERSION, size, tileSize, border, levels, tiles, 0 };
+    fwrite(header, sizeof(uint32_t), 8, pFile);
+
+    std::vector<LevelWriter> writers(levels);
+    uint64_t firstPage = 0;
+    for (unsigned int l = 0; l < levels; ++l) {
+        LevelWriter& L = writers[l];
+        L.Size = size >> l;
+        L.Tiles = tiles >> l;
+        L.FirstPage = firstPage;
+        L.RowsReceived = L.FirstRow = L.NextTileRow = 0;
+        L.HasPending = false;
+        firstPage += (uint64_t)L.Tiles * L.Tiles;
+    }
+
+    const unsigned int ps = tileSize + 2 * border;
+    std::vector<unsigned char> page((size_t)ps * ps * 4);
+    // eine Tile-Zeile am Stueck parallel erzeugen, danach seriell in die Level schreiben
+    const size_t rowBytes = (size_t)size * 4;
+    std::vector<unsigned char> band((size_t)tileSize * rowBytes);
+    std::vector<unsigned char> row;
+    bool ok = true;
+    for (unsigned int y0 = 0; y0 < size && ok; y0 += tileSize) {
+        std::fill(band.begin(), band.end(), (unsigned char)255);
+        ImageKernels::parallelRows(tileSize, [&](unsigned int first, unsigned int end) {
+            for (unsigned int r = first; r < end; ++r)
+                source(y0 + r, &band[r * rowBytes]);
+        });
+        for (unsigned int r = 0; r < tileSize && ok; ++r) {
+            // pushRow uebernimmt den Puffer per swap, daher jedes Mal neu fuellen
+            row.assign(band.begin() + r * rowBytes, band.begin() + (r + 1) * rowBytes);
+            ok = pushRow(writers, 0, row, pFile, tileSize, border, page);
+        }
+    }
+
+    fclose(pFile);
+    if (!ok)
+        std::cout << "VirtualTexture: Schreiben von " << Filename << " fehlgeschlagen" << std::endl;
+    return ok;
+}
+
+bool VirtualTexture::build(const char* Filename, const RGBImage& img, unsigned int size,
+                           unsigned int tileSize, unsigned int border)
+{
+    if (img.width() == 0 || img.height() == 0)
+        return false;
+    // Quelle bilinear auf size x size abtasten
+    return build(Filename, size, [&img, size](unsigned int y, unsigned char* rgba) {
+        const float fy = std::max(0.0f, (y + 0.5f) * img.height() / size - 0.5f);
+        const unsigned int y0 = std::min((unsigned int)fy, img.height() - 1);
+        const unsigned int y1 = std::min(y0 + 1, img.height() - 1);
+        const float ty = fy - (float)y0;
+        for (unsigned int x = 0; x < size; ++x) {
+            const float fx = std::max(0.0f, (x + 0.5f) * img.width() / size - 0.5f);
+            const unsigned int x0 = std::min((unsigned int)fx, img.width() - 1);
+            const unsigned int x1 = std::min(x0 + 1, img.width() - 1);
+            const float tx = fx - (float)x0;
+            Color c = (img.getPixelColor(x0, y0) * (1 - tx) + img.getPixelColor(x1, y0) * tx) * (1 - ty) +
+                      (img.getPixelColor(x0, y1) * (1 - tx) + img.getPixelColor(x1, y1) * tx) * ty;
+            rgba[x * 4 + 0] = RGBImage::convertColorChannel(c.R);
+            rgba[x * 4 + 1] = RGBImage::convertColorChannel(c.G);
+            rgba[x * 4 + 2] = RGBImage::convertColorChannel(c.B);
+            rgba[x * 4 + 3] = 255;
+        }
+    }, tileSize, border);
+}
+
+// ------------------- Laufzeit -------------------
+
+VirtualTexture::VirtualTexture()
+    : Tiles(0), Levels(0), TileSize(0), Border(0), AtlasPages(0), Frame(0), TableDirty(false),
+      UploadBudget(8), RequestBudget(32), PagesLoaded(0), PagesEvicted(0),
+      AtlasTex(0), PageTableTex(0), FeedbackFBO(0), FeedbackColor(0), FeedbackDepth(0),
+      FeedbackW(0), FeedbackH(0), FeedbackScale(8), FeedbackIndex(0), CurrentSlot(0), pFeedbackShader(NULL), Quit(false)
+{
+    FeedbackPBO[0] = FeedbackPBO[1] = 0;
+    FeedbackFence[0] = FeedbackFence[1] = 0;
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    close();
+}
+
+bool VirtualTexture::open(const char* File, const std::string& AssetDirectory, unsigned int atlasPages)
+{
+    close();
+
+    FILE* pFile = fopen(File, "rb");
+    if (!pFile) {
+        std::cout << "VirtualTexture: " << File << " nicht gefunden" << std::endl;
+        return false;
+    }
+    uint32_t header[8];
+    if (fread(header, sizeof(uint32_t), 8, pFile) != 8 || header[0] != VTEX_MAGIC || header[1] != VTEX_VERSION ||
+        header[6] == 0 || header[6] > VTEX_MAX_TILES || header[5] == 0) {
+        std::cout << "VirtualTexture: " << File << " ist keine gueltige .vtex-Datei" << std::endl;
+        fclose(pFile);
+        return false;
+    }
+
+    Filename = File;
+    TileSize = header[3];
+    Border = header[4];
+    Levels = header[5];
+    Tiles = header[6];
+    AtlasPages = std::min(std::max(atlasPages, 2u), 255u);
+
+    LevelOffset.resize(Levels + 1);
+    LevelOffset[0] = 0;
+    for (unsigned int l = 0; l < Levels; ++l)
+        LevelOffset[l + 1] = LevelOffset[l] + (Tiles >> l) * (Tiles >> l);
+
+    const unsigned int pageCount = LevelOffset[Levels];
+    PageSlot.assign(pageCount, -1);
+    PageSeen.assign(pageCount, 0);
+    PageInFlight.assign(pageCount, 0);
+
+    Slots.resize(AtlasPages * AtlasPages);
+    FreeSlots.clear();
+    for (int i = (int)Slots.size() - 1; i >= 0; --i) {
+        Slots[i].Page = -1;
+        Slots[i].LastUsed = 0;
+        Slots[i].Pinned = false;
+        FreeSlots.push_back(i);
+    }
+
+    // physischer Atlas: feste Groesse, unabhaengig von der Quelltextur
+    const unsigned int atlasSize = AtlasPages * pageSize();
+    glGenTextures(1, &AtlasTex);
+    GLState::bindForUpload(AtlasTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    // Page-Table: Mip-Stufe l = Level l
+    TableData.resize(Levels);
+    glGenTextures(1, &PageTableTex);
+    GLState::bindForUpload(PageTableTex);
+    for (unsigned int l = 0; l < Levels; ++l) {
+        const unsigned int t = Tiles >> l;
+        TableData[l].assign((size_t)t * t * 4, 0);
+        glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA8, t, t, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, Levels - 1);
+
+    // groebste Seite synchron laden und festhalten -> es gibt immer einen Fallback
+    std::vector<unsigned char> data;
+    const unsigned int root = pageIndex(Levels - 1, 0, 0);
+    if (!readPage(pFile, root, data) || !uploadPage(root, data, true)) {
+        std::cout << "VirtualTexture: " << File << " ist unvollstaendig" << std::endl;
+        fclose(pFile);
+        close();
+        return false;
+    }
+    fclose(pFile);
+    rebuildPageTable();
+
+    pFeedbackShader = new VTFeedbackShader(AssetDirectory);
+
+    Quit = false;
+    Worker = std::thread(&VirtualTexture::workerLoop, this);
+
+    std::cout << "VirtualTexture: " << (Tiles * TileSize) << "^2 Texel, " << Levels << " Level, Atlas "
+              << atlasSize << "^2 (" << (atlasSize * atlasSize * 4 / (1024 * 1024)) << " MB)" << std::endl;
+    return true;
+}
+
+void VirtualTexture::close()
+{
+    if (Worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Quit = true;
+            Requests.clear();
+        }
+        Cond.notify_all();
+        Worker.join();
+    }
+    for (size_t i = 0; i < Completed.size(); ++i)
+        delete Completed[i];
+    Completed.clear();
+
+    for (int i = 0; i < 2; ++i) {
+        if (FeedbackFence[i]) glDeleteSync(FeedbackFence[i]);
+        FeedbackFence[i] = 0;
+    }
+    if (FeedbackPBO[0]) glDeleteBuffers(2, FeedbackPBO);
+    if (FeedbackFBO) glDeleteFramebuffers(1, &FeedbackFBO);
+    if (FeedbackColor) { GLState::textureDeleted(FeedbackColor); glDeleteTextures(1, &FeedbackColor); }
+    if (FeedbackDepth) glDeleteRenderbuffers(1, &FeedbackDepth);
+    if (AtlasTex) { GLState::textureDeleted(AtlasTex); glDeleteTextures(1, &AtlasTex); }
+    if (PageTableTex) { GLState::textureDeleted(PageTableTex); glDeleteTextures(1, &PageTableTex); }
+    FeedbackPBO[0] = FeedbackPBO[1] = 0;
+    FeedbackFBO = FeedbackColor = FeedbackDepth = AtlasTex = PageTableTex = 0;
+    FeedbackW = FeedbackH = 0;
+
+    delete pFeedbackShader;
+    pFeedbackShader = NULL;
+
+    PageSlot.clear();
+    PageSeen.clear();
+    PageInFlight.clear();
+    Slots.clear();
+    FreeSlots.clear();
+    TableData.clear();
+}
+
+unsigned int VirtualTexture::pageIndex(unsigned int level, unsigned int x, unsigned int y) const
+{
+    return LevelOffset[level] + y * (Tiles >> level) + x;
+}
+
+bool VirtualTexture::readPage(FILE* pFile, unsigned int page, std::vector<unsigned char>& data) const
+{
+    const uint64_t pageBytes = (uint64_t)pageSize() * pageSize() * 4;
+    data.resize((size_t)pageBytes);
+    return seekTo(pFile, VTEX_HEADER_SIZE + (uint64_t)page * pageBytes) &&
+           fread(&data[0], 1, (size_t)pageBytes, pFile) == pageBytes;
+}
+
+int VirtualTexture::allocSlot()
+{
+    if (!FreeSlots.empty()) {
+        int slot = FreeSlots.back();
+        FreeSlots.pop_back();
+        return slot;
+    }
+    // LRU: laengste nicht mehr angeforderte Seite verdraengen (nie eine aus dem aktuellen Feedback)
+    int best = -1;
+    for (size_t i = 0; i < Slots.size(); ++i) {
+        const PhysPage& p = Slots[i];
+        if (p.Pinned || p.LastUsed >= Frame)
+            continue;
+        if (best < 0 || p.LastUsed < Slots[best].LastUsed)
+            best = (int)i;
+    }
+    if (best >= 0 && Slots[best].Page >= 0) {
+        PageSlot[Slots[best].Page] = -1;
+        Slots[best].Page = -1;
+        PagesEvicted++;
+        TableDirty = true;
+    }
+    return best;
+}
+
+bool VirtualTexture::uploadPage(unsigned int page, const std::vector<unsigned char>& data, bool pin)
+{
+    if (PageSlot[page] >= 0)
+        return true;
+    const int slot = allocSlot();
+    if (slot < 0)
+        return false;
+
+    const unsigned int ps = pageSize();
+    GLState::bindForUpload(AtlasTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % AtlasPages) * ps, (slot / AtlasPages) * ps, ps, ps,
+                    GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
+
+    Slots[slot].Page = (int)page;
+    Slots[slot].LastUsed = Frame;
+    Slots[slot].Pinned = pin;
+    PageSlot[page] = slot;
+    PagesLoaded++;
+    TableDirty = true;
+    return true;
+}
+
+void VirtualTexture::touch(unsigned int page)
+{
+    Slots[PageSlot[page]].LastUsed = Frame;
+}
+
+unsigned int VirtualTexture::residentPages() const
+{
+    return (unsigned int)(Slots.size() - FreeSlots.size());
+}
+
+void VirtualTexture::beginFeedback(int viewportWidth, int viewportHeight)
+{
+    if (!isValid())
+        return;
+
+    const unsigned int w = std::max(1u, (unsigned int)viewportWidth / FeedbackScale);
+    const unsigned int h = std::max(1u, (unsigned int)viewportHeight / FeedbackScale);
+    if (w != FeedbackW || h != FeedbackH) {
+        if (!FeedbackFBO) {
+            glGenFramebuffers(1, &FeedbackFBO);
+            glGenTextures(1, &FeedbackColor);
+            glGenRenderbuffers(1, &FeedbackDepth);
+            glGenBuffers(2, FeedbackPBO);
+        }
+        GLState::bindForUpload(FeedbackColor);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindRenderbuffer(GL_RENDERBUFFER, FeedbackDepth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FeedbackFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, FeedbackColor, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, FeedbackDepth);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        for (int i = 0; i < 2; ++i) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, FeedbackPBO[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, w * h * 4, NULL, GL_STREAM_READ);
+            if (FeedbackFence[i]) glDeleteSync(FeedbackFence[i]);
+            FeedbackFence[i] = 0;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        FeedbackW = w;
+        FeedbackH = h;
+    }
+
+    float bias = 0.0f;
+    for (unsigned int s = FeedbackScale; s > 1; s >>= 1) bias += 1.0f;
+    pFeedbackShader->params((float)Tiles, (float)(Levels - 1), (float)TileSize, bias);
+
+    glGetIntegerv(GL_VIEWPORT, SavedViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, FeedbackFBO);
+    glViewport(0, 0, FeedbackW, FeedbackH);
+    GLState::disable(GL_BLEND);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::endFeedback()
+{
+    if (!isValid())
+        return;
+
+    // asynchron in den PBO lesen, ausgewertet wird ein Frame spaeter in update()
+    const unsigned int i = FeedbackIndex;
+    if (FeedbackFence[i]) glDeleteSync(FeedbackFence[i]);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, FeedbackPBO[i]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, FeedbackW, FeedbackH, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    FeedbackFence[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    FeedbackIndex ^= 1;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(SavedViewport[0], SavedViewport[1], SavedViewport[2], SavedViewport[3]);
+    GLState::enable(GL_BLEND);
+}
+
+void VirtualTexture::update()
+{
+    if (!isValid())
+        return;
+    Frame++;
+
+    // 1. Feedback des Vorframes auswerten (nicht blockierend)
+    const unsigned int i = FeedbackIndex;
+    if (FeedbackFence[i]) {
+        GLenum r = glClientWaitSync(FeedbackFence[i], 0, 0);
+        if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) {
+            glDeleteSync(FeedbackFence[i]);
+            FeedbackFence[i] = 0;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, FeedbackPBO[i]);
+            const unsigned char* pixels = (const unsigned char*)glMapBufferRange(
+                GL_PIXEL_PACK_BUFFER, 0, FeedbackW * FeedbackH * 4, GL_MAP_READ_BIT);
+            if (pixels) {
+                processFeedback(pixels, FeedbackW * FeedbackH);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+    }
+
+    // 2. vom Worker geladene Seiten hochladen (Budget pro Frame)
+    std::vector<LoadedPage*> ready;
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        const size_t n = std::min<size_t>(Completed.size(), UploadBudget);
+        ready.assign(Completed.begin(), Completed.begin() + n);
+        Completed.erase(Completed.begin(), Completed.begin() + n);
+    }
+    for (size_t k = 0; k < ready.size(); ++k) {
+        LoadedPage* p = ready[k];
+        if (!p->Data.empty())
+            uploadPage(p->Page, p->Data, false); // kein Slot frei: Seite wird spaeter erneut angefordert
+        PageInFlight[p->Page] = 0;
+        delete p;
+    }
+
+    // 3. Page-Table nur bei Aenderungen neu aufbauen
+    if (TableDirty)
+        rebuildPageTable();
+}
+
+void VirtualTexture::processFeedback(const unsigned char* pixels, unsigned int count)
+{
+    std::vector<unsigned int> wanted;
+    for (unsigned int p = 0; p < count; ++p, pixels += 4) {
+        if (pixels[3] == 0)
+            continue; // kein Terrain
+        unsigned int level = std::min<unsigned int>(pixels[2], Levels - 1);
+        unsigned int x = std::min<unsigned int>(pixels[0], (Tiles >> level) - 1);
+        unsigned int y = std::min<unsigned int>(pixels[1], (Tiles >> level) - 1);
+
+        // Seite und alle Vorfahren anfordern, damit der Fallback schrittweise feiner wird
+        for (;;) {
+            const unsigned int page = pageIndex(level, x, y);
+            if (PageSeen[page] == Frame)
+                break;
+            PageSeen[page] = Frame;
+            if (PageSlot[page] >= 0)
+                touch(page);
+            else if (!PageInFlight[page])
+                wanted.push_back(page);
+            if (++level >= Levels)
+                break;
+            x >>= 1;
+            y >>= 1;
+        }
+    }
+
+    // grobe Level zuerst (hoeherer Seitenindex = groeberes Level)
+    std::sort(wanted.begin(), wanted.end(), std::greater<unsigned int>());
+    if (wanted.size() > RequestBudget)
+        wanted.resize(RequestBudget);
+
+    std::lock_guard<std::mutex> lock(Mutex);
+    // noch nicht begonnene Anforderungen aus dem Vorframe sind veraltet
+    for (size_t k = 0; k < Requests.size(); ++k)
+        PageInFlight[Requests[k]] = 0;
+    Requests.assign(wanted.begin(), wanted.end());
+    for (size_t k = 0; k < wanted.size(); ++k)
+        PageInFlight[wanted[k]] = 1;
+    if (!wanted.empty())
+        Cond.notify_one();
+}
+
+void VirtualTexture::rebuildPageTable()
+{
+    // von grob nach fein: nicht geladene Tiles erben den Eintrag des Eltern-Tiles
+    for (int l = (int)Levels - 1; l >= 0; --l) {
+        const unsigned int t = Tiles >> l;
+        std::vector<unsigned char>& dst = TableData[l];
+        for (unsigned int y = 0; y < t; ++y)
+            for (unsigned int x = 0; x < t; ++x) {
+                unsigned char* e = &dst[(y * t + x) * 4];
+                const int slot = PageSlot[pageIndex(l, x, y)];
+                if (slot >= 0) {
+                    e[0] = (unsigned char)(slot % AtlasPages);
+                    e[1] = (unsigned char)(slot / AtlasPages);
+                    e[2] = (unsigned char)l;
+                    e[3] = 255;
+                } else if (l + 1 < (int)Levels) {
+                    memcpy(e, &TableData[l + 1][((y / 2) * (t / 2) + x / 2) * 4], 4);
+                }
+            }
+    }
+
+    GLState::bindForUpload(PageTableTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (unsigned int l = 0; l < Levels; ++l)
+        glTexSubImage2D(GL_TEXTURE_2D, l, 0, 0, Tiles >> l, Tiles >> l, GL_RGBA, GL_UNSIGNED_BYTE, &TableData[l][0]);
+    TableDirty = false;
+}
+
+void VirtualTexture::workerLoop()
+{
+    FILE* pFile = fopen(Filename.c_str(), "rb");
+    std::unique_lock<std::mutex> lock(Mutex);
+    for (;;) {
+        while (Requests.empty() && !Quit)
+            Cond.wait(lock);
+        if (Quit)
+            break;
+
+        const unsigned int page = Requests.front();
+        Requests.pop_front();
+        lock.unlock();
+
+        LoadedPage* p = new LoadedPage();
+        p->Page = page;
+        if (!pFile || !readPage(pFile, page, p->Data))
+            p->Data.clear();
+
+        lock.lock();
+        Completed.push_back(p);
+    }
+    lock.unlock();
+    if (pFile)
+        fclose(pFile);
+}
+
+void VirtualTexture::activate(int slot) const
+{
+    CurrentSlot = slot;
+    GLState::bindTexture(slot, AtlasTex);
+    GLState::bindTexture(slot + 1, PageTableTex);
+}
+
+void VirtualTexture::deactivate() const
+{
+    // wie Texture::deactivate: Bindungen bleiben stehen (GLState)
+    CurrentSlot = 0;
+}
@@ -0,0 +1,164 @@
+#ifndef VirtualTexture_hpp
+#define VirtualTexture_hpp
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdio>
+#include "BaseShader.h"
+
+class RGBImage;
+
+// Shader fuer den Feedback-Pass: schreibt pro Fragment die benoetigte Seite
+// (Tile x/y und Mip-Level) in einen kleinen RGBA8-Framebuffer.
+class VTFeedbackShader : public BaseShader
+{
+public:
+    VTFeedbackShader(const std::string& AssetDirectory);
+    virtual ~VTFeedbackShader() {}
+    virtual void activate(const BaseCamera& Cam) const;
+
+    void scaling(const Vector& s) { Scaling = s; }
+    // tiles = Tiles pro Achse auf Level 0, bias = log2(Feedback-Verkleinerung)
+    void params(float tiles, float maxLevel, float tileSize, float bias) { Params = Vector(tiles, maxLevel, tileSize); Bias = bias; }
+
+private:
+    Vector Scaling;
+    Vector Params;
+    float Bias;
+    GLint ScalingLoc;
+    GLint ParamsLoc;
+    GLint BiasLoc;
+};
+
+// Virtuelle Textur: eine sehr grosse Textur (z.B. 32k^2) liegt gekachelt in einer
+// .vtex-Datei. Sichtbare Seiten werden ueber einen Feedback-Pass ermittelt, von einem
+// Worker-Thread gelesen und in einen Atlas fester Groesse (Physical Pages, LRU)
+// geladen. Eine Page-Table-Textur (eine Mip-Stufe pro Level) verweist pro Tile auf die
+// Atlas-Seite bzw. auf den naechsten geladenen Vorfahren. Der GPU-Speicher haengt
+// damit nur von der Atlasgroesse ab, nicht von der Groesse der Quelltextur.
+class VirtualTexture
+{
+public:
+    // Liefert Zeile y (0..size-1) der Level-0-Textur als RGBA8 (size*4 Bytes).
+    // Wird fuer ein Zeilenband parallel aufgerufen, muss also threadsicher sein.
+    typedef std::function<void(unsigned int y, unsigned char* rgbaRow)> RowSource;
+
+    // .vtex schreiben: size = tileSize * 2^n, hoechstens 256 Tiles pro Achse.
+    // Die Mip-Stufen werden zeilenweise mitgerechnet (Speicher ~ Zeilenband, nicht size^2).
+    static bool build(const char* Filename, unsigned int size, const RowSource& source,
+                      unsigned int tileSize = 128, unsigned int border = 4);
+    static bool build(const char* Filename, const RGBImage& img, unsigned int size,
+                      unsigned int tileSize = 128, unsigned int border = 4);
+
+    VirtualTexture();
+    ~VirtualTexture();
+
+    // atlasPages^2 physische Seiten (<= 255 pro Achse)
+    bool open(const char* Filename, const std::string& AssetDirectory, unsigned int atlasPages = 16);
+    void close();
+    bool isValid() const { return AtlasTex != 0; }
+
+    // Feedback-Pass: zwischen begin/end die Geometrie mit feedbackShader() zeichnen
+    void beginFeedback(int viewportWidth, int viewportHeight);
+    void endFeedback();
+    VTFeedbackShader* feedbackShader() { return pFeedbackShader; }
+
+    // einmal pro Frame: Feedback auswerten, geladene Seiten hochladen, Page-Table aktualisieren
+    void update();
+
+    // Atlas auf Einheit slot, Page-Table auf slot+1
+    void activate(int slot) const;
+    void deactivate() const;
+
+    // Shader-Parameter
+    unsigned int tiles() const { return Tiles; }
+    unsigned int levels() const { return Levels; }
+    unsigned int tileSize() const { return TileSize; }
+    unsigned int border() const { return Border; }
+    unsigned int pageSize() const { return TileSize + 2 * Border; }
+    unsigned int atlasPages() const { return AtlasPages; }
+
+    // Statistik
+    unsigned int residentPages() const;
+    unsigned int pagesLoaded() const { return PagesLoaded; }
+    unsigned int pagesEvicted() const { return PagesEvicted; }
+
+    // Seiten, die pro Frame hochgeladen bzw. angefordert werden
+    void uploadBudget(unsigned int pages) { UploadBudget = pages; }
+    void requestBudget(unsigned int pages) { RequestBudget = pages; }
+
+protected:
+    struct PhysPage
+    {
+        int Page;              // Index in PageSlot oder -1
+        unsigned int LastUsed; // Frame der letzten Anforderung
+        bool Pinned;
+    };
+    struct LoadedPage
+    {
+        unsigned int Page;
+        std::vector<unsigned char> Data;
+    };
+
+    unsigned int pageIndex(unsigned int level, unsigned int x, unsigned int y) const;
+    bool readPage(FILE* pFile, unsigned int page, std::vector<unsigned char>& data) const;
+    bool uploadPage(unsigned int page, const std::vector<unsigned char>& data, bool pin);
+    int allocSlot();
+    void touch(unsigned int page);
+    void processFeedback(const unsigned char* pixels, unsigned int count);
+    void rebuildPageTable();
+    void workerLoop();
+
+    // Dateiformat
+    std::string Filename;
+    unsigned int Tiles;     // Tiles pro Achse auf Level 0
+    unsigned int Levels;
+    unsigned int TileSize;
+    unsigned int Border;
+    std::vector<unsigned int> LevelOffset; // erster Seitenindex pro Level
+
+    // Residenz
+    std::vector<int> PageSlot;               // Seite -> physischer Slot oder -1
+    std::vector<unsigned int> PageSeen;      // Frame der letzten Anforderung (Deduplizierung)
+    std::vector<unsigned char> PageInFlight; // angefordert, noch nicht hochgeladen
+    std::vector<PhysPage> Slots;
+    std::vector<int> FreeSlots;
+    std::vector<std::vector<unsigned char> > TableData; // CPU-Kopie der Page-Table pro Level
+    unsigned int AtlasPages;
+    unsigned int Frame;
+    bool TableDirty;
+    unsigned int UploadBudget;
+    unsigned int RequestBudget;
+    unsigned int PagesLoaded;
+    unsigned int PagesEvicted;
+
+    // GL
+    GLuint AtlasTex;
+    GLuint PageTableTex;
+    GLuint FeedbackFBO;
+    GLuint FeedbackColor;
+    GLuint FeedbackDepth;
+    GLuint FeedbackPBO[2];
+    GLsync FeedbackFence[2];
+    unsigned int FeedbackW, FeedbackH;
+    unsigned int FeedbackScale;
+    unsigned int FeedbackIndex;
+    GLint SavedViewport[4];
+    mutable int CurrentSlot;
+    VTFeedbackShader* pFeedbackShader;
+
+    // Worker
+    std::thread Worker;
+    std::mutex Mutex;
+    std::condition_variable Cond;
+    std::deque<unsigned int> Requests;
+    std::vector<LoadedPage*> Completed;
+    bool Quit;
+};
+
+#endif /* VirtualTexture_hpp */
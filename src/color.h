@@ -2,7 +2,9 @@
 #define __SimpleRayTracer__color__
 
 #include <iostream>
+#include <type_traits>
 
+// Wertetyp wie Vector: inline und constexpr, Standardfarben entstehen zur Compilezeit
 class Color
 {
 public:
@@ -10,12 +12,17 @@ public:
     float G;
     float B;
     
-    Color();
-    Color( float r, float g, float b);
-    Color operator*(const Color& c) const;
-    Color operator*(const float Factor) const;
-    Color operator+(const Color& c) const;
-    Color& operator+=(const Color& c);
+    constexpr Color() noexcept : R(0), G(0), B(0) {}
+    constexpr Color( float r, float g, float b) noexcept : R(r), G(g), B(b) {}
+    constexpr Color operator*(const Color& c) const noexcept { return Color(R * c.R, G * c.G, B * c.B); }
+    constexpr Color operator*(const float Factor) const noexcept { return Color(R * Factor, G * Factor, B * Factor); }
+    constexpr Color operator+(const Color& c) const noexcept { return Color(R + c.R, G + c.G, B + c.B); }
+    Color& operator+=(const Color& c) noexcept { R += c.R; G += c.G; B += c.B; return *this; }
 };
 
+static_assert(sizeof(Color) == 3 * sizeof(float), "Color must be three packed floats");
+static_assert(std::is_standard_layout<Color>::value, "Color must have standard layout");
+static_assert(std::is_trivially_copyable<Color>::value, "Color must be trivially copyable");
+static_assert(std::is_nothrow_move_constructible<Color>::value, "Color moves must not throw");
+
 #endif /* defined(__SimpleRayTracer__color__) */
@@ -7,19 +7,81 @@
 #include <glfw/glfw3.h>
 #endif
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
 #include "Application.h"
 #include "freeimage.h"
+#include "baseshader.h"
+#include "MathBench.h"
+#include "GLDispatch.h"
 
 void PrintOpenGLVersion();
+void PrintFrameReport(const std::vector<double>& FrameMs, float Dt);
 
 
-int main() {
+int main(int argc, char** argv) {
+    // --check-math / --bench-math: nur die Mathe-Tests, ohne Fenster und GL
+    const int MathResult = MathBench::run(argc, argv);
+    if (MathResult >= 0)
+        return MathResult;
+
+    // --headless: unsichtbares Fenster, feste Anzahl Frames mit festem dt, danach
+    // Zeitbericht und Ende (Benchmarks/Regressionstests auf Build-Rechnern)
+    bool Headless = false;
+    unsigned int HeadlessFrames = 300;
+    float HeadlessDt = 1.0f / 60.0f;
+    int HeadlessWidth = 800, HeadlessHeight = 600;  // --size WxH
+    // --no-prepass / --no-queue: ohne Depth-Pre-Pass (F8) bzw. in Listenreihenfolge (F9)
+    // starten, fuer Vergleichsmessungen
+    bool Prepass = true;
+    bool UseQueue = true;
+    // --bake-vt: virtuelle Textur des Terrains offline backen und beenden
+    bool BakeVT = false;
+    // --gl real|noop|record|record-noop: Backend von GLDispatch, --gl-log: CSV pro Frame
+    GLDispatch::BACKEND GLBackend = GLDispatch::REAL, GLTarget = GLDispatch::REAL;
+    const char* GLLog = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) Headless = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) HeadlessFrames = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--dt") == 0 && i + 1 < argc) HeadlessDt = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) sscanf(argv[++i], "%dx%d", &HeadlessWidth, &HeadlessHeight);
+        else if (strcmp(argv[i], "--no-prepass") == 0) Prepass = false;
+        else if (strcmp(argv[i], "--no-queue") == 0) UseQueue = false;
+        else if (strcmp(argv[i], "--bake-vt") == 0) BakeVT = true;
+        else if (strcmp(argv[i], "--gl-log") == 0 && i + 1 < argc) GLLog = argv[++i];
+        else if (strcmp(argv[i], "--gl") == 0 && i + 1 < argc) {
+            const char* Name = argv[++i];
+            if (strcmp(Name, "noop") == 0) GLBackend = GLTarget = GLDispatch::NOOP;
+            else if (strcmp(Name, "record") == 0) GLBackend = GLDispatch::RECORD;
+            else if (strcmp(Name, "record-noop") == 0) { GLBackend = GLDispatch::RECORD; GLTarget = GLDispatch::NOOP; }
+            else if (strcmp(Name, "real") != 0) fprintf(stderr, "unbekanntes GL-Backend %s, nehme real\n", Name);
+        }
+    }
+    // ein Log ohne Aufzeichnung waere leer
+    if (GLLog && GLBackend != GLDispatch::RECORD) {
+        GLTarget = GLBackend;
+        GLBackend = GLDispatch::RECORD;
+    }
+    if (HeadlessDt <= 0) HeadlessDt = 1.0f / 60.0f;
+    if (HeadlessWidth <= 0 || HeadlessHeight <= 0) HeadlessWidth = 800, HeadlessHeight = 600;
+    // Backen braucht nur den GL-Kontext fuer die Detail-Texturen, kein sichtbares Fenster
+    if (BakeVT) {
+        Headless = true;
+        HeadlessFrames = 0;
+    }
+
     FreeImage_Initialise();
     // start GL context and O/S window using the GLFW helper library
     if (!glfwInit()) {
         fprintf(stderr, "ERROR: could not start GLFW3\n");
+        // GLFW 3.2 braucht auch fuer unsichtbare Fenster ein Display
+        if (Headless)
+            fprintf(stderr, "headless: kein Display gefunden, unter Linux z.B. mit xvfb-run -a starten\n");
         return 1;
     }
+    const double startupBegin = glfwGetTime();
 
 #ifdef __APPLE__
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -31,17 +93,29 @@ int main() {
     const int WindowWidth = 800;
     const int WindowHeight = 600;
 
-    // --- Vollbild: nativer Modus des Hauptmonitors nutzen -------------------- // CHANGED
-    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    GLFWwindow* window = glfwCreateWindow(
-        mode ? mode->width : WindowWidth,
-        mode ? mode->height : WindowHeight,
-        "Computergrafik - Hochschule Osnabrück",
-        monitor,           //(monitor != nullptr => echtes Fullscreen)
-        NULL
-    );                                                                                    
-    // ------------------------------------------------------------------------ 
+    GLFWwindow* window = NULL;
+    if (Headless) {
+        // unsichtbares Fenster (Standard 800x600, --size); ohne GLX (z.B. nur Mesa/llvmpipe
+        // ueber EGL) den Kontext per EGL anlegen
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(HeadlessWidth, HeadlessHeight, "Computergrafik (headless)", NULL, NULL);
+        if (!window) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+            window = glfwCreateWindow(HeadlessWidth, HeadlessHeight, "Computergrafik (headless)", NULL, NULL);
+        }
+    } else {
+        // --- Vollbild: nativer Modus des Hauptmonitors nutzen -------------------- // CHANGED
+        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+        window = glfwCreateWindow(
+            mode ? mode->width : WindowWidth,
+            mode ? mode->height : WindowHeight,
+            "Computergrafik - Hochschule Osnabrück",
+            monitor,           //(monitor != nullptr => echtes Fullscreen)
+            NULL
+        );                                                                                    
+        // ------------------------------------------------------------------------ 
+    }
 
     if (!window) {
         fprintf(stderr, "ERROR: can not open window with GLFW3\n");
@@ -55,27 +129,62 @@ int main() {
     glewInit();
 #endif
 
-    // Maus einsperren, damit Bewegungen nicht am Rand hängen bleiben          // CHANGED
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);               // CHANGED
+    if (Headless) {
+        // nicht auf VSync warten, sonst misst der Bericht nur die Bildwiederholrate
+        glfwSwapInterval(0);
+    } else {
+        // Maus einsperren, damit Bewegungen nicht am Rand hängen bleiben          // CHANGED
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);               // CHANGED
+    }
     // Tipp: Zum Freigeben ggf. spaeter GLFW_CURSOR_NORMAL setzen.             // CHANGED
 
     PrintOpenGLVersion();
 
+    // vor dem ersten GL-Objekt: Namen des NOOP-Backends gelten in GL nicht
+    GLDispatch::select(GLBackend, GLTarget);
+    if (GLLog) GLDispatch::openLog(GLLog);
+
     {
         double lastTime = 0;
-        Application App(window);
+        bool firstFrame = true;
+        unsigned int frame = 0;
+        std::vector<double> frameMs;
+        if (Headless) frameMs.reserve(HeadlessFrames);
+        Application App(window, BakeVT);
+        App.depthPrepass(Prepass);
+        App.renderQueue(UseQueue);
         App.start();
-        while (!glfwWindowShouldClose(window)) {
+        while (Headless ? frame < HeadlessFrames : !glfwWindowShouldClose(window)) {
             double now = glfwGetTime();
-            double delta = now - lastTime;
+            double delta = Headless ? HeadlessDt : now - lastTime;
             lastTime = now;
             // once per frame
             glfwPollEvents();
             App.update((float)delta);
             App.draw();
             glfwSwapBuffers(window);
+            if (Headless) {
+                // GPU-Arbeit des Frames mitzaehlen
+                glFinish();
+                frameMs.push_back((glfwGetTime() - now) * 1000.0);
+            }
+            ++frame;
+            if (firstFrame) {
+                // Startzeit bis zum ersten Bild und Anteil der Shader-Erzeugung
+                firstFrame = false;
+                const double total = glfwGetTime() - startupBegin;
+                const double shader = BaseShader::compileStats().Seconds;
+                printf("Startup: erstes Frame nach %.1f ms, davon Shader %.1f ms (%.1f %%)\n",
+                       total * 1000.0, shader * 1000.0, total > 0 ? 100.0 * shader / total : 0.0);
+                BaseShader::printCompileStats();
+            }
         }
+        if (Headless && !BakeVT)
+            PrintFrameReport(frameMs, HeadlessDt);
         App.end();
+        if (GLDispatch::backend() != GLDispatch::REAL)
+            GLDispatch::print();
+        GLDispatch::closeLog();
     }
 
     glfwTerminate();
@@ -91,3 +200,23 @@ void PrintOpenGLVersion()
     printf("Renderer: %s\n", renderer);
     printf("OpenGL version supported %s\n", version);
 }
+
+// Zeitbericht fuer --headless: CPU + GPU je Frame (nach glFinish). Frame 0 enthaelt
+// das Anlegen von Shadern und Puffern und wird getrennt ausgewiesen.
+void PrintFrameReport(const std::vector<double>& FrameMs, float Dt)
+{
+    if (FrameMs.empty()) {
+        printf("headless: keine Frames\n");
+        return;
+    }
+    printf("headless: %u Frames, dt %.4f s, erstes Frame %.2f ms\n", (unsigned int)FrameMs.size(), Dt, FrameMs[0]);
+    std::vector<double> Ms(FrameMs.begin() + 1, FrameMs.end());
+    if (Ms.empty())
+        return;
+    double Sum = 0;
+    for (size_t i = 0; i < Ms.size(); ++i) Sum += Ms[i];
+    std::sort(Ms.begin(), Ms.end());
+    const size_t n = Ms.size();
+    printf("headless: ms/Frame avg %.3f min %.3f p50 %.3f p95 %.3f p99 %.3f max %.3f (%.1f fps)\n",
+           Sum / n, Ms[0], Ms[n / 2], Ms[(n * 95) / 100], Ms[(n * 99) / 100], Ms[n - 1], 1000.0 * n / Sum);
+}
@@ -1,6 +1,9 @@
 #include "rgbimage.h"
 #include "color.h"
 #include "assert.h"
+#include "ImageKernels.h"
+#include <cstring>
+#include <vector>
 
 RGBImage::RGBImage(unsigned int Width, unsigned int Height)
     : m_Width(Width), m_Height(Height) {
@@ -18,49 +21,8 @@ void RGBImage::setPixelColor(unsigned int x, unsigned int y, const Color &c) {
     m_Image[y * m_Width + x] = c;
 }
 RGBImage& RGBImage::SobelFilter(RGBImage& dst, const RGBImage& src, float factor) {
-    assert(dst.m_Width == src.m_Width && dst.m_Height == src.m_Height);
-
-    // Sobel-Kernel für X-Richtung (horizontaler Gradient)
-    float Gx[3][3] = {
-        { 1,  0, -1 },
-        { 2,  0, -2 },
-        { 1,  0, -1 }
-    };
-
-    // Sobel-Kernel für Y-Richtung (vertikaler Gradient)
-    float Gy[3][3] = {
-        {  1,  2,  1 },
-        {  0,  0,  0 },
-        { -1, -2, -1 }
-    };
-
-    // Über jedes Pixel im Bild laufen
-    for (int y = 1; y < src.m_Height - 1; y++) {
-        for (int x = 1; x < src.m_Width - 1; x++) {
-            Color sumX, sumY;
-
-            // 3x3 Nachbarschaft anwenden
-            for (int j = -1; j <= 1; j++) {
-                for (int i = -1; i <= 1; i++) {
-                    Color c = src.getPixelColor(x + i, y + j);
-
-                    sumX += c * Gx[j + 1][i + 1];  // X-Richtung
-                    sumY += c * Gy[j + 1][i + 1];  // Y-Richtung
-                }
-            }
-
-            // Betrag des Gradienten berechnen (Länge)
-            Color gradient;
-            gradient.R = sqrt(sumX.R * sumX.R + sumY.R * sumY.R);
-            gradient.G = sqrt(sumX.G * sumX.G + sumY.G * sumY.G);
-            gradient.B = sqrt(sumX.B * sumX.B + sumY.B * sumY.B);
-
-            // Ergebnis mit Faktor multiplizieren (Verstärkung des Kontrasts)
-            dst.setPixelColor(x, y, gradient * factor);
-        }
-    }
-
-    return dst;
+    // separierbare, vektorisierte Variante (siehe ImageKernels)
+    return ImageKernels::sobel(dst, src, factor);
 }
 
 const Color &RGBImage::getPixelColor(unsigned int x, unsigned int y) const {
@@ -85,16 +47,10 @@ unsigned char RGBImage::convertColorChannel(float f) {
     return static_cast<unsigned char>(f * 255.0f);
 }
 
-bool RGBImage::saveToDisk(const char *Filename) {
-    FILE *file = fopen(Filename, "wb");
-    if (!file) {
-        return false;
-    }
-
-    // BMP Header erstellen
-    unsigned int padding = (4 - (m_Width * 3) % 4) % 4;
+void RGBImage::bmpHeader(unsigned char header[54], unsigned int width, unsigned int height) {
     // Jede Zeile muss auf ein Vielfaches von 4 Bytes gepolstert werden
-    unsigned int fileSize = 54 + (3 * m_Width + padding) * m_Height;
+    unsigned int padding = (4 - (width * 3) % 4) % 4;
+    unsigned int fileSize = 54 + (3 * width + padding) * height;
 
     unsigned char bmpHeader[54] = {
         'B', 'M',           // Magic Number
@@ -121,34 +77,44 @@ bool RGBImage::saveToDisk(const char *Filename) {
     bmpHeader[5] = (unsigned char) (fileSize >> 24);
 
     // Breite in den Header setzten
-    bmpHeader[18] = (unsigned char) (m_Width);
-    bmpHeader[19] = (unsigned char) (m_Width >> 8);
-    bmpHeader[20] = (unsigned char) (m_Width >> 16);
-    bmpHeader[21] = (unsigned char) (m_Width >> 24);
+    bmpHeader[18] = (unsigned char) (width);
+    bmpHeader[19] = (unsigned char) (width >> 8);
+    bmpHeader[20] = (unsigned char) (width >> 16);
+    bmpHeader[21] = (unsigned char) (width >> 24);
 
     // Höhe in den Header setzten
-    bmpHeader[22] = (unsigned char) (m_Height);
-    bmpHeader[23] = (unsigned char) (m_Height >> 8);
-    bmpHeader[24] = (unsigned char) (m_Height >> 16);
-    bmpHeader[25] = (unsigned char) (m_Height >> 24);
+    bmpHeader[22] = (unsigned char) (height);
+    bmpHeader[23] = (unsigned char) (height >> 8);
+    bmpHeader[24] = (unsigned char) (height >> 16);
+    bmpHeader[25] = (unsigned char) (height >> 24);
 
-    // Header schreiben
-    fwrite(bmpHeader, 1, 54, file);
+    memcpy(header, bmpHeader, 54);
+}
 
-    // Schreibe Pixeldaten (BGR-Format, Zeilen von Unten -> Oben gespeichert)
-    unsigned char pad[3] = {0, 0, 0};
+bool RGBImage::saveToDisk(const char *Filename) {
+    FILE *file = fopen(Filename, "wb");
+    if (!file) {
+        return false;
+    }
+
+    // Header schreiben
+    unsigned char header[54];
+    bmpHeader(header, m_Width, m_Height);
+    fwrite(header, 1, 54, file);
+
+    // Schreibe Pixeldaten (BGR-Format, Zeilen von Unten -> Oben gespeichert),
+    // jede Zeile inkl. Padding wird erst komplett konvertiert und dann am Stück geschrieben
+    const unsigned int stride = (3 * m_Width + 3) & ~3u;
+    std::vector<unsigned char> row(stride, 0);
     for (int y = m_Height - 1; y >= 0; y--) {
-        for (unsigned int x = 0; x < m_Width; x++) {
-            const Color &c = getPixelColor(x, y);
-            unsigned char r = convertColorChannel(c.R);
-            unsigned char g = convertColorChannel(c.G);
-            unsigned char b = convertColorChannel(c.B);
-
-            fwrite(&b, 1, 1, file);
-            fwrite(&g, 1, 1, file);
-            fwrite(&r, 1, 1, file);
+        const Color* src = &m_Image[(size_t)y * m_Width];
+        unsigned char* dst = row.empty() ? NULL : &row[0];
+        for (unsigned int x = 0; x < m_Width; x++, dst += 3) {
+            dst[0] = convertColorChannel(src[x].B);
+            dst[1] = convertColorChannel(src[x].G);
+            dst[2] = convertColorChannel(src[x].R);
         }
-        fwrite(pad, 1, padding, file); // Padding am Ende jeder Zeile
+        if (stride) fwrite(&row[0], 1, stride, file);
     }
 
     fclose(file);
@@ -14,9 +14,14 @@ public:
     bool saveToDisk( const char* Filename);
     unsigned int width() const;
     unsigned int height() const;
+    // direkter Zugriff auf die Pixel (zeilenweise, Width*Height Farben)
+    Color* data() { return m_Image; }
+    const Color* data() const { return m_Image; }
     static RGBImage& SobelFilter(RGBImage& dst, const RGBImage& src, float factor = 1.0f);
     
     static unsigned char convertColorChannel( float f);
+    // 54-Byte-Header einer unkomprimierten 24-Bit-BMP (auch von FrameCapture genutzt)
+    static void bmpHeader( unsigned char header[54], unsigned int width, unsigned int height);
 protected:
     Color* m_Image;
     unsigned int m_Height;
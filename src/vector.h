@@ -2,7 +2,12 @@
 #define __SimpleRayTracer__vector__
 
 #include <iostream>
+#include <math.h>
+#include <type_traits>
 
+// Wertetyp: Konstruktoren und die kleinen Operatoren stehen inline im Header (constexpr,
+// soweit C++11 das erlaubt), damit sie in jeder Uebersetzungseinheit verschwinden und
+// Konstanten zur Compilezeit entstehen.
 class Vector
 {
 public:
@@ -10,25 +15,45 @@ public:
     float Y;
     float Z;
     
-    Vector(float x, float y, float z);
-    Vector();
+    constexpr Vector(float x, float y, float z) noexcept : X(x), Y(y), Z(z) {}
+    constexpr Vector() noexcept : X(0), Y(0), Z(0) {}
 
-    float dot(const Vector& v) const;
-    Vector cross(const Vector& v) const;
-    Vector operator+(const Vector& v) const;
-    Vector operator-(const Vector& v) const;
-    Vector& operator+=(const Vector& v);
-    Vector operator*(float c) const;
-    Vector operator-() const;
+    constexpr float dot(const Vector& v) const noexcept { return X * v.X + Y * v.Y + Z * v.Z; }
+    constexpr Vector cross(const Vector& v) const noexcept
+    {
+        return Vector(Y * v.Z - Z * v.Y, Z * v.X - X * v.Z, X * v.Y - Y * v.X);
+    }
+    constexpr Vector operator+(const Vector& v) const noexcept { return Vector(X + v.X, Y + v.Y, Z + v.Z); }
+    constexpr Vector operator-(const Vector& v) const noexcept { return Vector(X - v.X, Y - v.Y, Z - v.Z); }
+    Vector& operator+=(const Vector& v) noexcept { X += v.X; Y += v.Y; Z += v.Z; return *this; }
+    constexpr Vector operator*(float c) const noexcept { return Vector(X * c, Y * c, Z * c); }
+    constexpr Vector operator-() const noexcept { return Vector(-X, -Y, -Z); }
     Vector& normalize();
-    float length() const;
-    float lengthSquared() const;
+    float length() const { return sqrtf(lengthSquared()); }
+    constexpr float lengthSquared() const noexcept { return X * X + Y * Y + Z * Z; }
     Vector reflection(const Vector& normal) const;
     bool triangleIntersection(const Vector& d, const Vector& a, const Vector& b,
                               const Vector& c, float& s) const;
     Vector triangleIntersectionPosition(const Vector& d, const Vector& a, const Vector& b,
                               const Vector& c, float& s) const;
 };
-Vector operator*(float c, const Vector& v);
+constexpr Vector operator*(float c, const Vector& v) noexcept { return Vector(v.X * c, v.Y * c, v.Z * c); }
 
-#endif /* defined(__SimpleRayTracer__vector__) */
\ No newline at end of file
+inline Vector& Vector::normalize()
+{
+    const float l = length();
+    if (l > 0) {
+        X /= l;
+        Y /= l;
+        Z /= l;
+    }
+    return *this;
+}
+
+// Vector-Arrays werden als float-Arrays (VertexBuffer, MatrixSIMD) durchgereicht
+static_assert(sizeof(Vector) == 3 * sizeof(float), "Vector must be three packed floats");
+static_assert(std::is_standard_layout<Vector>::value, "Vector must have standard layout");
+static_assert(std::is_trivially_copyable<Vector>::value, "Vector must be trivially copyable");
+static_assert(std::is_nothrow_move_constructible<Vector>::value, "Vector moves must not throw");
+
+#endif /* defined(__SimpleRayTracer__vector__) */